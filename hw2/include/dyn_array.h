@@ -44,6 +44,95 @@ typedef struct dyn_array dyn_array_t;
 ///
 dyn_array_t *dyn_array_create(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *));
 
+/*
+	Allocator notes!
+
+	By default the array's storage (and the array itself) comes from malloc/realloc/free.
+	dyn_array_create_with takes an allocator instead, which is kept for the array's whole life,
+	so every growth and the final destroy go back to it.
+
+	The hooks get the sizes involved because some allocators can't look them up:
+	  allocate(ctx, bytes)
+	  reallocate(ctx, ptr, old_bytes, new_bytes) keeps the first min(old_bytes, new_bytes) bytes
+	  release(ctx, ptr, bytes)
+	A failing allocate/reallocate returns NULL (reallocate leaves ptr alone then).
+
+	Two are provided below: the system allocator with alignment/huge page options, and a bump arena.
+*/
+
+typedef struct
+{
+	void *(*allocate)(void *ctx, size_t bytes);
+	void *(*reallocate)(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes);
+	void (*release)(void *ctx, void *ptr, size_t bytes);
+	void *ctx;
+} dyn_allocator_t;
+
+// Options for dyn_allocator_system and dyn_arena_create
+// ALIGNED places allocations on 64 byte (cache line) boundaries
+// HUGE maps big allocations (DYN_HUGE_THRESHOLD bytes and up) on their own, asking for MAP_HUGETLB
+//   pages and falling back to ordinary pages advised for transparent huge pages
+typedef enum { DYN_ALLOC_DEFAULT = 0x00, DYN_ALLOC_ALIGNED = 0x01, DYN_ALLOC_HUGE = 0x02 } DYN_ALLOC_FLAGS;
+
+///
+/// Same as dyn_array_create, but the array and its storage come from the given allocator
+/// \param capacity Minimum capacity request (0 is fine if you have no opinion)
+/// \param data_type_size Size of the object type to be stored in bytes
+/// \param destruct_func Optional destructor to be applied on destruct operations (NULL to disable)
+/// \param allocator The allocator to use (copied), NULL for malloc
+/// \return new dynamic array pointer, NULL on error
+///
+dyn_array_t *dyn_array_create_with(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *),
+								   const dyn_allocator_t *const allocator);
+
+///
+/// Returns the system allocator with the given options
+/// (malloc with no options, aligned_alloc with DYN_ALLOC_ALIGNED, mmap for big blocks with DYN_ALLOC_HUGE)
+/// \param flags DYN_ALLOC_FLAGS or'd together
+/// \return the allocator
+///
+dyn_allocator_t dyn_allocator_system(const unsigned flags);
+
+typedef struct dyn_arena dyn_arena_t;
+
+///
+/// Creates a bump arena that can hand out up to bytes bytes
+/// The space is reserved up front but only backed by memory once it's touched
+/// \param bytes Size of the arena
+/// \param flags DYN_ALLOC_FLAGS or'd together (HUGE applies to the whole arena)
+/// \return new arena pointer, NULL on error
+///
+dyn_arena_t *dyn_arena_create(const size_t bytes, const unsigned flags);
+
+///
+/// Returns an allocator that takes from the arena
+/// Releasing or growing the newest block is done in place, anything else is only reclaimed by a reset
+/// \param arena the arena
+/// \return the allocator (all hooks fail if arena is NULL)
+///
+dyn_allocator_t dyn_arena_allocator(dyn_arena_t *const arena);
+
+///
+/// Releases everything allocated from the arena at once, in constant time
+/// Arrays made from it are gone afterwards, so don't touch (or destroy) them again
+/// (destructors are NOT run, destroy the arrays first if they need it)
+/// \param arena the arena
+///
+void dyn_arena_reset(dyn_arena_t *const arena);
+
+///
+/// Returns how many bytes of the arena are in use
+/// \param arena the arena
+/// \return bytes in use, 0 on error
+///
+size_t dyn_arena_used(const dyn_arena_t *const arena);
+
+///
+/// Destroys the arena and everything allocated from it
+/// \param arena the arena
+///
+void dyn_arena_destroy(dyn_arena_t *const arena);
+
 ///
 /// Creates a new dynamic array from a given array
 /// (Given pointer can be freed after import, we copy the data)
@@ -59,11 +148,20 @@ dyn_array_t *dyn_array_import(const void *const data, const size_t count, const
 ///
 /// Returns an internal pointer to the data array for export
 /// Since this pointer is internal, it may be invalidated by insertions that trigger reallocation
+/// Forgets any known order, since the contents may be changed through it
 /// \param dyn_array The dynamic array to export
 /// \return Pointer to dynamic array contents, NULL on error
 ///
 const void *dyn_array_export(const dyn_array_t *const dyn_array);
 
+///
+/// Returns an internal pointer to the data array for reading only (keeps any known order)
+/// Since this pointer is internal, it may be invalidated by insertions that trigger reallocation
+/// \param dyn_array The dynamic array
+/// \return Pointer to dynamic array contents, NULL on error/empty array
+///
+const void *dyn_array_contents(const dyn_array_t *const dyn_array);
+
 ///
 /// Dynamic array destructor
 /// Applies destructor to all remaining elements
@@ -130,6 +228,16 @@ void *dyn_array_back(const dyn_array_t *const dyn_array);
 ///
 bool dyn_array_push_back(dyn_array_t *const dyn_array, const void *const object);
 
+///
+/// Copies count objects from the given array and places them at the back, in order
+/// (one capacity check and one copy for the whole batch)
+/// \param dyn_array the dynamic array
+/// \param objects the objects to insert
+/// \param count number of objects to insert
+/// \return bool representing success of the operation
+///
+bool dyn_array_push_back_n(dyn_array_t *const dyn_array, const void *const objects, const size_t count);
+
 ///
 /// Removes and optionally destructs the object at the back of the array
 /// \param dyn_array the dynamic array
@@ -156,6 +264,14 @@ bool dyn_array_extract_back(dyn_array_t *const dyn_array, void *const object);
 ///
 void *dyn_array_at(const dyn_array_t *const dyn_array, const size_t index);
 
+///
+/// Same as dyn_array_at, but the object is only read, so any known order is kept
+/// \param dyn_array the dynamic array
+/// \param index the index of the object to retrieve
+/// \return pointer to the requested object, NULL on error
+///
+const void *dyn_array_peek(const dyn_array_t *const dyn_array, const size_t index);
+
 ///
 /// Inserts the given object at the given index in the array, increasing the container size by one
 /// and moving any contents at index and beyond down one
@@ -219,6 +335,33 @@ size_t dyn_array_capacity(const dyn_array_t *const dyn_array);
 ///
 size_t dyn_array_data_size(const dyn_array_t *const dyn_array);
 
+/*
+	Sortedness notes!
+
+	The array remembers when it's sorted and by which comparator (the function pointer itself).
+	Sorting it again with the same comparator is then free, and both sorts check for
+	already-sorted data in one pass before doing any real work.
+
+	Removing objects keeps the order, adding objects keeps it as long as they land in order
+	(checked against their neighbours), and for_each forgets it.
+	Objects can be changed in place through the pointers front/back/at/export hand out,
+	so those forget it too. Read through dyn_array_peek/dyn_array_contents to keep it.
+*/
+
+///
+/// Tells whether the array is known to be sorted by the given comparator
+/// \param dyn_array the dynamic array
+/// \param compare the comparison function
+/// \return true if the array was sorted by compare and hasn't been put out of order since, false otherwise
+///
+bool dyn_array_is_sorted(const dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *));
+
+///
+/// Forgets any known order, for after objects were changed in place
+/// \param dyn_array the dynamic array
+///
+void dyn_array_mark_unsorted(dyn_array_t *const dyn_array);
+
 ///
 /// Sorts the array according to the given comparator function
 /// compare(x,y) < 0 iff x < y
@@ -231,11 +374,25 @@ size_t dyn_array_data_size(const dyn_array_t *const dyn_array);
 ///
 bool dyn_array_sort(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *));
 
+///
+/// Sorts the array according to the given comparator function using several threads
+/// Same comparator rules as dyn_array_sort, but this sort IS stable
+/// Small arrays (below DYN_SORT_PARALLEL_CUTOFF objects per thread) are sorted on the calling thread
+/// Needs a scratch buffer as big as the array while it runs
+/// \param dyn_array the dynamic array
+/// \param compare the comparison function
+/// \param nthreads maximum number of threads to use (0 uses one per online CPU)
+/// \return bool representing success of the operation
+///
+bool dyn_array_sort_parallel(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *),
+							 const size_t nthreads);
+
 
 ///
 /// Inserts the given object into the correct sorted position
 ///  increasing the container size by one
 /// and moving any contents beyond the sorted position down one
+/// The position is found by binary search and goes ahead of any equal objects
 /// Note: calling this on an unsorted array will insert it... somewhere
 /// \param dyn_array the dynamic array
 /// \param object the object to insert
@@ -245,6 +402,46 @@ bool dyn_array_sort(dyn_array_t *const dyn_array, int (*const compare)(const voi
 bool dyn_array_insert_sorted(dyn_array_t *const dyn_array, const void *const object,
 							 int (*const compare)(const void *const, const void *const));
 
+///
+/// Merges a sorted batch of objects into the sorted array in one pass
+/// Same result as insert_sorted on each object in turn (batch objects go ahead of equal ones),
+/// without moving anything more than once
+/// Note: the batch must be sorted by compare, otherwise objects end up... somewhere
+/// \param dyn_array the dynamic array
+/// \param objects the sorted batch to merge
+/// \param count number of objects in the batch
+/// \param compare the comparison function
+/// \return bool representing success of the operation
+///
+bool dyn_array_merge_sorted(dyn_array_t *const dyn_array, const void *const objects, const size_t count,
+							int (*const compare)(const void *, const void *));
+
+///
+/// Removes and optionally destructs every object the predicate picks, in one pass
+/// Objects that stay keep their order
+/// \param dyn_array the dynamic array
+/// \param predicate returns true for objects to erase
+/// \param arg argument that will be passed to the predicate (as parameter 2)
+/// \return number of objects erased, 0 on error
+///
+size_t dyn_array_erase_if(dyn_array_t *const dyn_array, bool (*const predicate)(const void *const, void *), void *arg);
+
+
+///
+/// Makes sure the array can hold capacity objects without reallocating
+/// \param dyn_array the dynamic array
+/// \param capacity number of objects to make room for
+/// \return bool representing success of the operation
+///
+bool dyn_array_reserve(dyn_array_t *const dyn_array, const size_t capacity);
+
+///
+/// Asks the array to give back the capacity it isn't using
+/// (it's a request, the array is unchanged if reallocating fails)
+/// The next growth goes back to the usual power of two capacities
+/// \param dyn_array the dynamic array
+///
+void dyn_array_shrink_to_fit(dyn_array_t *const dyn_array);
 
 ///
 /// Applies the given function to every object in the array
@@ -255,6 +452,42 @@ bool dyn_array_insert_sorted(dyn_array_t *const dyn_array, const void *const obj
 ///
 bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *const, void *), void *arg);
 
+
+/*
+	Stats notes!
+
+	Built with DYN_ARRAY_STATS defined, the library counts what its operations cost.
+	Without it the counters are compiled out and the functions below report zeros.
+
+	Counters are kept per thread. Threads started by dyn_array_sort_parallel hand
+	their counts to the calling thread before it returns.
+*/
+
+typedef struct
+{
+	uint64_t mallocs;		 // storage and scratch allocations
+	uint64_t reallocs;		 // storage growths
+	uint64_t bytes_shifted;	 // bytes memmoved to open or close gaps (insert/erase anywhere but the back)
+	uint64_t comparisons;	 // calls to a user comparison function by sort and insert_sorted
+} dyn_array_stats_t;
+
+///
+/// Returns the calling thread's counters
+/// \return counters since the last reset (all zero without DYN_ARRAY_STATS)
+///
+dyn_array_stats_t dyn_array_stats(void);
+
+///
+/// Zeroes the calling thread's counters
+///
+void dyn_array_stats_reset(void);
+
+///
+/// Adds counters gathered elsewhere (e.g. on another thread) to the calling thread's
+/// \param stats the counters to add
+///
+void dyn_array_stats_add(const dyn_array_stats_t *const stats);
+
 #ifdef __cplusplus
   }
 #endif
@@ -0,0 +1,249 @@
+#ifndef DYN_ARRAY_HPP
+#define DYN_ARRAY_HPP
+
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "dyn_array.h"
+
+/*
+	C++ notes!
+
+	DynArray<T> owns a dyn_array_t holding T objects and destroys it when it goes away.
+	It can be moved but not copied, so handing one back from a function costs nothing.
+	A moved-from DynArray is empty and only good for destroying or assigning to.
+
+	The objects are a plain T array, so begin()/end() are T pointers and work with anything
+	in <algorithm>. sort/insert_sorted take any C++ comparator (a lambda, std::less, ...)
+	and the compiler inlines it, no void pointer calls through qsort.
+
+	Writable access (data(), begin()/end(), operator[], at, front/back on a non-const
+	DynArray) goes through dyn_array_export/dyn_array_at, so like them it drops the sorted
+	flag. Read through a const DynArray to keep it, e.g. for a lookup in a sorted array.
+
+	The dyn_array_t underneath is always available: get() lends it to the C API,
+	release() gives it away, and adopt() takes one over. None of them copy.
+
+	Anything the C API reports as failure (out of memory, a bad index for at) is thrown:
+	std::bad_alloc, std::out_of_range, or std::invalid_argument for adopting an array of
+	the wrong object size.
+
+	T has to be trivially copyable, the C side moves objects around with memcpy.
+	No destructor is attached, T's own cleanup doesn't exist for trivially copyable types.
+*/
+
+template <typename T>
+class DynArray
+{
+	static_assert(std::is_trivially_copyable<T>::value, "dyn_array moves objects with memcpy");
+
+  public:
+	typedef T value_type;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+
+	///
+	/// Creates an empty array with room for at least capacity objects
+	/// \param capacity Minimum capacity request
+	/// \param allocator Optional allocator (see dyn_array_create_with), NULL for malloc
+	///
+	explicit DynArray(const size_t capacity = 0, const dyn_allocator_t *const allocator = NULL)
+		: array_(dyn_array_create_with(capacity, sizeof(T), NULL, allocator))
+	{
+		if (!array_)
+		{
+			throw std::bad_alloc();
+		}
+	}
+
+	///
+	/// Takes ownership of an existing array, e.g. one from load_process_control_blocks
+	/// (on a throw the array is still the caller's)
+	/// \param array the array to own, must hold objects of sizeof(T) bytes
+	/// \return the owning wrapper
+	///
+	static DynArray adopt(dyn_array_t *const array)
+	{
+		if (!array)
+		{
+			throw std::invalid_argument("cannot adopt a NULL dyn_array");
+		}
+		if (dyn_array_data_size(array) != sizeof(T))
+		{
+			throw std::invalid_argument("dyn_array object size does not match T");
+		}
+		return DynArray(array, Adopted());
+	}
+
+	DynArray(DynArray &&other) noexcept : array_(other.array_) { other.array_ = NULL; }
+
+	DynArray &operator=(DynArray &&other) noexcept
+	{
+		if (this != &other)
+		{
+			dyn_array_destroy(array_);
+			array_		 = other.array_;
+			other.array_ = NULL;
+		}
+		return *this;
+	}
+
+	DynArray(const DynArray &)			  = delete;
+	DynArray &operator=(const DynArray &) = delete;
+
+	~DynArray() { dyn_array_destroy(array_); }
+
+	///
+	/// Lends the underlying array to the C API (still owned here)
+	/// NULL once this has been moved from or released
+	///
+	dyn_array_t *get() const { return array_; }
+
+	///
+	/// Gives the underlying array away, the caller destroys it
+	///
+	dyn_array_t *release()
+	{
+		dyn_array_t *released = array_;
+		array_				  = NULL;
+		return released;
+	}
+
+	size_t size() const { return dyn_array_size(array_); }
+	size_t capacity() const { return dyn_array_capacity(array_); }
+	bool empty() const { return dyn_array_empty(array_); }
+
+	T *data() { return static_cast<T *>(const_cast<void *>(dyn_array_export(array_))); }
+	const T *data() const { return static_cast<const T *>(dyn_array_contents(array_)); }
+
+	iterator begin() { return data(); }
+	iterator end() { return data() + size(); }
+	const_iterator begin() const { return data(); }
+	const_iterator end() const { return data() + size(); }
+
+	T &operator[](const size_t index) { return data()[index]; }
+	const T &operator[](const size_t index) const { return data()[index]; }
+
+	T &at(const size_t index)
+	{
+		return *static_cast<T *>(checked(dyn_array_at(array_, index), "DynArray index out of range"));
+	}
+	const T &at(const size_t index) const
+	{
+		return *static_cast<const T *>(checked(dyn_array_peek(array_, index), "DynArray index out of range"));
+	}
+
+	T &front() { return at(0); }
+	T &back() { return at(size() - 1); }
+
+	void push_back(const T &object) { grew(dyn_array_push_back(array_, &object)); }
+	void push_back_n(const T *const objects, const size_t count)
+	{
+		if (count)
+		{
+			grew(dyn_array_push_back_n(array_, objects, count));
+		}
+	}
+	void insert(const size_t index, const T &object)
+	{
+		if (index > size())
+		{
+			throw std::out_of_range("DynArray index out of range");
+		}
+		grew(dyn_array_insert(array_, index, &object));
+	}
+	void reserve(const size_t count) { grew(dyn_array_reserve(array_, count)); }
+	void shrink_to_fit() { dyn_array_shrink_to_fit(array_); }
+
+	bool pop_back() { return dyn_array_pop_back(array_); }
+	bool erase(const size_t index) { return dyn_array_erase(array_, index); }
+	void clear() { dyn_array_clear(array_); }
+
+	///
+	/// Sorts with an inlined comparator (a strict weak ordering, like std::sort wants)
+	/// \param less returns true if the first object goes before the second
+	///
+	template <typename Less>
+	void sort(Less less)
+	{
+		dyn_array_mark_unsorted(array_);
+		std::sort(objects(), objects() + size(), less);
+	}
+	void sort() { sort(std::less<T>()); }
+
+	///
+	/// Stable version of sort
+	///
+	template <typename Less>
+	void stable_sort(Less less)
+	{
+		dyn_array_mark_unsorted(array_);
+		std::stable_sort(objects(), objects() + size(), less);
+	}
+
+	///
+	/// Inserts ahead of any equal objects, like dyn_array_insert_sorted, with an inlined comparator
+	/// \param object the object to insert
+	/// \param less the ordering the array is sorted by
+	///
+	template <typename Less>
+	void insert_sorted(const T &object, Less less)
+	{
+		const DynArray &sorted = *this;
+		insert(static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), object, less) - sorted.begin()), object);
+	}
+
+	///
+	/// Erases every object the predicate picks, in one pass (order of the rest is kept)
+	/// \return number of objects erased
+	///
+	template <typename Predicate>
+	size_t erase_if(Predicate predicate)
+	{
+		// remove_if keeps the order of the rest, so a sorted array stays sorted
+		const iterator last  = objects() + size();
+		const iterator kept  = std::remove_if(objects(), last, predicate);
+		const size_t erased = static_cast<size_t>(last - kept);
+		for (size_t count = 0; count < erased; ++count)
+		{
+			dyn_array_pop_back(array_);
+		}
+		return erased;
+	}
+
+  private:
+	struct Adopted
+	{
+	};
+
+	DynArray(dyn_array_t *const array, Adopted) : array_(array) {}
+
+	// Writable objects without touching the sorted flag, for the members that keep it right themselves
+	T *objects() { return static_cast<T *>(const_cast<void *>(dyn_array_contents(array_))); }
+
+	template <typename Pointer>
+	static Pointer checked(const Pointer object, const char *const what)
+	{
+		if (!object)
+		{
+			throw std::out_of_range(what);
+		}
+		return object;
+	}
+
+	static void grew(const bool success)
+	{
+		if (!success)
+		{
+			throw std::bad_alloc();
+		}
+	}
+
+	dyn_array_t *array_;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef DYN_DEQUE_H
+#define DYN_DEQUE_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dyn_array.h"
+
+typedef struct dyn_deque dyn_deque_t;
+
+/*
+	Deque notes!
+
+	dyn_deque is dyn_array's sibling for queues: a ring buffer, so pushing and popping at
+	either end is (amortized) constant time and nothing is ever shifted. Indexing is
+	constant time too, index 0 is always the front.
+
+	Everything else works like dyn_array: objects are copied in and out with memcpy,
+	the optional destructor runs on pop/clear/destroy but not on extract, and
+	the storage can come from a dyn_allocator_t.
+
+	Pointers from front/back/at are invalidated by any push.
+*/
+
+///
+/// Creates a new deque capable of holding at least capacity number of
+/// data_type_size-sized objects with optional destructor
+/// \param capacity Minimum capacity request (0 is fine if you have no opinion)
+/// \param data_type_size Size of the object type to be stored in bytes
+/// \param destruct_func Optional destructor to be applied on destruct operations (NULL to disable)
+/// \return new deque pointer, NULL on error
+///
+dyn_deque_t *dyn_deque_create(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *));
+
+///
+/// Same as dyn_deque_create, but the deque and its storage come from the given allocator
+/// \param capacity Minimum capacity request (0 is fine if you have no opinion)
+/// \param data_type_size Size of the object type to be stored in bytes
+/// \param destruct_func Optional destructor (NULL to disable)
+/// \param allocator The allocator to use (copied), NULL for malloc
+/// \return new deque pointer, NULL on error
+///
+dyn_deque_t *dyn_deque_create_with(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *),
+								   const dyn_allocator_t *const allocator);
+
+///
+/// Deque destructor
+/// Applies destructor to all remaining elements
+/// \param dyn_deque The deque to destruct
+///
+void dyn_deque_destroy(dyn_deque_t *const dyn_deque);
+
+///
+/// Returns a pointer to the object at the front of the deque
+/// \param dyn_deque the deque
+/// \return Pointer to front object (NULL on error/empty deque)
+///
+void *dyn_deque_front(const dyn_deque_t *const dyn_deque);
+
+///
+/// Copies the given object and places it at the front of the deque
+/// \param dyn_deque the deque
+/// \param object the object to insert
+/// \return bool representing success of the operation
+///
+bool dyn_deque_push_front(dyn_deque_t *const dyn_deque, const void *const object);
+
+///
+/// Removes and optionally destructs the object at the front of the deque
+/// \param dyn_deque the deque
+/// \return bool representing success of the operation (false when empty)
+///
+bool dyn_deque_pop_front(dyn_deque_t *const dyn_deque);
+
+///
+/// Removes the object at the front of the deque and places it in the desired location
+/// Does not destruct since it was returned to the user
+/// \param dyn_deque the deque
+/// \param object destination for extracted object
+/// \return bool representing success of the operation
+///
+bool dyn_deque_extract_front(dyn_deque_t *const dyn_deque, void *const object);
+
+///
+/// Returns a pointer to the object at the back of the deque
+/// \param dyn_deque the deque
+/// \return Pointer to back object (NULL on error/empty deque)
+///
+void *dyn_deque_back(const dyn_deque_t *const dyn_deque);
+
+///
+/// Copies the given object and places it at the back of the deque
+/// \param dyn_deque the deque
+/// \param object the object to insert
+/// \return bool representing success of the operation
+///
+bool dyn_deque_push_back(dyn_deque_t *const dyn_deque, const void *const object);
+
+///
+/// Removes and optionally destructs the object at the back of the deque
+/// \param dyn_deque the deque
+/// \return bool representing success of the operation (false when empty)
+///
+bool dyn_deque_pop_back(dyn_deque_t *const dyn_deque);
+
+///
+/// Removes the object at the back of the deque and places it in the desired location
+/// Does not destruct since it was returned to the user
+/// \param dyn_deque the deque
+/// \param object destination for extracted object
+/// \return bool representing success of the operation
+///
+bool dyn_deque_extract_back(dyn_deque_t *const dyn_deque, void *const object);
+
+///
+/// Returns a pointer to the object index places from the front
+/// \param dyn_deque the deque
+/// \param index the index of the object to retrieve
+/// \return pointer to the requested object, NULL on error
+///
+void *dyn_deque_at(const dyn_deque_t *const dyn_deque, const size_t index);
+
+///
+/// Removes and optionally destructs all elements
+/// \param dyn_deque the deque
+///
+void dyn_deque_clear(dyn_deque_t *const dyn_deque);
+
+///
+/// Tests if the deque is empty
+/// \param dyn_deque the deque
+/// \return true if the deque is empty (or NULL was passed), false otherwise
+///
+bool dyn_deque_empty(const dyn_deque_t *const dyn_deque);
+
+///
+/// Returns the number of objects in the deque
+/// \param dyn_deque the deque
+/// \return the size of the deque, 0 on error
+///
+size_t dyn_deque_size(const dyn_deque_t *const dyn_deque);
+
+///
+/// Returns the current capacity of the deque
+/// \param dyn_deque the deque
+/// \return the capacity of the deque, 0 on error
+///
+size_t dyn_deque_capacity(const dyn_deque_t *const dyn_deque);
+
+///
+/// Returns the size of the object stored in the deque
+/// \param dyn_deque the deque
+/// \return the size of a stored object (bytes), 0 on error
+///
+size_t dyn_deque_data_size(const dyn_deque_t *const dyn_deque);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef IO_SCHEDULING_H
+#define IO_SCHEDULING_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+/*
+	I/O notes!
+
+	A ProcessControlBlock_t is a single CPU burst. Real processes alternate: compute,
+	wait on a device, compute again. An I/O trace describes each process as a list of
+	phases, each a CPU burst followed by an I/O burst on one of the trace's devices.
+
+	schedule_io runs any of the five policies over a trace as one event loop. A process
+	is always in one place: not arrived yet, ready, on the CPU, queued for a device or
+	on a device. Each device serves one process at a time in FIFO order, and devices
+	run alongside the CPU, so a schedule that keeps them busy while the CPU computes
+	finishes sooner. The result says how well that went: CPU utilization, and how much
+	of the time the devices were busy the CPU was computing too (I/O overlap).
+
+	Policies pick among the ready processes by their current CPU burst (SJF, SRT) or
+	their priority, exactly as the single burst schedulers do, and the overhead model
+	(set_schedule_overhead) applies to every dispatch. Round robin sweeps by process
+	index and SRT reconsiders whenever a process arrives or finishes an I/O burst.
+
+	Empty bursts are skipped: a phase with no CPU time goes straight to its I/O and an
+	empty I/O burst never visits its device. Events at the same instant happen in this
+	order: I/O completions (by process index), arrivals (by process index), then the end
+	of the burst on the CPU.
+
+	With one phase per process and no I/O, every policy gives the same results as its
+	single burst scheduler (as long as no burst is empty: those are dispatched there).
+*/
+
+typedef struct
+{
+	uint32_t cpu;			// CPU burst
+	uint32_t io;			// I/O burst that follows it, 0 for none
+	uint32_t device;		// device the I/O burst runs on, below the trace's device_count
+}
+IoPhase_t;
+
+typedef struct
+{
+	uint32_t arrival;		// time the process arrives
+	uint32_t priority;		// used by the priority policy
+	uint32_t first_phase;	// its phases are phases[first_phase] up to phases[first_phase + phase_count - 1]
+	uint32_t phase_count;	// at least one
+}
+IoProcess_t;
+
+typedef struct
+{
+	dyn_array_t *processes;	// IoProcess_t
+	dyn_array_t *phases;	// IoPhase_t, each process's phases in a row
+	uint32_t device_count;
+}
+IoTrace_t;
+
+typedef enum { IO_POLICY_FCFS = 0, IO_POLICY_SJF, IO_POLICY_PRIORITY, IO_POLICY_RR, IO_POLICY_SRT } IO_POLICY;
+
+typedef struct
+{
+	ScheduleResult_t schedule;	// turnaround runs to the end of the last phase, waiting is time spent ready
+	uint64_t cpu_busy_time;		// time the CPU spent running bursts (overhead not included)
+	uint64_t io_busy_time;		// time at least one device was busy
+	uint64_t io_overlap_time;	// part of io_busy_time the CPU spent running bursts too
+	uint64_t device_wait_time;	// time processes spent queued for a busy device, summed over processes
+	double cpu_utilization;		// cpu_busy_time / schedule.total_run_time
+	double io_overlap;			// io_overlap_time / io_busy_time, 0 without I/O
+}
+IoScheduleResult_t;
+
+///
+/// Creates an empty trace
+/// \param device_count number of devices the trace's I/O bursts can use
+/// \return new trace pointer, NULL on error
+///
+IoTrace_t *io_trace_create(const uint32_t device_count);
+
+///
+/// Appends a process to the trace
+/// \param trace the trace
+/// \param arrival time the process arrives
+/// \param priority its priority
+/// \param phases its phases, in order (every I/O burst on a device of the trace)
+/// \param phase_count number of phases, at least one
+/// \return bool representing success of the operation (the trace is unchanged on failure)
+///
+bool io_trace_add(IoTrace_t *const trace, const uint32_t arrival, const uint32_t priority, const IoPhase_t *const phases,
+		const size_t phase_count);
+
+///
+/// Builds a trace of single phase processes without I/O from PCBs
+/// \param pcbs dyn_array of ProcessControlBlock_t
+/// \return new trace pointer, NULL on error
+///
+IoTrace_t *io_trace_from_pcbs(const dyn_array_t *const pcbs);
+
+///
+/// Loads an I/O trace from a binary file: uint32_t device count, uint32_t process count, then
+/// per process uint32_t arrival, priority and phase count followed by that many
+/// (cpu, io, device) uint32_t triples
+/// \param input_file the file to read
+/// \return new trace pointer, NULL on error (unreadable file or invalid trace)
+///
+IoTrace_t *load_io_trace(const char *input_file);
+
+///
+/// Trace destructor
+/// \param trace the trace to destroy
+///
+void io_trace_destroy(IoTrace_t *const trace);
+
+///
+/// Runs the trace's processes and their I/O under one policy
+/// \param trace the trace, at least one process
+/// \param policy the CPU scheduling policy
+/// \param quantum round robin's time slice (ignored by the other policies)
+/// \param result the schedule's results and CPU and device usage
+/// \return true if function ran successful else false for an error
+///
+bool schedule_io(const IoTrace_t *const trace, const IO_POLICY policy, const size_t quantum, IoScheduleResult_t *result);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
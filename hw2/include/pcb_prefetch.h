@@ -0,0 +1,80 @@
+#ifndef PCB_PREFETCH_H
+#define PCB_PREFETCH_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+typedef struct pcb_prefetch pcb_prefetch_t;
+
+/*
+	Prefetch notes!
+
+	load_process_control_blocks reads the whole file before it returns, so a loop
+	that loads a file and then schedules it leaves the disk idle while it computes
+	and the CPU idle while it reads. A prefetcher loads the next files on a
+	background thread while the caller schedules the current one: the caller asks
+	for files one at a time and usually finds the next one already loaded.
+
+	The background thread asks a callback for each path just before it loads it, so
+	several prefetchers can share one list of files (each claims the next file only
+	once it has room for it). It stays at most depth files ahead of the caller.
+
+	Files are read with io_uring where the kernel allows it, a chunk ahead of the
+	one being converted into PCBs, and with pread otherwise. Both give the same
+	PCBs as load_process_control_blocks.
+
+	Arrays handed back with pcb_prefetch_recycle are loaded into again, so a caller
+	that recycles each array once it is done with it keeps depth + 1 of them alive
+	(double buffered with the default depth of 1) and stops allocating once they have
+	grown to the biggest file.
+*/
+
+///
+/// Starts loading files in the background
+/// \param next_file returns the next file to load, NULL once there are no more (called on the background thread)
+/// \param context passed to next_file
+/// \param depth files loaded ahead of the caller, at least 1
+/// \return new prefetcher pointer, NULL on error
+///
+pcb_prefetch_t *pcb_prefetch_start(const char *(*next_file)(void *context), void *context, const size_t depth);
+
+///
+/// Waits for the next file
+/// \param prefetch the prefetcher
+/// \param path set to the file's path, NULL once every file has been handed out
+/// \param load_seconds set to the time spent loading the file (NULL if not wanted)
+/// \return the file's PCBs in a dyn_array the caller now owns, NULL if it could not be loaded or there are no more files
+///
+dyn_array_t *pcb_prefetch_next(pcb_prefetch_t *const prefetch, const char **path, double *load_seconds);
+
+///
+/// Gives an array from pcb_prefetch_next back to be loaded into again (or destroyed if enough are spare)
+/// \param prefetch the prefetcher
+/// \param pcbs the array, its contents are dropped
+///
+void pcb_prefetch_recycle(pcb_prefetch_t *const prefetch, dyn_array_t *const pcbs);
+
+///
+/// Stops the background thread (it finishes the file it is loading) and frees every array it still holds
+/// \param prefetch the prefetcher to destroy
+///
+void pcb_prefetch_destroy(pcb_prefetch_t *const prefetch);
+
+///
+/// Tells whether prefetchers read with io_uring on this system
+/// \return true if io_uring works here, false if they fall back to pread
+///
+bool pcb_prefetch_uses_uring(void);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef PCB_QUEUE_H
+#define PCB_QUEUE_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+typedef struct pcb_queue pcb_queue_t;
+
+/*
+	Submission queue notes!
+
+	A dyn_array is not thread safe, so threads that generate PCBs for one scheduler
+	hand them over through a pcb_queue instead: any number of producer threads push,
+	one consumer thread drains what has arrived into its dyn_array in batches.
+
+	The queue is a bounded ring (Vyukov style): every slot carries a sequence number
+	that says whether it is free for the current lap or holds a published PCB.
+	Producers claim a run of slots with one compare and swap on the tail, fill them
+	in and publish each one, so nobody ever waits on a lock and a batch costs one
+	contended update whatever its size. The consumer owns the head.
+
+	Pushing never blocks: a full queue takes fewer PCBs (or none) and says so.
+	PCBs from one producer come out in the order it pushed them. A producer that stops
+	between claiming its slots and publishing them holds up the consumer at that point
+	until it goes on, later slots are still filled in but not drained past it.
+*/
+
+///
+/// Creates an empty queue
+/// \param capacity PCBs it can hold, rounded up to a power of two (at least 1, at most SIZE_MAX / 2 + 1)
+/// \return new queue pointer, NULL on error
+///
+pcb_queue_t *pcb_queue_create(const size_t capacity);
+
+///
+/// Queue destructor, no thread may be using it any more
+/// \param queue the queue to destroy
+///
+void pcb_queue_destroy(pcb_queue_t *const queue);
+
+///
+/// Returns the number of PCBs the queue can hold
+/// \param queue the queue
+/// \return capacity, 0 on error
+///
+size_t pcb_queue_capacity(const pcb_queue_t *const queue);
+
+///
+/// Submits a PCB, from any thread
+/// \param queue the queue
+/// \param pcb the PCB to copy in
+/// \return bool representing success of the operation (false when the queue is full)
+///
+bool pcb_queue_push(pcb_queue_t *const queue, const ProcessControlBlock_t *const pcb);
+
+///
+/// Submits as many PCBs of a batch as there is room for, from any thread
+/// \param queue the queue
+/// \param pcbs the PCBs to copy in, in order
+/// \param count number of PCBs in the batch
+/// \return number of PCBs taken from the front of the batch, 0 on error or when the queue is full
+///
+size_t pcb_queue_push_n(pcb_queue_t *const queue, const ProcessControlBlock_t *const pcbs, const size_t count);
+
+///
+/// Moves PCBs that have been published onto the back of a dyn_array, oldest first.
+/// Only one thread may drain a queue. A PCB leaves the queue once it is in the array,
+/// so PCBs are never lost when the array fails to grow.
+/// \param queue the queue
+/// \param into dyn_array of ProcessControlBlock_t to append to
+/// \param max the most PCBs to move
+/// \return number of PCBs moved, 0 on error or when nothing is ready
+///
+size_t pcb_queue_drain(pcb_queue_t *const queue, dyn_array_t *const into, const size_t max);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef PCB_VIEW_H
+#define PCB_VIEW_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+typedef struct pcb_view pcb_view_t;
+
+/*
+	View notes!
+
+	A view is a read-only window over a loaded set of PCBs. It never copies or
+	reorders the PCBs, so the same dyn_array can be handed to any number of
+	schedulers one after another (or at the same time).
+
+	Schedulers want the PCBs in some order (by arrival, burst or priority).
+	The view sorts an index permutation the first time an order is asked for
+	and hands the same permutation to every later caller. Ties are broken by
+	the original index, so every order is stable.
+
+	The view borrows the PCB storage: do not modify, grow or destroy the
+	dyn_array while a view over it is alive.
+
+	Orders are computed lazily, which writes to the view. If several threads
+	share one view, call pcb_view_prepare for the orders they need first.
+*/
+
+typedef enum { PCB_ORDER_ARRIVAL = 0, PCB_ORDER_BURST, PCB_ORDER_PRIORITY, PCB_ORDER_COUNT } PCB_ORDER;
+
+///
+/// Creates a read-only view over a dyn_array of ProcessControlBlock_t
+/// \param pcbs the PCBs to view, must hold ProcessControlBlock_t and at most UINT32_MAX of them
+/// \return new view pointer, NULL on error
+///
+pcb_view_t *pcb_view_create(const dyn_array_t *const pcbs);
+
+///
+/// Points the view at another dyn_array of PCBs, dropping the cached orders but keeping their storage,
+/// so one view can serve trace after trace without reallocating once it has grown
+/// \param view the view
+/// \param pcbs the PCBs to view from now on, same requirements as pcb_view_create
+/// \return bool representing success of the operation (the view is unchanged on failure)
+///
+bool pcb_view_rebind(pcb_view_t *const view, const dyn_array_t *const pcbs);
+
+///
+/// Destroys the view and its cached orders (the viewed PCBs are untouched)
+/// \param view the view to destroy
+///
+void pcb_view_destroy(pcb_view_t *const view);
+
+///
+/// Returns the number of PCBs in the view
+/// \param view the view
+/// \return the PCB count, 0 on error
+///
+size_t pcb_view_size(const pcb_view_t *const view);
+
+///
+/// Returns the viewed PCBs in their original order
+/// \param view the view
+/// \return pointer to the first PCB, NULL on error
+///
+const ProcessControlBlock_t *pcb_view_pcbs(const pcb_view_t *const view);
+
+///
+/// Sets how many threads compute the orders that are not cached yet (default 1)
+/// \param view the view
+/// \param nthreads thread count handed to dyn_array_sort_parallel (0 uses one per online CPU)
+///
+void pcb_view_set_sort_threads(pcb_view_t *const view, const size_t nthreads);
+
+// Orders of fewer PCBs than this are sorted on the calling thread, whatever the sort thread count
+#ifndef PCB_VIEW_PARALLEL_SORT_THRESHOLD
+#define PCB_VIEW_PARALLEL_SORT_THRESHOLD ((size_t) 1 << 16)
+#endif
+
+///
+/// Computes the requested order if it is not cached yet
+/// PCBs that are already in the requested order (e.g. loaded sorted) cost a single pass
+/// \param view the view
+/// \param order the order to compute
+/// \return bool representing success of the operation
+///
+bool pcb_view_prepare(pcb_view_t *const view, const PCB_ORDER order);
+
+///
+/// Returns the permutation that visits the PCBs in the requested order
+/// (order[0] is the index of the earliest/shortest/most important PCB)
+/// \param view the view
+/// \param order the order wanted
+/// \return pointer to pcb_view_size() indexes, NULL on error
+///
+const uint32_t *pcb_view_order(pcb_view_t *const view, const PCB_ORDER order);
+
+// Scheduler entry points that work on a view instead of a dyn_array.
+// They behave exactly like their dyn_array counterparts in processing_scheduling.h,
+// but never modify the PCBs and reuse the orders cached in the view.
+bool first_come_first_serve_view(pcb_view_t *view, ScheduleResult_t *result);
+bool shortest_job_first_view(pcb_view_t *view, ScheduleResult_t *result);
+bool priority_view(pcb_view_t *view, ScheduleResult_t *result);
+bool round_robin_view(pcb_view_t *view, ScheduleResult_t *result, size_t quantum);
+bool shortest_remaining_time_first_view(pcb_view_t *view, ScheduleResult_t *result);
+
+// first_come_first_serve_view hands traces of at least this many PCBs to the parallel version
+// (when more than one thread is allowed, see set_schedule_threads)
+#ifndef SCHED_PARALLEL_FCFS_THRESHOLD
+#define SCHED_PARALLEL_FCFS_THRESHOLD ((size_t) 1 << 20)
+#endif
+
+///
+/// Multi-threaded First Come First Served, same results as first_come_first_serve_view
+/// Completion times follow c = max(c_prev, arrival) + burst, which composes over a block of
+/// PCBs into c_out = max(c_in + work, c_from_zero). Pass one finds that pair per block in
+/// parallel, a short serial scan chains the blocks, pass two replays every block from its
+/// real start time in parallel and accumulates the metrics.
+/// \param view the PCBs to schedule
+/// \param result used for first come first served stat tracking \ref ScheduleResult_t
+/// \param nthreads number of threads (0 uses one per online CPU)
+/// \return true if function ran successful else false for an error
+///
+bool first_come_first_serve_parallel_view(pcb_view_t *view, ScheduleResult_t *result, size_t nthreads);
+
+// Non-preemptive policies the busy period engine can run
+typedef enum { BUSY_PERIOD_FCFS = 0, BUSY_PERIOD_SJF, BUSY_PERIOD_PRIORITY } BUSY_PERIOD_POLICY;
+
+// shortest_job_first_view and priority_view hand traces of at least this many PCBs to the
+// busy period engine (when more than one thread is allowed, see set_schedule_threads)
+#ifndef SCHED_PARALLEL_BUSY_PERIOD_THRESHOLD
+#define SCHED_PARALLEL_BUSY_PERIOD_THRESHOLD ((size_t) 1 << 16)
+#endif
+
+///
+/// Multi-threaded non-preemptive scheduling by busy periods, same results as the matching view scheduler
+/// Every idle gap splits the timeline into busy periods that cannot affect each other.
+/// The periods are found with one pass in arrival order, then simulated concurrently
+/// (each with a ready heap) and their metrics summed. Scales with the number of periods,
+/// a trace without idle gaps is one period and runs on one thread.
+/// \param view the PCBs to schedule
+/// \param policy which scheduler to reproduce
+/// \param result used for stat tracking \ref ScheduleResult_t
+/// \param nthreads number of threads (0 uses one per online CPU)
+/// \return true if function ran successful else false for an error
+///
+bool busy_period_view(pcb_view_t *view, BUSY_PERIOD_POLICY policy, ScheduleResult_t *result, size_t nthreads);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -24,15 +24,86 @@
 		float average_waiting_time;	 // the average waiting time in the ready queue until first schedue on the cpu
 		float average_turnaround_time;  // the average completion time of the PCBs
 		unsigned long total_run_time;   // the total time to process all the PCBs in the ready queue
+		unsigned long context_switches; // number of times the CPU switched from one process to another
+		unsigned long overhead_time;	// time spent dispatching and context switching instead of running PCBs
+		double mean_waiting_time;		// full precision average waiting time (the float fields are rounded from this)
+		double mean_turnaround_time;	// full precision average turnaround time
+		uint64_t total_waiting_time;	// exact sum of all waiting times, UINT64_MAX if the sum does not fit
+		uint64_t total_turnaround_time; // exact sum of all turnaround times, UINT64_MAX if the sum does not fit
+		uint64_t process_count;			// number of PCBs the averages are taken over
 	} 
 	ScheduleResult_t;
 
+	typedef struct
+	{
+		uint32_t context_switch_cost;	// time charged whenever the CPU switches to a different process
+		uint32_t dispatch_cost;			// time charged every time a process is handed the CPU (every slice for RR)
+	}
+	ScheduleOverhead_t;
+
+	// Hot-path counters, only collected in builds with SCHED_STATS defined (cmake -DSCHED_STATS=ON).
+	// Counters are kept per thread and cover everything since the last reset, so reset right before
+	// a run and read right after it. Threads a scheduler starts hand their counts back to the caller.
+	typedef struct
+	{
+		uint64_t dispatches;			// times a process was handed the CPU
+		uint64_t pcbs_scanned;			// PCBs looked at while picking who runs next (per dispatch: / dispatches)
+		uint64_t comparisons;			// key comparisons, while scheduling and while sorting (dyn_array)
+		uint64_t context_switches;		// dispatches that switched to a different process
+		uint64_t clock_jumps;			// times the simulated clock moved by more than one unit at once
+		uint64_t unit_ticks;			// times it moved by exactly one unit
+		uint64_t reallocs;				// dyn_array storage growths
+		uint64_t bytes_moved;			// bytes memmoved by dyn_array inserts/removes away from the back
+		uint64_t mallocs;				// heap allocations by the schedulers and dyn_array
+	}
+	ScheduleStats_t;
+
+	// Tells whether this build collects ScheduleStats_t counters
+	// \return true when built with SCHED_STATS
+	bool schedule_stats_enabled(void);
+
+	// Zeroes the calling thread's counters (scheduler and dyn_array)
+	void reset_schedule_stats(void);
+
+	// Returns the calling thread's counters
+	// \return counters since the last reset, all zero when stats are compiled out
+	ScheduleStats_t get_schedule_stats(void);
+
+	// Sets the overhead model applied by every scheduler below.
+	// Overhead is charged before the dispatched process runs, so it shows up in waiting time,
+	// turnaround time and total run time. Both costs default to 0 (free switches).
+	// The settings are global; set them before running schedulers, not while they run.
+	// \param overhead the costs to apply, NULL resets both costs to 0
+	void set_schedule_overhead(const ScheduleOverhead_t *overhead);
+
+	// Returns the overhead model currently applied by the schedulers
+	// \return the current costs
+	ScheduleOverhead_t get_schedule_overhead(void);
+
+	// Sets how many threads the schedulers may use for sorting (and, where supported, scheduling).
+	// Defaults to 0, which uses one thread per online CPU. 1 keeps everything on the calling thread.
+	// Threads only kick in for large inputs (see SCHED_PARALLEL_FCFS_THRESHOLD, DYN_SORT_PARALLEL_CUTOFF).
+	// Like the overhead model this is global; set it before running schedulers.
+	// \param nthreads the thread count
+	void set_schedule_threads(size_t nthreads);
+
+	// Returns the thread count set by set_schedule_threads
+	// \return the thread count (0 meaning one per online CPU)
+	size_t get_schedule_threads(void);
+
 	// Reads the PCB burst time values from the binary file into ProcessControlBlock_t remaining_burst_time field
 	// for N number of PCB burst time stored in the file.
 	// \param input_file the file containing the PCB burst times
 	// \return a populated dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
 	dyn_array_t *load_process_control_blocks(const char *input_file);
 
+	// Same as load_process_control_blocks, but the PCBs come back stably sorted by arrival,
+	// so schedulers that want arrival order can skip their own sort.
+	// \param input_file the file containing the PCB burst times
+	// \param nthreads thread count for the sort (0 uses one per online CPU)
+	// \return a populated, arrival-sorted dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
+	dyn_array_t *load_process_control_blocks_sorted(const char *input_file, size_t nthreads);
+
 	// Runs the First Come First Served Process Scheduling algorithm over the incoming ready_queue
 	// \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
 	// \param result used for first come first served stat tracking \ref ScheduleResult_t
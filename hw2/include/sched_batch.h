@@ -0,0 +1,76 @@
+#ifndef SCHED_BATCH_H
+#define SCHED_BATCH_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "processing_scheduling.h"
+
+/*
+	Batch notes!
+
+	Test corpora hold millions of tiny workloads, a handful to a few dozen PCBs each.
+	Scheduling them one call (or one process) at a time spends most of the time on
+	setup: allocating the array, sorting it, building the ready queue. schedule_batch
+	takes many workloads packed in one buffer and schedules them together.
+
+	The buffer is simply PCB files back to back: for each workload a count N, then N
+	(burst, priority, arrival) triples of 32 bit words, the same layout
+	load_process_control_blocks reads. Concatenating pcb.bin style files makes a batch.
+
+	Workloads are scheduled a group at a time, one workload per 64 bit lane of a
+	vector (GCC vector extensions, so it is plain C on any target; the group is as wide
+	as the target's vector registers: 2 lanes, 4 with AVX2, 8 with AVX-512). A group's
+	PCBs are laid out transposed, the k-th arrival of every workload side by side.
+	FCFS is then one pass of max/add down the group. SJF and RR keep each lane's ready
+	PCBs as a 64 bit set (in burst order for SJF, index order for RR), so every lane
+	picks its next dispatch with a few mask operations: the lowest bit for SJF, the
+	lowest at or after the sweep for RR. Lanes whose workload has finished are masked
+	out while the others carry on.
+
+	Workloads with more than SCHED_BATCH_MAX_PCBS PCBs, and RR workloads whose slices
+	would keep a group going much longer than its other lanes, are scheduled by the
+	regular schedulers instead. Either way every result is the same as running
+	first_come_first_serve, shortest_job_first or round_robin on that workload alone,
+	with the overhead model in effect when the batch starts.
+
+	Everything runs on the calling thread. Nothing is allocated for workloads that fit
+	in a lane.
+*/
+
+// Most PCBs a workload can have and still be scheduled in a vector lane
+#define SCHED_BATCH_MAX_PCBS 64
+
+typedef enum { BATCH_POLICY_FCFS = 0, BATCH_POLICY_SJF, BATCH_POLICY_RR } BATCH_POLICY;
+
+///
+/// Counts the workloads in a packed buffer, checking that they fill it exactly
+/// \param packed the workloads, each a count N followed by N (burst, priority, arrival) triples
+/// \param words length of the buffer in 32 bit words
+/// \return number of workloads, 0 if the buffer is empty, malformed or holds an empty workload
+///
+size_t schedule_batch_count(const uint32_t *const packed, const size_t words);
+
+///
+/// Schedules every workload in a packed buffer
+/// \param packed the workloads, each a count N followed by N (burst, priority, arrival) triples
+/// \param words length of the buffer in 32 bit words
+/// \param policy which scheduler to run on each workload
+/// \param quantum the round robin quantum (ignored by the others)
+/// \param results one per workload, in buffer order \ref ScheduleResult_t
+/// \param count number of results, must be schedule_batch_count of the buffer
+/// \return bool representing success of the operation
+///
+bool schedule_batch(const uint32_t *const packed, const size_t words, const BATCH_POLICY policy, const size_t quantum,
+	ScheduleResult_t *results, const size_t count);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef SCHED_CHECKPOINT_H
+#define SCHED_CHECKPOINT_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+/*
+	Checkpoint notes!
+
+	Round robin and SRT on a big trace can run for hours, and a run that gets killed
+	has to start over. The checkpointed versions below save the simulation every so
+	many dispatches and can pick it up again from the last save, with results
+	identical to a run that never stopped.
+
+	A checkpoint holds everything the event loop has between two dispatches: the
+	clock, the arrival cursor (how far into the trace's arrival order it has admitted
+	PCBs), the round robin sweep, the process holding the CPU, the partial sums of the
+	metrics and every PCB's remaining burst. The ready queue is not stored, it holds
+	exactly the admitted PCBs with work left (except the running one) and their keys
+	follow from the rest, so a resumed run rebuilds it.
+
+	Saving must not hold the simulation up, so the run forks: the child writes its
+	copy-on-write snapshot of the state to path.tmp, syncs it and renames it over path,
+	while the parent carries on. The file at path is therefore always a whole
+	checkpoint. If the previous child is still writing when the next save is due, that
+	save is skipped. If fork fails the save is written in place instead.
+
+	A checkpoint also records the run it belongs to: the algorithm, the quantum, the
+	overhead model and a hash of the PCBs. Resuming from a checkpoint of another run
+	(or a damaged file) fails rather than mixing the two. Resuming with no file at path
+	just starts from the beginning. The file is left in place when the run finishes.
+
+	Traces where every PCB arrives at once take round robin's closed form instead of
+	the simulation, which needs no checkpoints, so none are written for them.
+
+	Forking from a process with other threads running is fine, the child only writes
+	the file and exits.
+*/
+
+typedef struct
+{
+	const char *path;	// checkpoint file (path.tmp is used while writing)
+	uint64_t every;		// dispatches between saves, 0 never saves
+	bool resume;		// pick the run up from path if there is a checkpoint there
+	bool resumed;		// out: the run started from a checkpoint
+	uint64_t written;	// out: saves that made it to path
+} sched_checkpoint_t;
+
+///
+/// Runs round_robin, saving and resuming the simulation through a checkpoint file
+/// \param ready_queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+/// \param result used for round robin stat tracking \ref ScheduleResult_t
+/// \param quantum the quantum
+/// \param checkpoint where and how often to save, and whether to resume
+/// \return true if function ran successful else false for an error (including a checkpoint of another run)
+///
+bool round_robin_checkpointed(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum,
+	sched_checkpoint_t *checkpoint);
+
+///
+/// Runs shortest_remaining_time_first, saving and resuming the simulation through a checkpoint file
+/// \param ready_queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+/// \param result used for shortest remaining time stat tracking \ref ScheduleResult_t
+/// \param checkpoint where and how often to save, and whether to resume
+/// \return true if function ran successful else false for an error (including a checkpoint of another run)
+///
+bool shortest_remaining_time_first_checkpointed(dyn_array_t *ready_queue, ScheduleResult_t *result,
+	sched_checkpoint_t *checkpoint);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
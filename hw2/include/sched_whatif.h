@@ -0,0 +1,99 @@
+#ifndef SCHED_WHATIF_H
+#define SCHED_WHATIF_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "processing_scheduling.h"
+#include "pcb_view.h"
+
+typedef struct sched_whatif sched_whatif_t;
+
+/*
+	What-if notes!
+
+	Capacity planning asks the same question over and over: what happens to the
+	schedule if job k takes twice as long, arrives later, or gets another priority?
+	Re-running the scheduler answers it in O(n log n) each time, even though an edit
+	late in the trace cannot change anything dispatched before it.
+
+	A what-if runs the baseline schedule once and keeps, for every dispatch, the
+	process it ran and when that process completed. An evaluation applies a few edits
+	on top of the baseline and recomputes only what they can change:
+
+	FCFS runs in arrival order, so the edits only move their own PCBs in that order.
+	Everything before the first moved or edited PCB stays put. From there completion
+	times are recomputed one after another (c = max(c, arrival) + overhead + burst)
+	until the schedule is back in the baseline's order with a completion time equal
+	to the baseline's. Nothing after that point can differ. An edit that doesn't
+	push the queue past an idle gap costs only the PCBs up to that gap.
+
+	SJF and priority keep a max tree over the dispatches' keys. An edited PCB first
+	changes the schedule at the earlier of its own dispatch and the first dispatch
+	that happens after it has arrived and that it now beats (or that the baseline
+	reached only by idling). That dispatch is found in O(log n), and the schedule is
+	simulated from there to the end, starting from the baseline's clock and ready
+	queue at that point.
+
+	Either way, the result is the baseline's result plus the difference over the
+	recomputed dispatches: their old contributions to the sums come out, their new
+	ones go in. It is identical to running the scheduler on the edited trace with
+	the overhead model that was in effect when the what-if was created.
+
+	Evaluations never change the baseline, so each one is measured against the
+	original trace. The what-if borrows the view (and through it the PCBs), which must
+	stay alive and unmodified while it is in use.
+*/
+
+typedef enum { WHATIF_FCFS = 0, WHATIF_SJF, WHATIF_PRIORITY } WHATIF_POLICY;
+
+typedef struct
+{
+	uint32_t index;					// PCB to change (position in the view)
+	ProcessControlBlock_t pcb;		// its new burst, priority and arrival
+} sched_whatif_edit_t;
+
+///
+/// Runs the baseline schedule and keeps what evaluations need
+/// \param view the trace, borrowed until the what-if is destroyed
+/// \param policy which scheduler to reproduce
+/// \return new what-if pointer, NULL on error
+///
+sched_whatif_t *sched_whatif_create(pcb_view_t *view, const WHATIF_POLICY policy);
+
+///
+/// What-if destructor (the view is untouched)
+/// \param whatif the what-if to destroy
+///
+void sched_whatif_destroy(sched_whatif_t *const whatif);
+
+///
+/// Returns the baseline's result
+/// \param whatif the what-if
+/// \param result filled in with the baseline schedule's stats \ref ScheduleResult_t
+/// \return bool representing success of the operation
+///
+bool sched_whatif_baseline(const sched_whatif_t *const whatif, ScheduleResult_t *result);
+
+///
+/// Schedules the baseline trace with some PCBs edited, recomputing only what the edits change
+/// \param whatif the what-if (its baseline stays as it is)
+/// \param edits the changes, at most one per PCB
+/// \param count number of edits
+/// \param result filled in with the edited schedule's stats \ref ScheduleResult_t
+/// \param recomputed set to the number of dispatches that were recomputed (NULL if not wanted)
+/// \return bool representing success of the operation
+///
+bool sched_whatif_evaluate(sched_whatif_t *const whatif, const sched_whatif_edit_t *const edits, const size_t count,
+	ScheduleResult_t *result, size_t *recomputed);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SCHED_WORKERS_H
+#define SCHED_WORKERS_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stddef.h>
+
+/*
+	Workers notes!
+
+	The schedulers fan work out over a small pool of threads started per call, nothing
+	is kept running between calls. The same pool is here for callers with their own
+	independent jobs (analysis' batch and fork modes hand out files and workloads with it).
+*/
+
+///
+/// Resolves a thread count where 0 means one per online CPU
+/// \param nthreads the count asked for
+/// \return nthreads, or the online CPU count (at least 1) if it was 0
+///
+size_t sched_resolve_threads(size_t nthreads);
+
+///
+/// Runs task(context, worker) for worker = 0..workers-1, one thread each (worker 0 on the calling thread)
+/// Returns once every worker is done. Workers that can't get a thread run on the calling thread.
+/// \param workers number of workers, nothing runs if 0
+/// \param task the work, told which worker it is
+/// \param context handed to every worker as is
+///
+void sched_run_workers(size_t workers, void (*task)(void *context, size_t worker), void *context);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SCHED_WORKSPACE_H
+#define SCHED_WORKSPACE_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+#include "pcb_view.h"
+
+typedef struct sched_workspace sched_workspace_t;
+
+/*
+	Workspace notes!
+
+	Every scheduler needs scratch memory (remaining bursts, finish times, done flags...).
+	The plain entry points allocate it on every call and free it on the way out.
+	A workspace keeps that memory between calls instead: buffers only ever grow, so once
+	a workspace has seen a trace, running any scheduler on a trace of the same size or
+	smaller allocates nothing.
+
+	The dyn_array _ws variants also keep a view inside the workspace and rebind it to
+	each trace, so the sorted orders reuse their storage too.
+
+	The parallel engines (huge FCFS/SJF/priority traces with more than one thread allowed)
+	still allocate their per-thread state, the threads cost far more than the memory.
+
+	A workspace is not thread safe, give each thread its own.
+*/
+
+///
+/// Creates an empty workspace (nothing is allocated until a scheduler needs it)
+/// \return new workspace pointer, NULL on error
+///
+sched_workspace_t *sched_workspace_create(void);
+
+///
+/// Destroys the workspace and everything it holds
+/// \param ws the workspace to destroy
+///
+void sched_workspace_destroy(sched_workspace_t *const ws);
+
+///
+/// Grows the scratch buffers up front for traces of up to pcb_count PCBs
+/// (optional, the schedulers grow them on demand)
+/// \param ws the workspace
+/// \param pcb_count number of PCBs to make room for
+/// \return bool representing success of the operation
+///
+bool sched_workspace_reserve(sched_workspace_t *const ws, const size_t pcb_count);
+
+// Same as the schedulers in processing_scheduling.h, with scratch memory taken from ws
+bool first_come_first_serve_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, sched_workspace_t *ws);
+bool shortest_job_first_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, sched_workspace_t *ws);
+bool priority_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, sched_workspace_t *ws);
+bool round_robin_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum, sched_workspace_t *ws);
+bool shortest_remaining_time_first_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, sched_workspace_t *ws);
+
+// Same as the view schedulers in pcb_view.h, with scratch memory taken from ws
+bool first_come_first_serve_view_ws(pcb_view_t *view, ScheduleResult_t *result, sched_workspace_t *ws);
+bool shortest_job_first_view_ws(pcb_view_t *view, ScheduleResult_t *result, sched_workspace_t *ws);
+bool priority_view_ws(pcb_view_t *view, ScheduleResult_t *result, sched_workspace_t *ws);
+bool round_robin_view_ws(pcb_view_t *view, ScheduleResult_t *result, size_t quantum, sched_workspace_t *ws);
+bool shortest_remaining_time_first_view_ws(pcb_view_t *view, ScheduleResult_t *result, sched_workspace_t *ws);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct timing_wheel timing_wheel_t;
+
+/*
+	Timing wheel notes!
+
+	A timing wheel is an event queue keyed by time: events (arrivals, quantum
+	timers, ...) go in with the time they are due and come back out in time
+	order as the wheel's clock moves forward. It is a hierarchical wheel like
+	the classic Linux timer wheel: 64 slots per level, each level one 6 bit
+	digit of the 64 bit time. An event sits at the level of the highest digit
+	where it differs from the clock, and drops a level (cascades) when the
+	clock reaches its slot, so it moves at most 11 times in its life.
+	Insert and cancel are constant time, expiring is amortized constant time,
+	and nothing ever scans the events that aren't due yet.
+
+	Events are ids below the wheel's capacity (PCB indexes, say), each in the
+	wheel at most once. The wheel only stores the id and its time.
+
+	Events due at the same time come out in no particular order. An event
+	inserted at or before the clock is due straight away.
+*/
+
+///
+/// Creates an empty wheel
+/// \param capacity ids 0 to capacity - 1 can be inserted (less than UINT32_MAX - 1)
+/// \param now the wheel's starting time
+/// \return new wheel pointer, NULL on error
+///
+timing_wheel_t *timing_wheel_create(const size_t capacity, const uint64_t now);
+
+///
+/// Wheel destructor
+/// \param wheel the wheel to destroy
+///
+void timing_wheel_destroy(timing_wheel_t *const wheel);
+
+///
+/// Drops every pending event and restarts the wheel, keeping its storage when it's big enough
+/// \param wheel the wheel
+/// \param capacity ids 0 to capacity - 1 can be inserted from now on
+/// \param now the wheel's new time
+/// \return bool representing success of the operation (on failure the wheel is empty and may take no ids)
+///
+bool timing_wheel_reset(timing_wheel_t *const wheel, const size_t capacity, const uint64_t now);
+
+///
+/// Schedules an event
+/// \param wheel the wheel
+/// \param id the event, below the capacity and not already pending
+/// \param expiry when the event is due
+/// \return bool representing success of the operation
+///
+bool timing_wheel_insert(timing_wheel_t *const wheel, const uint32_t id, const uint64_t expiry);
+
+///
+/// Removes a pending event before it expires
+/// \param wheel the wheel
+/// \param id the event
+/// \return bool representing success of the operation (false if it wasn't pending)
+///
+bool timing_wheel_cancel(timing_wheel_t *const wheel, const uint32_t id);
+
+///
+/// Advances the clock towards now and removes the earliest event due by then.
+/// The clock stops at the returned event's time, so call this until it returns
+/// false to expire everything due by now (the clock is then at now).
+/// The clock never goes backwards: an earlier now only expires what is already due.
+/// \param wheel the wheel
+/// \param now the time to advance to
+/// \param id set to the expired event
+/// \param expiry set to the time it was due (NULL if not wanted)
+/// \return bool true if an event expired, false once nothing is due by now
+///
+bool timing_wheel_expire(timing_wheel_t *const wheel, const uint64_t now, uint32_t *const id, uint64_t *const expiry);
+
+///
+/// Finds when the next event is due
+/// \param wheel the wheel
+/// \param expiry set to the earliest pending expiry
+/// \return bool false if nothing is pending
+///
+bool timing_wheel_next_expiry(timing_wheel_t *const wheel, uint64_t *const expiry);
+
+///
+/// Returns the number of pending events
+/// \param wheel the wheel
+/// \return number of pending events, 0 on error
+///
+size_t timing_wheel_size(const timing_wheel_t *const wheel);
+
+///
+/// Returns the wheel's clock
+/// \param wheel the wheel
+/// \return the wheel's current time, 0 on error
+///
+uint64_t timing_wheel_now(const timing_wheel_t *const wheel);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -1,9 +1,30 @@
+// clock_gettime(), opendir() and stat() for batch mode, MAP_ANONYMOUS for fork mode
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 #define SRT "SRT"
 
 #include "dyn_array.h"
+#include "io_scheduling.h"
 #include "processing_scheduling.h"
+#include "pcb_prefetch.h"
+#include "pcb_view.h"
+#include "sched_checkpoint.h"
+#include "sched_workers.h"
+#include "sched_workspace.h"
 
 #define FCFS "FCFS"
 #define P "P"
@@ -12,14 +33,707 @@
 
 //Github test message
 
+// Dispatches between checkpoints when --checkpoint is given without --checkpoint-every
+#define CHECKPOINT_DEFAULT_EVERY (1u << 28)
+
+// Parses a non-negative number (overhead cost, thread count) given on the command line
+static bool parse_cost(const char *text, uint32_t *cost)
+{
+    unsigned long value = 0;
+    char extra;
+    if(sscanf(text, "%lu%c", &value, &extra) != 1 || value > UINT32_MAX) {
+        return false;
+    }
+    *cost = (uint32_t)value;
+    return true;
+}
+
+/*
+	Batch mode.
+
+	analysis --batch [options] <pcb file | directory>... [--list FILE]
+	Every file is loaded once and run through every requested algorithm (RR once per
+	quantum). Files are handed out to a fixed pool of workers, each worker writes one
+	row per file/algorithm/quantum as soon as it has it, so rows come out in completion
+	order. Loading and scheduling are timed separately, in seconds.
+	Each worker's next file is loaded in the background (pcb_prefetch.h) while it
+	schedules the current one, so reading and scheduling overlap.
+*/
+
+typedef enum { BATCH_CSV, BATCH_JSONL } batch_format_t;
+
+// One scheduler run per loaded file
+typedef struct
+{
+    const char *algorithm;
+    size_t quantum;                 // RR only, 0 otherwise
+} batch_run_t;
+
+typedef struct
+{
+    char **files;
+    size_t file_count;
+    batch_run_t *runs;
+    size_t run_count;
+    batch_format_t format;
+    FILE *out;
+    pthread_mutex_t out_lock;       // rows are written whole
+    atomic_size_t next_file;
+    atomic_bool failed;
+} batch_t;
+
+static double batch_seconds_since(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static bool batch_schedule(pcb_view_t *view, const batch_run_t *run, ScheduleResult_t *result, sched_workspace_t *ws)
+{
+    if(strcmp(run->algorithm, FCFS) == 0) return first_come_first_serve_view_ws(view, result, ws);
+    if(strcmp(run->algorithm, SJF) == 0) return shortest_job_first_view_ws(view, result, ws);
+    if(strcmp(run->algorithm, P) == 0) return priority_view_ws(view, result, ws);
+    if(strcmp(run->algorithm, RR) == 0) return round_robin_view_ws(view, result, run->quantum, ws);
+    if(strcmp(run->algorithm, SRT) == 0) return shortest_remaining_time_first_view_ws(view, result, ws);
+    return false;
+}
+
+static void batch_put_string(FILE *out, batch_format_t format, const char *text)
+{
+    fputc('"', out);
+    for(const unsigned char *c = (const unsigned char *)text; *c; c++) {
+        if(format == BATCH_CSV) {
+            if(*c == '"') fputc('"', out);
+            fputc(*c, out);
+        }
+        else if(*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        }
+        else if(*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        }
+        else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Writes one row, status is "ok", "load_error" or "schedule_error" (the metrics are 0 unless "ok")
+static void batch_write_row(batch_t *batch, const char *file, const batch_run_t *run, const char *status,
+                            size_t pcb_count, double load_seconds, double schedule_seconds, const ScheduleResult_t *res)
+{
+    FILE *out = batch->out;
+    pthread_mutex_lock(&batch->out_lock);
+    if(batch->format == BATCH_CSV) {
+        batch_put_string(out, BATCH_CSV, file);
+        fprintf(out, ",%s,%zu,%s,%zu,%.9f,%.9f,%.6f,%.6f,%lu,%lu,%" PRIu64 ",%" PRIu64 ",%lu,%lu\n",
+                run->algorithm, run->quantum, status, pcb_count, load_seconds, schedule_seconds,
+                res->mean_waiting_time, res->mean_turnaround_time, res->total_run_time, res->context_switches,
+                res->total_waiting_time, res->total_turnaround_time, res->overhead_time, (unsigned long)res->process_count);
+    }
+    else {
+        fputs("{\"file\":", out);
+        batch_put_string(out, BATCH_JSONL, file);
+        fprintf(out, ",\"algorithm\":\"%s\",\"quantum\":%zu,\"status\":\"%s\",\"pcbs\":%zu,"
+                "\"load_seconds\":%.9f,\"schedule_seconds\":%.9f,\"avg_wait\":%.6f,\"avg_turnaround\":%.6f,"
+                "\"total_run_time\":%lu,\"context_switches\":%lu,\"total_waiting_time\":%" PRIu64 ","
+                "\"total_turnaround_time\":%" PRIu64 ",\"overhead_time\":%lu,\"process_count\":%lu}\n",
+                run->algorithm, run->quantum, status, pcb_count, load_seconds, schedule_seconds,
+                res->mean_waiting_time, res->mean_turnaround_time, res->total_run_time, res->context_switches,
+                res->total_waiting_time, res->total_turnaround_time, res->overhead_time, (unsigned long)res->process_count);
+    }
+    pthread_mutex_unlock(&batch->out_lock);
+}
+
+static void batch_write_header(FILE *out, batch_format_t format)
+{
+    if(format == BATCH_CSV) {
+        fputs("file,algorithm,quantum,status,pcbs,load_seconds,schedule_seconds,avg_wait,avg_turnaround,"
+              "total_run_time,context_switches,total_waiting_time,total_turnaround_time,overhead_time,process_count\n", out);
+    }
+}
+
+// Claims the next file for a worker's prefetcher, NULL once they're all claimed
+static const char *batch_next_file(void *context)
+{
+    batch_t *batch = (batch_t *)context;
+    size_t file = atomic_fetch_add(&batch->next_file, 1);
+    return file < batch->file_count ? batch->files[file] : NULL;
+}
+
+static void batch_worker(void *context, size_t worker)
+{
+    (void)worker;
+    batch_t *batch = (batch_t *)context;
+    const ScheduleResult_t empty = {0};
+    sched_workspace_t *ws = sched_workspace_create();  // scratch reused across this worker's files
+    pcb_prefetch_t *prefetch = ws ? pcb_prefetch_start(batch_next_file, batch, 1) : NULL;
+    if(!prefetch) {
+        atomic_store(&batch->failed, true);
+        sched_workspace_destroy(ws);
+        return;
+    }
+
+    const char *path;
+    double load_seconds;
+    for(dyn_array_t *pcbs = pcb_prefetch_next(prefetch, &path, &load_seconds); path;
+        pcbs = pcb_prefetch_next(prefetch, &path, &load_seconds)) {
+        pcb_view_t *view = pcbs ? pcb_view_create(pcbs) : NULL;
+        if(!view) {
+            for(size_t run = 0; run < batch->run_count; run++) {
+                batch_write_row(batch, path, &batch->runs[run], "load_error", 0, load_seconds, 0, &empty);
+            }
+            atomic_store(&batch->failed, true);
+            pcb_prefetch_recycle(prefetch, pcbs);
+            continue;
+        }
+
+        // every run shares the view, so the sorted orders are built once per file
+        for(size_t run = 0; run < batch->run_count; run++) {
+            ScheduleResult_t res = {0};
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            bool ok = batch_schedule(view, &batch->runs[run], &res, ws);
+            double schedule_seconds = batch_seconds_since(&start);
+            batch_write_row(batch, path, &batch->runs[run], ok ? "ok" : "schedule_error",
+                            pcb_view_size(view), load_seconds, schedule_seconds, ok ? &res : &empty);
+            if(!ok) {
+                atomic_store(&batch->failed, true);
+            }
+        }
+        pcb_view_destroy(view);
+        pcb_prefetch_recycle(prefetch, pcbs);  // the prefetcher loads a later file into it
+    }
+    pcb_prefetch_destroy(prefetch);
+    sched_workspace_destroy(ws);
+}
+
+// Appends a copy of path to the file list
+static bool batch_add_file(char ***files, size_t *count, size_t *capacity, const char *path)
+{
+    if(*count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 64;
+        char **larger = (char **)realloc(*files, grown * sizeof(char *));
+        if(!larger) return false;
+        *files = larger;
+        *capacity = grown;
+    }
+    char *copy = (char *)malloc(strlen(path) + 1);
+    if(!copy) return false;
+    strcpy(copy, path);
+    (*files)[(*count)++] = copy;
+    return true;
+}
+
+static int batch_name_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Adds a PCB file, or every regular file of a directory (sorted, hidden files skipped)
+static bool batch_add_path(char ***files, size_t *count, size_t *capacity, const char *path)
+{
+    struct stat info;
+    if(stat(path, &info) != 0 || !S_ISDIR(info.st_mode)) {
+        return batch_add_file(files, count, capacity, path);  // missing files become load_error rows
+    }
+    DIR *dir = opendir(path);
+    if(!dir) return false;
+    size_t first = *count;
+    bool ok = true;
+    char *joined = NULL;
+    for(struct dirent *entry = readdir(dir); ok && entry; entry = readdir(dir)) {
+        if(entry->d_name[0] == '.') continue;
+        char *longer = (char *)realloc(joined, strlen(path) + strlen(entry->d_name) + 2);
+        if(!longer) {
+            ok = false;
+            break;
+        }
+        joined = longer;
+        sprintf(joined, "%s/%s", path, entry->d_name);
+        if(stat(joined, &info) == 0 && S_ISREG(info.st_mode)) {
+            ok = batch_add_file(files, count, capacity, joined);
+        }
+    }
+    free(joined);
+    closedir(dir);
+    qsort(*files + first, *count - first, sizeof(char *), batch_name_cmp);
+    return ok;
+}
+
+// Adds every path listed in a file, one per line ("-" reads stdin), blank lines and # comments skipped
+static bool batch_add_list(char ***files, size_t *count, size_t *capacity, const char *list)
+{
+    FILE *in = strcmp(list, "-") == 0 ? stdin : fopen(list, "r");
+    if(!in) return false;
+    bool ok = true;
+    char line[4096];
+    while(ok && fgets(line, sizeof(line), in)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if(line[0] && line[0] != '#') {
+            ok = batch_add_path(files, count, capacity, line);
+        }
+    }
+    if(in != stdin) {
+        fclose(in);
+    }
+    return ok;
+}
+
+// Splits a comma separated list of algorithms and quanta into runs
+static bool batch_plan_runs(const char *algorithms, const char *quanta, batch_run_t **runs, size_t *count)
+{
+    static const char *const known[] = { FCFS, SJF, P, RR, SRT };
+    size_t quantum_count = 0;
+    size_t quantum_values[64];
+    for(const char *q = quanta; q && *q; q += strcspn(q, ",") + (q[strcspn(q, ",")] != '\0')) {
+        char text[32];
+        size_t length = strcspn(q, ",");
+        uint32_t value = 0;
+        if(length >= sizeof(text) || quantum_count == 64) return false;
+        memcpy(text, q, length);
+        text[length] = '\0';
+        if(!parse_cost(text, &value) || value == 0) return false;
+        quantum_values[quantum_count++] = value;
+    }
+
+    *runs = (batch_run_t *)malloc((4 + quantum_count) * sizeof(batch_run_t));
+    if(!*runs) return false;
+    *count = 0;
+    for(const char *a = algorithms; *a; a += strcspn(a, ",") + (a[strcspn(a, ",")] != '\0')) {
+        size_t length = strcspn(a, ",");
+        const char *name = NULL;
+        for(size_t k = 0; k < sizeof(known) / sizeof(known[0]); k++) {
+            if(strlen(known[k]) == length && strncmp(known[k], a, length) == 0) name = known[k];
+        }
+        bool repeated = false;
+        for(size_t r = 0; r < *count; r++) {
+            repeated |= name && strcmp((*runs)[r].algorithm, name) == 0;
+        }
+        bool round_robin = name && strcmp(name, RR) == 0;
+        if(!name || (round_robin && !quantum_count)) return false;
+        if(repeated) continue;
+        if(round_robin) {
+            for(size_t q = 0; q < quantum_count; q++) {
+                (*runs)[(*count)++] = (batch_run_t){ RR, quantum_values[q] };
+            }
+        }
+        else {
+            (*runs)[(*count)++] = (batch_run_t){ name, 0 };
+        }
+    }
+    return *count > 0;
+}
+
+static int batch_main(int argc, char **argv)
+{
+    const char *algorithms = NULL;
+    const char *quanta = NULL;
+    const char *output = NULL;
+    batch_format_t format = BATCH_CSV;
+    uint32_t jobs = 0;
+    ScheduleOverhead_t overhead = {0, 0};
+    char **files = NULL;
+    size_t file_count = 0, file_capacity = 0;
+    bool ok = true;
+
+    for(int i = 0; ok && i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if(strncmp(argv[i], "--", 2) != 0) {
+            ok = batch_add_path(&files, &file_count, &file_capacity, argv[i]);
+            if(!ok) {
+                printf("Can't read %s.\n", argv[i]);
+            }
+            continue;
+        }
+        if(!value) {
+            printf("Missing value for %s.\n", argv[i]);
+            ok = false;
+        }
+        else if(strcmp(argv[i], "--list") == 0) ok = batch_add_list(&files, &file_count, &file_capacity, value);
+        else if(strcmp(argv[i], "--alg") == 0) algorithms = value;
+        else if(strcmp(argv[i], "--quantum") == 0) quanta = value;
+        else if(strcmp(argv[i], "--output") == 0) output = value;
+        else if(strcmp(argv[i], "--jobs") == 0) ok = parse_cost(value, &jobs);
+        else if(strcmp(argv[i], "--switch-cost") == 0) ok = parse_cost(value, &overhead.context_switch_cost);
+        else if(strcmp(argv[i], "--dispatch-cost") == 0) ok = parse_cost(value, &overhead.dispatch_cost);
+        else if(strcmp(argv[i], "--format") == 0) {
+            ok = strcmp(value, "csv") == 0 || strcmp(value, "jsonl") == 0;
+            format = strcmp(value, "jsonl") == 0 ? BATCH_JSONL : BATCH_CSV;
+        }
+        else {
+            printf("Unexpected argument %s.\n", argv[i]);
+            ok = false;
+        }
+        if(!ok && value) {
+            printf("Bad value for %s.\n", argv[i]);
+        }
+        i++;
+    }
+
+    // everything but RR by default, RR joins in when quanta are given
+    if(!algorithms) {
+        algorithms = quanta ? "FCFS,SJF,P,RR,SRT" : "FCFS,SJF,P,SRT";
+    }
+    batch_run_t *runs = NULL;
+    size_t run_count = 0;
+    if(ok && !batch_plan_runs(algorithms, quanta, &runs, &run_count)) {
+        printf("Bad algorithm or quantum list (RR needs --quantum).\n");
+        ok = false;
+    }
+    if(ok && file_count == 0) {
+        printf("No PCB files given.\n");
+        ok = false;
+    }
+    FILE *out = ok && output ? fopen(output, "w") : stdout;
+    if(!out) {
+        printf("Can't open %s.\n", output);
+        ok = false;
+    }
+
+    bool failed = !ok;
+    if(ok) {
+        // the files are the parallelism, each scheduler run stays on its worker's thread
+        set_schedule_overhead(&overhead);
+        set_schedule_threads(1);
+        batch_t batch = { files, file_count, runs, run_count, format, out, PTHREAD_MUTEX_INITIALIZER, 0, false };
+        batch_write_header(out, format);
+        size_t workers = sched_resolve_threads(jobs);
+        sched_run_workers(workers < file_count ? workers : file_count, batch_worker, &batch);
+        pthread_mutex_destroy(&batch.out_lock);
+        failed = atomic_load(&batch.failed);
+    }
+
+    if(out && out != stdout) {
+        fclose(out);
+    }
+    for(size_t file = 0; file < file_count; file++) {
+        free(files[file]);
+    }
+    free(files);
+    free(runs);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*
+	Fork mode.
+
+	analysis --fork <pcb file> [--workers N] [--alg ...] [--quantum ...] [--format csv|jsonl] [--output FILE]
+	One huge trace, many runs of it (every algorithm, RR once per quantum), spread over worker
+	processes. The coordinator loads the trace once and sorts every order its view can need, then
+	forks: workers inherit all of it and only ever read it, so the pages stay shared and there is
+	one copy of the trace however many workers run. (The file's 12 byte records aren't PCBs, so
+	workers can't schedule straight off a mapping of the file, the loaded dyn_array is what they share.)
+
+	The work queue and the result table live in one shared anonymous mapping: workers claim the
+	next run from an atomic counter and write its result into the run's row of the table. Once
+	every worker has exited the coordinator writes the rows out, in the order of the runs, in the
+	same format as batch mode. A run a worker never finished (it crashed) is a "worker_error" row.
+*/
+
+typedef enum { FORK_PENDING = 0, FORK_OK, FORK_FAILED } fork_status_t;
+
+// One row of the shared result table, a cache line or more so workers don't write to each other's lines
+typedef struct
+{
+    _Alignas(64) ScheduleResult_t result;
+    double schedule_seconds;
+    fork_status_t status;
+} fork_result_t;
+
+// Start of the shared mapping, the result table follows it
+typedef struct
+{
+    _Alignas(64) atomic_size_t next_run;    // first run nobody has claimed
+    fork_result_t results[];
+} fork_table_t;
+
+// Claims runs until there are none left. Runs in the workers, which only read the view.
+static void fork_worker(pcb_view_t *view, const batch_run_t *runs, size_t run_count, fork_table_t *table)
+{
+    sched_workspace_t *ws = sched_workspace_create();
+    for(size_t run = atomic_fetch_add(&table->next_run, 1); ws && run < run_count;
+        run = atomic_fetch_add(&table->next_run, 1)) {
+        fork_result_t *row = &table->results[run];
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        bool ok = batch_schedule(view, &runs[run], &row->result, ws);
+        row->schedule_seconds = batch_seconds_since(&start);
+        row->status = ok ? FORK_OK : FORK_FAILED;
+    }
+    sched_workspace_destroy(ws);
+}
+
+static int fork_main(int argc, char **argv)
+{
+    const char *path = NULL;
+    const char *algorithms = NULL;
+    const char *quanta = NULL;
+    const char *output = NULL;
+    batch_format_t format = BATCH_CSV;
+    uint32_t workers = 0;
+    ScheduleOverhead_t overhead = {0, 0};
+    bool ok = true;
+
+    for(int i = 0; ok && i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if(strncmp(argv[i], "--", 2) != 0) {
+            ok = !path;
+            path = argv[i];
+            if(!ok) {
+                printf("Fork mode takes one PCB file.\n");
+            }
+            continue;
+        }
+        if(!value) {
+            printf("Missing value for %s.\n", argv[i]);
+            ok = false;
+        }
+        else if(strcmp(argv[i], "--alg") == 0) algorithms = value;
+        else if(strcmp(argv[i], "--quantum") == 0) quanta = value;
+        else if(strcmp(argv[i], "--output") == 0) output = value;
+        else if(strcmp(argv[i], "--workers") == 0) ok = parse_cost(value, &workers);
+        else if(strcmp(argv[i], "--switch-cost") == 0) ok = parse_cost(value, &overhead.context_switch_cost);
+        else if(strcmp(argv[i], "--dispatch-cost") == 0) ok = parse_cost(value, &overhead.dispatch_cost);
+        else if(strcmp(argv[i], "--format") == 0) {
+            ok = strcmp(value, "csv") == 0 || strcmp(value, "jsonl") == 0;
+            format = strcmp(value, "jsonl") == 0 ? BATCH_JSONL : BATCH_CSV;
+        }
+        else {
+            printf("Unexpected argument %s.\n", argv[i]);
+            ok = false;
+        }
+        if(!ok && value) {
+            printf("Bad value for %s.\n", argv[i]);
+        }
+        i++;
+    }
+
+    if(!algorithms) {
+        algorithms = quanta ? "FCFS,SJF,P,RR,SRT" : "FCFS,SJF,P,SRT";
+    }
+    batch_run_t *runs = NULL;
+    size_t run_count = 0;
+    if(ok && !batch_plan_runs(algorithms, quanta, &runs, &run_count)) {
+        printf("Bad algorithm or quantum list (RR needs --quantum).\n");
+        ok = false;
+    }
+    if(ok && !path) {
+        printf("No PCB file given.\n");
+        ok = false;
+    }
+
+    // load and sort everything before forking, the workers then share it untouched
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    dyn_array_t *pcbs = ok ? load_process_control_blocks(path) : NULL;
+    pcb_view_t *view = pcbs ? pcb_view_create(pcbs) : NULL;
+    for(int order = 0; view && order < PCB_ORDER_COUNT; order++) {
+        ok = ok && pcb_view_prepare(view, (PCB_ORDER)order);
+    }
+    double load_seconds = batch_seconds_since(&start);
+    if(ok && !view) {
+        printf("Error loading PCBs.\n");
+        ok = false;
+    }
+
+    size_t table_bytes = sizeof(fork_table_t) + run_count * sizeof(fork_result_t);
+    fork_table_t *table = NULL;
+    if(ok) {
+        void *shared = mmap(NULL, table_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        table = shared == MAP_FAILED ? NULL : (fork_table_t *)shared;   // zero filled: every run pending
+        ok = table != NULL;
+    }
+    FILE *out = ok && output ? fopen(output, "w") : stdout;
+    if(!out) {
+        printf("Can't open %s.\n", output);
+        ok = false;
+    }
+
+    bool failed = !ok;
+    if(ok) {
+        set_schedule_overhead(&overhead);
+        set_schedule_threads(1);
+        size_t wanted = sched_resolve_threads(workers);
+        if(wanted > run_count) wanted = run_count;
+        fflush(NULL);  // nothing buffered may be written twice
+        size_t forked = 0;
+        for(; forked < wanted; forked++) {
+            pid_t pid = fork();
+            if(pid == 0) {
+                fork_worker(view, runs, run_count, table);
+                _exit(EXIT_SUCCESS);
+            }
+            if(pid < 0) break;
+        }
+        if(!forked) {
+            fork_worker(view, runs, run_count, table);  // no processes to be had, do it here
+        }
+        while(wait(NULL) > 0 || errno == EINTR) {
+        }
+
+        batch_t batch = { NULL, 0, runs, run_count, format, out, PTHREAD_MUTEX_INITIALIZER, 0, false };
+        batch_write_header(out, format);
+        const ScheduleResult_t empty = {0};
+        for(size_t run = 0; run < run_count; run++) {
+            const fork_result_t *row = &table->results[run];
+            static const char *const status[] = { "worker_error", "ok", "schedule_error" };
+            batch_write_row(&batch, path, &runs[run], status[row->status], pcb_view_size(view), load_seconds,
+                            row->schedule_seconds, row->status == FORK_OK ? &row->result : &empty);
+            failed |= row->status != FORK_OK;
+        }
+        pthread_mutex_destroy(&batch.out_lock);
+    }
+
+    if(table) {
+        munmap(table, table_bytes);
+    }
+    if(out && out != stdout) {
+        fclose(out);
+    }
+    pcb_view_destroy(view);
+    dyn_array_destroy(pcbs);
+    free(runs);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Single run over an I/O trace (load_io_trace format): the usual results plus CPU and device usage
+static int io_main(const char *file, const char *alg, const char *quantum_arg)
+{
+    IO_POLICY policy;
+    int q = 0;
+    if(strncmp(alg, FCFS, 4) == 0) policy = IO_POLICY_FCFS;
+    else if(strncmp(alg, SJF, 3) == 0) policy = IO_POLICY_SJF;
+    else if(strncmp(alg, P, 1) == 0) policy = IO_POLICY_PRIORITY;
+    else if(strncmp(alg, RR, 2) == 0) policy = IO_POLICY_RR;
+    else if(strncmp(alg, SRT, 3) == 0) policy = IO_POLICY_SRT;
+    else {
+        printf("Unknown alg.\n");
+        return EXIT_FAILURE;
+    }
+    if(policy == IO_POLICY_RR && (!quantum_arg || sscanf(quantum_arg, "%d", &q) != 1 || q <= 0)) {
+        printf("Must supply a positive quantum for RR.\n");
+        return EXIT_FAILURE;
+    }
+
+    IoTrace_t *trace = load_io_trace(file);
+    if(!trace) {
+        printf("Error loading I/O trace.\n");
+        return EXIT_FAILURE;
+    }
+    IoScheduleResult_t res;
+    bool success = schedule_io(trace, policy, (size_t)q, &res);
+    io_trace_destroy(trace);
+    if(!success) {
+        printf("%s failed.\n", alg);
+        return EXIT_FAILURE;
+    }
+
+    printf("Avg Wait: %.2f\n", res.schedule.average_waiting_time);
+    printf("Avg Turnaround: %.2f\n", res.schedule.average_turnaround_time);
+    printf("Total Time: %lu\n", res.schedule.total_run_time);
+    printf("Context Switches: %lu\n", res.schedule.context_switches);
+    printf("Overhead Time: %lu\n", res.schedule.overhead_time);
+    printf("CPU Utilization: %.2f%%\n", 100.0 * res.cpu_utilization);
+    printf("I/O Busy Time: %" PRIu64 "\n", res.io_busy_time);
+    printf("I/O Overlap: %.2f%%\n", 100.0 * res.io_overlap);
+    printf("Device Wait: %" PRIu64 "\n", res.device_wait_time);
+    return EXIT_SUCCESS;
+}
+
 // Add and comment your analysis code in this function.
 // THIS IS NOT FINISHED.
 int main(int argc, char **argv) 
 {
+    if(argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+        return batch_main(argc - 2, argv + 2);
+    }
+    if(argc >= 2 && strcmp(argv[1], "--fork") == 0) {
+        return fork_main(argc - 2, argv + 2);
+    }
     if(argc < 3) {
-        printf("Usage: %s <pcb file> <schedule algorithm>\n", argv[0]);
+        printf("Usage: %s <pcb file> <schedule algorithm> [quantum] [--switch-cost N] [--dispatch-cost N] [--threads N] [--stats]\n"
+               "              [--io] (the file is an I/O trace, see io_scheduling.h)\n"
+               "              [--checkpoint FILE [--checkpoint-every N] [--resume]] (RR and SRT, see sched_checkpoint.h)\n", argv[0]);
+        printf("       %s --batch <pcb file | directory>... [--list FILE] [--alg FCFS,SJF,P,RR,SRT] [--quantum Q,...]\n"
+               "              [--format csv|jsonl] [--jobs N] [--output FILE] [--switch-cost N] [--dispatch-cost N]\n", argv[0]);
+        printf("       %s --fork <pcb file> [--workers N] [--alg FCFS,SJF,P,RR,SRT] [--quantum Q,...]\n"
+               "              [--format csv|jsonl] [--output FILE] [--switch-cost N] [--dispatch-cost N]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Pull the overhead/thread options out, whatever is left over is positional (the RR quantum)
+    ScheduleOverhead_t overhead = {0, 0};
+    uint32_t threads = 0;           // the library default, one per online CPU
+    const char *quantum_arg = NULL;
+    bool show_stats = false;
+    bool io_trace = false;
+    sched_checkpoint_t checkpoint = {NULL, 0, false, false, 0};
+    uint32_t checkpoint_every = CHECKPOINT_DEFAULT_EVERY;
+    for(int i = 3; i < argc; i++) {
+        uint32_t *cost = NULL;
+        if(strcmp(argv[i], "--stats") == 0) {
+            show_stats = true;
+            continue;
+        }
+        if(strcmp(argv[i], "--resume") == 0) {
+            checkpoint.resume = true;
+            continue;
+        }
+        if(strcmp(argv[i], "--checkpoint") == 0) {
+            if(i + 1 >= argc) {
+                printf("Bad value for %s.\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            checkpoint.path = argv[++i];
+            continue;
+        }
+        if(strcmp(argv[i], "--io") == 0) {
+            io_trace = true;
+            continue;
+        }
+        if(strcmp(argv[i], "--switch-cost") == 0) {
+            cost = &overhead.context_switch_cost;
+        }
+        else if(strcmp(argv[i], "--dispatch-cost") == 0) {
+            cost = &overhead.dispatch_cost;
+        }
+        else if(strcmp(argv[i], "--threads") == 0) {
+            cost = &threads;
+        }
+        else if(strcmp(argv[i], "--checkpoint-every") == 0) {
+            cost = &checkpoint_every;
+        }
+        else if(!quantum_arg) {
+            quantum_arg = argv[i];
+            continue;
+        }
+        else {
+            printf("Unexpected argument %s.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        if(i + 1 >= argc || !parse_cost(argv[i + 1], cost)) {
+            printf("Bad value for %s.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        i++;
+    }
+    set_schedule_overhead(&overhead);
+    set_schedule_threads(threads);
+    checkpoint.every = checkpoint_every;
+    if(checkpoint.resume && !checkpoint.path) {
+        printf("--resume needs --checkpoint FILE.\n");
         return EXIT_FAILURE;
     }
+    if(checkpoint.path && (io_trace || (strncmp(argv[2], "RR", 2) != 0 && strncmp(argv[2], "SRT", 3) != 0))) {
+        printf("Checkpoints only cover RR and SRT.\n");
+        return EXIT_FAILURE;
+    }
+    if(io_trace) {
+        return io_main(argv[1], argv[2], quantum_arg);
+    }
 
     dyn_array_t *pcbs = load_process_control_blocks(argv[1]);
     if(!pcbs) {
@@ -31,6 +745,7 @@ int main(int argc, char **argv)
     res.average_turnaround_time = 0;
     res.average_waiting_time = 0;
     res.total_run_time = 0;
+    reset_schedule_stats();  // count the scheduling run only, not the load
     if(strncmp(argv[2], "FCFS", 4) == 0) {
         if(!first_come_first_serve(pcbs, &res)) {
             printf("FCFS scheduling failed.\n");
@@ -53,25 +768,29 @@ int main(int argc, char **argv)
         }
     }
     else if(strncmp(argv[2], "RR", 2) == 0) {
-        if(argc < 4) {
+        if(!quantum_arg) {
             printf("Must supply quantum for RR.\n");
             dyn_array_destroy(pcbs);
             return EXIT_FAILURE;
         }
         int q = 0;
-        if(sscanf(argv[3], "%d", &q) != 1 || q <= 0) {
+        if(sscanf(quantum_arg, "%d", &q) != 1 || q <= 0) {
             printf("Bad quantum.\n");
             dyn_array_destroy(pcbs);
             return EXIT_FAILURE;
         }
-        if(!round_robin(pcbs, &res, (size_t)q)) {
+        bool ok = checkpoint.path ? round_robin_checkpointed(pcbs, &res, (size_t)q, &checkpoint)
+                                  : round_robin(pcbs, &res, (size_t)q);
+        if(!ok) {
             printf("RR failed.\n");
             dyn_array_destroy(pcbs);
             return EXIT_FAILURE;
         }
     }
     else if(strncmp(argv[2], "SRT", 3) == 0) {
-        if(!shortest_remaining_time_first(pcbs, &res)) {
+        bool ok = checkpoint.path ? shortest_remaining_time_first_checkpointed(pcbs, &res, &checkpoint)
+                                  : shortest_remaining_time_first(pcbs, &res);
+        if(!ok) {
             printf("SRT failed.\n");
             dyn_array_destroy(pcbs);
             return EXIT_FAILURE;
@@ -87,6 +806,31 @@ int main(int argc, char **argv)
     printf("Avg Wait: %.2f\n", res.average_waiting_time);
     printf("Avg Turnaround: %.2f\n", res.average_turnaround_time);
     printf("Total Time: %lu\n", res.total_run_time);
+    printf("Context Switches: %lu\n", res.context_switches);
+    printf("Overhead Time: %lu\n", res.overhead_time);
+    if(checkpoint.path) {
+        printf("Resumed: %s\n", checkpoint.resumed ? "yes" : "no");
+        printf("Checkpoints Written: %" PRIu64 "\n", checkpoint.written);
+    }
+
+    if(show_stats) {
+        ScheduleStats_t stats = get_schedule_stats();
+        if(!schedule_stats_enabled()) {
+            printf("Stats: not collected (build with -DSCHED_STATS=ON)\n");
+        }
+        else {
+            printf("Dispatches: %" PRIu64 "\n", stats.dispatches);
+            printf("PCBs Scanned: %" PRIu64 " (%.2f per dispatch)\n", stats.pcbs_scanned,
+                   stats.dispatches ? (double)stats.pcbs_scanned / (double)stats.dispatches : 0.0);
+            printf("Comparisons: %" PRIu64 "\n", stats.comparisons);
+            printf("Stat Context Switches: %" PRIu64 "\n", stats.context_switches);
+            printf("Clock Jumps: %" PRIu64 "\n", stats.clock_jumps);
+            printf("Unit Ticks: %" PRIu64 "\n", stats.unit_ticks);
+            printf("Reallocs: %" PRIu64 "\n", stats.reallocs);
+            printf("Bytes Moved: %" PRIu64 "\n", stats.bytes_moved);
+            printf("Mallocs: %" PRIu64 "\n", stats.mallocs);
+        }
+    }
 
     dyn_array_destroy(pcbs);
     return EXIT_SUCCESS;
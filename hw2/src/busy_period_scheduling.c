@@ -0,0 +1,228 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "pcb_view.h"
+#include "scheduling_internal.h"
+
+/*
+	Busy periods.
+
+	A non-preemptive, work-conserving schedule only idles when nothing has arrived, and
+	every PCB runs exactly once, so it pays a context switch on every dispatch but the
+	very first one. The length of a stretch of back-to-back work therefore does not
+	depend on the policy: walking the PCBs in arrival order with
+	c = max(c, arrival) + cost + burst, a new busy period starts at every PCB that
+	arrives strictly after c. (An arrival at exactly c could still be picked ahead of a
+	zero-length PCB of the previous period, so that one stays in the period.)
+
+	Nothing in one busy period can affect the next, so each one is simulated on its own
+	and the totals are summed. Workers claim periods in chunks from a shared counter,
+	since sparse traces tend to have many small periods and a few big ones.
+*/
+
+// Periods claimed per trip to the shared counter
+#ifndef BUSY_PERIOD_CHUNK
+#define BUSY_PERIOD_CHUNK 64
+#endif
+
+// Ready PCB in a binary min-heap, ordered by key (policy key << 32 | tie breaker)
+typedef struct
+{
+    uint64_t key;
+    uint32_t index;
+} busy_entry_t;
+
+typedef struct
+{
+    busy_entry_t *entries;
+    size_t size;
+    size_t capacity;
+} busy_heap_t;
+
+typedef struct
+{
+    const ProcessControlBlock_t *pcbs;
+    const uint32_t *by_arrival;
+    const uint32_t *period_begin;   // arrival position where each period starts, plus n at the end
+    size_t periods;
+    BUSY_PERIOD_POLICY policy;
+    atomic_size_t next_period;      // first period not claimed yet
+    atomic_bool failed;
+    schedule_totals_t *totals;      // one per worker
+} busy_run_t;
+
+static void busy_heap_push(busy_heap_t *heap, busy_entry_t entry)
+{
+    size_t child = heap->size++;
+    while(child > 0) {
+        size_t parent = (child - 1) / 2;
+        SCHED_STAT_ADD(comparisons, 1);
+        if(heap->entries[parent].key <= entry.key) break;
+        heap->entries[child] = heap->entries[parent];
+        child = parent;
+    }
+    heap->entries[child] = entry;
+}
+
+static busy_entry_t busy_heap_pop(busy_heap_t *heap)
+{
+    busy_entry_t top = heap->entries[0];
+    busy_entry_t last = heap->entries[--heap->size];
+    size_t parent = 0;
+    for(;;) {
+        size_t child = 2 * parent + 1;
+        if(child >= heap->size) break;
+        SCHED_STAT_ADD(comparisons, child + 1 < heap->size ? 2 : 1);
+        if(child + 1 < heap->size && heap->entries[child + 1].key < heap->entries[child].key) {
+            child++;
+        }
+        if(last.key <= heap->entries[child].key) break;
+        heap->entries[parent] = heap->entries[child];
+        parent = child;
+    }
+    if(heap->size) {
+        heap->entries[parent] = last;
+    }
+    return top;
+}
+
+// Heap key matching the tie breaking of the sequential schedulers
+static uint64_t busy_key(BUSY_PERIOD_POLICY policy, const ProcessControlBlock_t *pcb, size_t index, size_t position)
+{
+    switch(policy) {
+        case BUSY_PERIOD_SJF:
+            return (uint64_t)pcb->remaining_burst_time << 32 | position;  // ties to the earliest arrival
+        case BUSY_PERIOD_PRIORITY:
+            return (uint64_t)pcb->priority << 32 | index;                 // ties to the lowest index
+        default:
+            return position;
+    }
+}
+
+// Simulates the PCBs at arrival positions [begin, end), which start a busy period
+static bool busy_simulate(busy_run_t *run, busy_heap_t *heap, schedule_totals_t *totals, size_t begin, size_t end)
+{
+    const ProcessControlBlock_t *pcbs = run->pcbs;
+    const uint32_t *by_arrival = run->by_arrival;
+
+    // everyone but the very first PCB of the trace hands the CPU over from someone else
+    totals->last_ran = begin ? SIZE_MAX - 1 : SIZE_MAX;  // SIZE_MAX - 1 is never a PCB index
+    sched_time_t time = pcbs[by_arrival[begin]].arrival;
+
+    if(run->policy == BUSY_PERIOD_FCFS) {
+        for(size_t i = begin; i < end; i++) {
+            const ProcessControlBlock_t *pcb = &pcbs[by_arrival[i]];
+            SCHED_STAT_ADD(pcbs_scanned, 1);
+            time += charge_dispatch(totals, by_arrival[i]);
+            SCHED_STAT_CLOCK(pcb->remaining_burst_time);
+            time += pcb->remaining_burst_time;
+            totals_record(totals, pcb->arrival, pcb->remaining_burst_time, time);
+        }
+        return true;
+    }
+
+    if(heap->capacity < end - begin) {
+        busy_entry_t *entries = (busy_entry_t *)SCHED_REALLOC(heap->entries, (end - begin) * sizeof(busy_entry_t));
+        if(!entries) return false;
+        heap->entries = entries;
+        heap->capacity = end - begin;
+    }
+    heap->size = 0;
+
+    size_t next = begin;
+    for(size_t done = begin; done < end; done++) {
+        // the period never idles, so something has always arrived by now
+        for(; next < end && pcbs[by_arrival[next]].arrival <= time; next++) {
+            size_t index = by_arrival[next];
+            SCHED_STAT_ADD(pcbs_scanned, 1);
+            busy_entry_t entry = { busy_key(run->policy, &pcbs[index], index, next), (uint32_t)index };
+            busy_heap_push(heap, entry);
+        }
+        busy_entry_t chosen = busy_heap_pop(heap);
+        const ProcessControlBlock_t *pcb = &pcbs[chosen.index];
+        time += charge_dispatch(totals, chosen.index);
+        SCHED_STAT_CLOCK(pcb->remaining_burst_time);
+        time += pcb->remaining_burst_time;
+        totals_record(totals, pcb->arrival, pcb->remaining_burst_time, time);
+    }
+    return true;
+}
+
+static void busy_worker(void *context, size_t worker)
+{
+    busy_run_t *run = (busy_run_t *)context;
+    schedule_totals_t *totals = &run->totals[worker];
+    busy_heap_t heap = { NULL, 0, 0 };
+
+    for(;;) {
+        size_t first = atomic_fetch_add(&run->next_period, BUSY_PERIOD_CHUNK);
+        if(first >= run->periods || atomic_load(&run->failed)) break;
+        size_t last = first + BUSY_PERIOD_CHUNK < run->periods ? first + BUSY_PERIOD_CHUNK : run->periods;
+        for(size_t period = first; period < last; period++) {
+            if(!busy_simulate(run, &heap, totals, run->period_begin[period], run->period_begin[period + 1])) {
+                atomic_store(&run->failed, true);
+                break;
+            }
+        }
+    }
+    free(heap.entries);
+}
+
+bool busy_period_view(pcb_view_t *view, BUSY_PERIOD_POLICY policy, ScheduleResult_t *result, size_t nthreads)
+{
+    if(!view || !result || (unsigned)policy > BUSY_PERIOD_PRIORITY) return false;
+    size_t n = pcb_view_size(view);
+    if(n == 0) return false;
+
+    const uint32_t *by_arrival = pcb_view_order(view, PCB_ORDER_ARRIVAL);
+    if(!by_arrival) return false;
+    const ProcessControlBlock_t *pcbs = pcb_view_pcbs(view);
+    const ScheduleOverhead_t costs = get_schedule_overhead();
+
+    // find the periods, and when the last one ends
+    uint32_t *period_begin = (uint32_t *)SCHED_MALLOC((n + 1) * sizeof(uint32_t));
+    if(!period_begin) return false;
+    size_t periods = 0;
+    sched_time_t end_time = 0;
+    for(size_t i = 0; i < n; i++) {
+        const ProcessControlBlock_t *pcb = &pcbs[by_arrival[i]];
+        if(i == 0 || pcb->arrival > end_time) {
+            period_begin[periods++] = (uint32_t)i;
+            end_time = pcb->arrival;
+        }
+        end_time += (sched_time_t)costs.dispatch_cost + (i ? costs.context_switch_cost : 0) + pcb->remaining_burst_time;
+    }
+    period_begin[periods] = (uint32_t)n;
+
+    size_t workers = sched_resolve_threads(nthreads);
+    size_t chunks = (periods + BUSY_PERIOD_CHUNK - 1) / BUSY_PERIOD_CHUNK;
+    if(workers > chunks) {
+        workers = chunks;
+    }
+    schedule_totals_t *totals = (schedule_totals_t *)SCHED_MALLOC(workers * sizeof(schedule_totals_t));
+    if(!totals) {
+        free(period_begin);
+        return false;
+    }
+    for(size_t worker = 0; worker < workers; worker++) {
+        totals_init(&totals[worker]);
+        totals[worker].costs = costs;
+    }
+
+    busy_run_t run = { pcbs, by_arrival, period_begin, periods, policy, 0, false, totals };
+    sched_run_workers(workers, busy_worker, &run);
+
+    bool ok = !atomic_load(&run.failed);
+    if(ok) {
+        schedule_totals_t merged;
+        totals_init(&merged);
+        for(size_t worker = 0; worker < workers; worker++) {
+            totals_merge(&merged, &totals[worker]);
+        }
+        totals_finish(&merged, end_time, result);
+    }
+
+    free(period_begin);
+    free(totals);
+    return ok;
+}
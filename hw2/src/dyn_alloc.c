@@ -0,0 +1,248 @@
+// mremap() and the MAP_/MADV_ huge page flags
+#define _GNU_SOURCE
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "dyn_array.h"
+
+// Blocks this big and up get their own mapping under DYN_ALLOC_HUGE
+#ifndef DYN_HUGE_THRESHOLD
+#define DYN_HUGE_THRESHOLD (((size_t) 2) << 20)
+#endif
+
+// Mappings are sized in whole huge pages so MAP_HUGETLB can accept them
+#ifndef DYN_HUGE_PAGE_SIZE
+#define DYN_HUGE_PAGE_SIZE (((size_t) 2) << 20)
+#endif
+
+#define DYN_CACHE_LINE 64
+
+struct dyn_arena
+{
+	uint8_t *base;
+	size_t capacity;  // bytes reserved
+	size_t mapped;	  // length of the mapping (capacity rounded up)
+	size_t used;	  // bump pointer
+	size_t newest;	  // offset of the newest block, the only one that can be grown or released in place
+	size_t align;
+};
+
+// Rounds bytes up to a multiple of align (a power of two), 0 if that overflows
+static size_t dyn_round_up(const size_t bytes, const size_t align)
+{
+	return bytes > SIZE_MAX - (align - 1) ? 0 : (bytes + (align - 1)) & ~(align - 1);
+}
+
+// Maps length bytes (a multiple of DYN_HUGE_PAGE_SIZE), huge pages if the system has them reserved,
+// otherwise ordinary pages with a hint to back them with transparent huge pages
+static void *dyn_map(const size_t length, const int extra_flags)
+{
+	const int flags = MAP_PRIVATE | MAP_ANONYMOUS | extra_flags;
+	void *mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+	if (mapping == MAP_FAILED)
+	{
+		mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+		if (mapping == MAP_FAILED)
+		{
+			return NULL;
+		}
+		// only a hint, nothing to do if THP is off
+		(void) madvise(mapping, length, MADV_HUGEPAGE);
+	}
+	return mapping;
+}
+
+//
+///
+// System allocator, ctx holds the flags
+///
+//
+
+static bool dyn_system_mapped(const unsigned flags, const size_t bytes)
+{
+	return (flags & DYN_ALLOC_HUGE) && bytes >= DYN_HUGE_THRESHOLD;
+}
+
+static void *dyn_system_allocate(void *ctx, size_t bytes)
+{
+	const unsigned flags = (unsigned) (uintptr_t) ctx;
+	if (dyn_system_mapped(flags, bytes))
+	{
+		const size_t length = dyn_round_up(bytes, DYN_HUGE_PAGE_SIZE);
+		return length ? dyn_map(length, 0) : NULL;
+	}
+	if (flags & DYN_ALLOC_ALIGNED)
+	{
+		// aligned_alloc wants a size that's a multiple of the alignment
+		const size_t length = dyn_round_up(bytes ? bytes : 1, DYN_CACHE_LINE);
+		return length ? aligned_alloc(DYN_CACHE_LINE, length) : NULL;
+	}
+	return malloc(bytes);
+}
+
+static void dyn_system_release(void *ctx, void *ptr, size_t bytes)
+{
+	const unsigned flags = (unsigned) (uintptr_t) ctx;
+	if (ptr && dyn_system_mapped(flags, bytes))
+	{
+		munmap(ptr, dyn_round_up(bytes, DYN_HUGE_PAGE_SIZE));
+	}
+	else
+	{
+		free(ptr);
+	}
+}
+
+static void *dyn_system_reallocate(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes)
+{
+	const unsigned flags = (unsigned) (uintptr_t) ctx;
+	if (!ptr)
+	{
+		return dyn_system_allocate(ctx, new_bytes);
+	}
+	const bool old_mapped = dyn_system_mapped(flags, old_bytes);
+	const bool new_mapped = dyn_system_mapped(flags, new_bytes);
+	if (old_mapped && new_mapped)
+	{
+		// the kernel can move the pages instead of copying them
+		const size_t length = dyn_round_up(new_bytes, DYN_HUGE_PAGE_SIZE);
+		void *moved = length ? mremap(ptr, dyn_round_up(old_bytes, DYN_HUGE_PAGE_SIZE), length, MREMAP_MAYMOVE)
+							 : MAP_FAILED;
+		if (moved != MAP_FAILED)
+		{
+			return moved;
+		}
+	}
+	else if (!old_mapped && !new_mapped && !(flags & DYN_ALLOC_ALIGNED))
+	{
+		return realloc(ptr, new_bytes);
+	}
+
+	// realloc doesn't keep alignment and can't cross between heap and mapping, so copy
+	void *moved = dyn_system_allocate(ctx, new_bytes);
+	if (moved)
+	{
+		memcpy(moved, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+		dyn_system_release(ctx, ptr, old_bytes);
+	}
+	return moved;
+}
+
+dyn_allocator_t dyn_allocator_system(const unsigned flags)
+{
+	return (dyn_allocator_t){dyn_system_allocate, dyn_system_reallocate, dyn_system_release,
+							 (void *) (uintptr_t) flags};
+}
+
+//
+///
+// Bump arena
+///
+//
+
+static void *dyn_arena_allocate(void *ctx, size_t bytes)
+{
+	dyn_arena_t *arena = (dyn_arena_t *) ctx;
+	if (!arena)
+	{
+		return NULL;
+	}
+	const size_t start = dyn_round_up(arena->used, arena->align);
+	if (start < arena->used || bytes > arena->capacity - start || start > arena->capacity)
+	{
+		return NULL;
+	}
+	arena->newest = start;
+	arena->used	  = start + bytes;
+	return arena->base + start;
+}
+
+static void *dyn_arena_reallocate(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes)
+{
+	dyn_arena_t *arena = (dyn_arena_t *) ctx;
+	if (!arena)
+	{
+		return NULL;
+	}
+	if (ptr && ptr == arena->base + arena->newest)
+	{
+		// newest block, just move the bump pointer
+		if (new_bytes > arena->capacity - arena->newest)
+		{
+			return NULL;
+		}
+		arena->used = arena->newest + new_bytes;
+		return ptr;
+	}
+	void *moved = dyn_arena_allocate(ctx, new_bytes);
+	if (moved && ptr)
+	{
+		memcpy(moved, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+	}
+	return moved;
+}
+
+static void dyn_arena_release(void *ctx, void *ptr, size_t bytes)
+{
+	(void) bytes;
+	dyn_arena_t *arena = (dyn_arena_t *) ctx;
+	if (arena && ptr && ptr == arena->base + arena->newest && arena->used > arena->newest)
+	{
+		arena->used = arena->newest;
+	}
+}
+
+dyn_arena_t *dyn_arena_create(const size_t bytes, const unsigned flags)
+{
+	const size_t page	= (flags & DYN_ALLOC_HUGE) ? DYN_HUGE_PAGE_SIZE : (size_t) sysconf(_SC_PAGESIZE);
+	const size_t length = dyn_round_up(bytes, page);
+	if (!length)
+	{
+		return NULL;
+	}
+	dyn_arena_t *arena = (dyn_arena_t *) malloc(sizeof(dyn_arena_t));
+	if (arena)
+	{
+		// reserved, not committed: untouched pages cost nothing
+		void *mapping = (flags & DYN_ALLOC_HUGE)
+							? dyn_map(length, MAP_NORESERVE)
+							: mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (mapping && mapping != MAP_FAILED)
+		{
+			*arena = (dyn_arena_t){(uint8_t *) mapping, bytes, length, 0, 0,
+								   (flags & DYN_ALLOC_ALIGNED) ? DYN_CACHE_LINE : sizeof(max_align_t)};
+			return arena;
+		}
+		free(arena);
+	}
+	return NULL;
+}
+
+dyn_allocator_t dyn_arena_allocator(dyn_arena_t *const arena)
+{
+	return (dyn_allocator_t){dyn_arena_allocate, dyn_arena_reallocate, dyn_arena_release, arena};
+}
+
+void dyn_arena_reset(dyn_arena_t *const arena)
+{
+	if (arena)
+	{
+		arena->used	  = 0;
+		arena->newest = 0;
+	}
+}
+
+size_t dyn_arena_used(const dyn_arena_t *const arena)
+{
+	return arena ? arena->used : 0;
+}
+
+void dyn_arena_destroy(dyn_arena_t *const arena)
+{
+	if (arena)
+	{
+		munmap(arena->base, arena->mapped);
+		free(arena);
+	}
+}
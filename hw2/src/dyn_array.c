@@ -1,19 +1,30 @@
+// sysconf() for the online CPU count
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <unistd.h>
+
 #include "dyn_array.h"
 
 // Flag values
-// SHRUNK to indicate shrink_to_fit was called and size needs to be corrected
-// SORTED to track if the objects have been sorted by us (sorted is set by sort and unset by insert/push)
-// these are just ideas
-// typedef enum {NONE = 0x00, SHRUNK = 0x01, SORTED = 0x02, ALL = 0xFF} DYN_FLAGS;
+// SHRUNK to indicate shrink_to_fit was called and capacity needs to be corrected back to a power of two
+// SORTED to track if the objects are in sorted_by order (set by sort, kept by removals and in-order inserts)
+typedef enum {NONE = 0x00, SHRUNK = 0x01, SORTED = 0x02, ALL = 0xFF} DYN_FLAGS;
+
+#define SET_FLAG(dyn_array_ptr, flag) ((dyn_array_ptr)->flags |= (flag))
+#define CLEAR_FLAG(dyn_array_ptr, flag) ((dyn_array_ptr)->flags &= ~(flag))
+#define HAS_FLAG(dyn_array_ptr, flag) ((dyn_array_ptr)->flags & (flag))
 
 struct dyn_array 
 {
-	// DYN_FLAGS flags;
 	size_t capacity;
 	size_t size;
 	const size_t data_size;
 	void *array;
 	void (*destructor)(void *);
+	dyn_allocator_t allocator;
+	unsigned flags;									// DYN_FLAGS
+	int (*sorted_by)(const void *, const void *);	// comparator SORTED refers to
 };
 
 // Supports 64bit+ size_t!
@@ -23,12 +34,38 @@ struct dyn_array
 #define DYN_MAX_CAPACITY (((size_t) 1) << ((sizeof(size_t) << 3) - 8))
 #endif
 
+// Per-thread cost counters, see dyn_array_stats()
+#ifdef DYN_ARRAY_STATS
+static _Thread_local dyn_array_stats_t dyn_stats;
+#define DYN_STAT_ADD(field, amount) (dyn_stats.field += (amount))
+#else
+#define DYN_STAT_ADD(field, amount) ((void) 0)
+#endif
+
+// Calls a comparison function, counting the call
+#define DYN_COMPARE(compare, a, b) (DYN_STAT_ADD(comparisons, 1), (compare)(a, b))
+
 // casts pointer and does arithmetic to get index of element
 #define DYN_ARRAY_POSITION(dyn_array_ptr, idx) \
 	(((uint8_t *) (dyn_array_ptr)->array) + ((idx) * (dyn_array_ptr)->data_size))
 // Gets the size (in bytes) of n dyn_array elements
 #define DYN_SIZE_N_ELEMS(dyn_array_ptr, n) ((dyn_array_ptr)->data_size * (n))
 
+// Hands out a writable pointer into the array. Writes through it can put the array out of order
+// without it knowing, so it stops claiming an order (the flag is bookkeeping, hence the const cast)
+static inline void *dyn_lend(const dyn_array_t *const dyn_array, void *const object)
+{
+	CLEAR_FLAG((dyn_array_t *) dyn_array, SORTED);
+	return object;
+}
+
+// Records that the array is in compare order
+static inline void dyn_mark_sorted(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *))
+{
+	SET_FLAG(dyn_array, SORTED);
+	dyn_array->sorted_by = compare;
+}
+
 
 
 // Modes of operation for dyn_shift
@@ -43,14 +80,45 @@ bool dyn_shift_insert(dyn_array_t *const dyn_array, const size_t position, const
 bool dyn_shift_remove(dyn_array_t *const dyn_array, const size_t position, const size_t count,
 					  const DYN_SHIFT_MODE mode, void *const data_dst);
 
+// Checks to see if the object can handle an increase in size (and optionally increases capacity)
+bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increment);
+
+
 
 
+// The allocator used when none is given
+static void *dyn_malloc(void *ctx, size_t bytes)
+{
+	(void) ctx;
+	return malloc(bytes);
+}
+
+static void *dyn_realloc(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes)
+{
+	(void) ctx;
+	(void) old_bytes;
+	return realloc(ptr, new_bytes);
+}
+
+static void dyn_free(void *ctx, void *ptr, size_t bytes)
+{
+	(void) ctx;
+	(void) bytes;
+	free(ptr);
+}
 
 dyn_array_t *dyn_array_create(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *)) 
 {
-	if (data_type_size && capacity <= DYN_MAX_CAPACITY) 
+	return dyn_array_create_with(capacity, data_type_size, destruct_func, NULL);
+}
+
+dyn_array_t *dyn_array_create_with(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *),
+								   const dyn_allocator_t *const allocator)
+{
+	const dyn_allocator_t alloc = allocator ? *allocator : (dyn_allocator_t){dyn_malloc, dyn_realloc, dyn_free, NULL};
+	if (data_type_size && capacity <= DYN_MAX_CAPACITY && alloc.allocate && alloc.reallocate && alloc.release) 
 	{
-		dyn_array_t *dyn_array = (dyn_array_t *) malloc(sizeof(dyn_array_t));
+		dyn_array_t *dyn_array = (dyn_array_t *) alloc.allocate(alloc.ctx, sizeof(dyn_array_t));
 		if (dyn_array) 
 		{
 			// would have inf loop if requested size was between DYN_MAX_CAPACITY
@@ -71,16 +139,18 @@ dyn_array_t *dyn_array_create(const size_t capacity, const size_t data_type_size
 			// I had an idea... and it compiles
 			// const members of a malloc'd struct are so annoying
 			memcpy(dyn_array, &((dyn_array_t){actual_capacity, 0, data_type_size,
-											  malloc(data_type_size * actual_capacity), destruct_func}),
+											  alloc.allocate(alloc.ctx, data_type_size * actual_capacity), destruct_func,
+											  alloc, NONE, NULL}),
 				   sizeof(dyn_array_t));
 
+			DYN_STAT_ADD(mallocs, 2);
 			if (dyn_array->array) 
 			{
 				// other malloc worked, yay!
 				// we're done?
 				return dyn_array;
 			}
-			free(dyn_array);
+			alloc.release(alloc.ctx, dyn_array, sizeof(dyn_array_t));
 		}
 	}
 	return NULL;
@@ -116,12 +186,18 @@ const void *dyn_array_export(const dyn_array_t *const dyn_array)
 	return dyn_array_front(dyn_array);
 }
 
+const void *dyn_array_contents(const dyn_array_t *const dyn_array)
+{
+	return dyn_array_peek(dyn_array, 0);
+}
+
 void dyn_array_destroy(dyn_array_t *dyn_array) 
 {
 	if (dyn_array) {
 		dyn_array_clear(dyn_array);
-		free(dyn_array->array);
-		free(dyn_array);
+		const dyn_allocator_t alloc = dyn_array->allocator;
+		alloc.release(alloc.ctx, dyn_array->array, DYN_SIZE_N_ELEMS(dyn_array, dyn_array->capacity));
+		alloc.release(alloc.ctx, dyn_array, sizeof(dyn_array_t));
 	}
 }
 
@@ -135,7 +211,7 @@ void *dyn_array_front(const dyn_array_t *const dyn_array)
 		// If array is null, well, this is ok, because it's null
 		// but if array is broken, well, we can't help that
 		// nor can we detect that, so I guess it's not an error
-		return dyn_array->array;
+		return dyn_lend(dyn_array, dyn_array->array);
 	}
 	return NULL;
 }
@@ -162,7 +238,7 @@ void *dyn_array_back(const dyn_array_t *const dyn_array)
 {
 	if (dyn_array && dyn_array->size) 
 	{
-		return DYN_ARRAY_POSITION(dyn_array, dyn_array->size - 1);
+		return dyn_lend(dyn_array, DYN_ARRAY_POSITION(dyn_array, dyn_array->size - 1));
 	}
 	return NULL;
 }
@@ -172,6 +248,11 @@ bool dyn_array_push_back(dyn_array_t *const dyn_array, const void *const object)
 	return dyn_array && dyn_shift_insert(dyn_array, dyn_array->size, 1, MODE_INSERT, (void *const) object);
 }
 
+bool dyn_array_push_back_n(dyn_array_t *const dyn_array, const void *const objects, const size_t count)
+{
+	return dyn_array && dyn_shift_insert(dyn_array, dyn_array->size, count, MODE_INSERT, objects);
+}
+
 bool dyn_array_pop_back(dyn_array_t *const dyn_array) 
 {
 	// Assert size because rollunder is scary, (though it should be handled correctly)
@@ -188,6 +269,15 @@ bool dyn_array_extract_back(dyn_array_t *const dyn_array, void *const object)
 void *dyn_array_at(const dyn_array_t *const dyn_array, const size_t index) 
 {
 	if (dyn_array && index < dyn_array->size) 
+	{
+		return dyn_lend(dyn_array, DYN_ARRAY_POSITION(dyn_array, index));
+	}
+	return NULL;
+}
+
+const void *dyn_array_peek(const dyn_array_t *const dyn_array, const size_t index)
+{
+	if (dyn_array && index < dyn_array->size)
 	{
 		return DYN_ARRAY_POSITION(dyn_array, index);
 	}
@@ -255,31 +345,403 @@ size_t dyn_array_data_size(const dyn_array_t *const dyn_array)
 
 
 
+#ifdef DYN_ARRAY_STATS
+static _Thread_local int (*dyn_counted_compare)(const void *, const void *);
+
+static int dyn_counting_compare(const void *a, const void *b)
+{
+	return DYN_COMPARE(dyn_counted_compare, a, b);
+}
+#endif
+
+// Checks (and remembers) whether the array is already in compare order, one pass that stops at the first
+// object out of order. Cheap next to a sort, and on unsorted data it usually gives up almost immediately.
+static bool dyn_already_sorted(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *))
+{
+	if (dyn_array_is_sorted(dyn_array, compare))
+	{
+		return true;
+	}
+	for (size_t idx = 1; idx < dyn_array->size; ++idx)
+	{
+		if (DYN_COMPARE(compare, DYN_ARRAY_POSITION(dyn_array, idx - 1), DYN_ARRAY_POSITION(dyn_array, idx)) > 0)
+		{
+			return false;
+		}
+	}
+	dyn_mark_sorted(dyn_array, compare);
+	return true;
+}
+
+bool dyn_array_is_sorted(const dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *))
+{
+	return dyn_array && compare && HAS_FLAG(dyn_array, SORTED) && dyn_array->sorted_by == compare;
+}
+
+void dyn_array_mark_unsorted(dyn_array_t *const dyn_array)
+{
+	if (dyn_array)
+	{
+		CLEAR_FLAG(dyn_array, SORTED);
+	}
+}
+
 bool dyn_array_sort(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *)) 
 {
 	// hah, turns out there's a quicksort in cstdlib.
 	// and it works exactly like we want it to
 	if (dyn_array && dyn_array->size && compare) 
 	{
+		if (dyn_already_sorted(dyn_array, compare))
+		{
+			return true;
+		}
+#ifdef DYN_ARRAY_STATS
+		// qsort can't count for us, route it through a counting comparison
+		dyn_counted_compare = compare;
+		qsort(dyn_array->array, dyn_array->size, dyn_array->data_size, dyn_counting_compare);
+#else
 		qsort(dyn_array->array, dyn_array->size, dyn_array->data_size, compare);
+#endif
+		dyn_mark_sorted(dyn_array, compare);
 		return true;
 	}
 	return false;
 }
 
 
+// Below this many objects per thread, the parallel sort stays on the calling thread
+// Allowing it to be externally set
+#ifndef DYN_SORT_PARALLEL_CUTOFF
+#define DYN_SORT_PARALLEL_CUTOFF ((size_t) 1 << 15)
+#endif
+
+// Runs shorter than this are insertion sorted before merging starts
+#define DYN_SORT_RUN 32
+
+typedef int (*dyn_compare_t)(const void *, const void *);
+
+// Stable merge of two sorted runs into dst (dst must not overlap either run)
+static void dyn_merge_runs(uint8_t *dst, const uint8_t *left, size_t left_count, const uint8_t *right,
+						   size_t right_count, const size_t size, const dyn_compare_t compare)
+{
+	while (left_count && right_count)
+	{
+		// ties go left, that's what keeps it stable
+		if (DYN_COMPARE(compare, left, right) <= 0)
+		{
+			memcpy(dst, left, size);
+			left += size;
+			--left_count;
+		}
+		else
+		{
+			memcpy(dst, right, size);
+			right += size;
+			--right_count;
+		}
+		dst += size;
+	}
+	memcpy(dst, left, left_count * size);
+	memcpy(dst + left_count * size, right, right_count * size);
+}
+
+// Stable bottom-up merge sort of count objects at data, scratch must hold count objects
+static void dyn_stable_sort(uint8_t *data, uint8_t *scratch, const size_t count, const size_t size,
+							const dyn_compare_t compare)
+{
+	if (count < 2)
+	{
+		return;
+	}
+	// insertion sort small runs in place, scratch doubles as the holding spot
+	for (size_t run = 0; run < count; run += DYN_SORT_RUN)
+	{
+		size_t run_end = run + DYN_SORT_RUN < count ? run + DYN_SORT_RUN : count;
+		for (size_t idx = run + 1; idx < run_end; ++idx)
+		{
+			size_t slot = idx;
+			memcpy(scratch, data + idx * size, size);
+			while (slot > run && DYN_COMPARE(compare, data + (slot - 1) * size, scratch) > 0)
+			{
+				--slot;
+			}
+			if (slot != idx)
+			{
+				memmove(data + (slot + 1) * size, data + slot * size, (idx - slot) * size);
+				memcpy(data + slot * size, scratch, size);
+			}
+		}
+	}
+	// ping-pong merges between data and scratch
+	uint8_t *src = data, *dst = scratch;
+	for (size_t width = DYN_SORT_RUN; width < count; width <<= 1)
+	{
+		for (size_t start = 0; start < count; start += width << 1)
+		{
+			size_t mid = start + width < count ? start + width : count;
+			size_t end = mid + width < count ? mid + width : count;
+			dyn_merge_runs(dst + start * size, src + start * size, mid - start, src + mid * size, end - mid, size,
+						   compare);
+		}
+		uint8_t *swap = src;
+		src = dst;
+		dst = swap;
+	}
+	if (src != data)
+	{
+		memcpy(data, src, count * size);
+	}
+}
+
+// How many objects from the left run come first in the first `rank` merged outputs
+// (merge path split, ties go left just like dyn_merge_runs)
+static size_t dyn_merge_split(const uint8_t *left, const size_t left_count, const uint8_t *right,
+							  const size_t right_count, const size_t rank, const size_t size,
+							  const dyn_compare_t compare)
+{
+	size_t low = rank > right_count ? rank - right_count : 0;
+	size_t high = rank < left_count ? rank : left_count;
+	while (low < high)
+	{
+		size_t taken = low + (high - low) / 2;
+		// too few taken from the left if the next left object still beats the last right one
+		if (DYN_COMPARE(compare, left + taken * size, right + (rank - taken - 1) * size) <= 0)
+		{
+			low = taken + 1;
+		}
+		else
+		{
+			high = taken;
+		}
+	}
+	return low;
+}
+
+// One unit of parallel sort work: either sort a range or merge a slice of two runs
+typedef struct
+{
+	uint8_t *src;
+	uint8_t *dst;
+	size_t size;
+	dyn_compare_t compare;
+	size_t begin;		 // first object of the left run (sort: first object of the range)
+	size_t middle;		 // first object of the right run (sort: unused)
+	size_t end;			 // one past the right run (sort: one past the range)
+	size_t out_begin;	 // merged ranks handled by this job, relative to begin
+	size_t out_end;
+	bool sort_only;
+} dyn_sort_job_t;
+
+static void *dyn_sort_worker(void *arg)
+{
+	dyn_sort_job_t *job = (dyn_sort_job_t *) arg;
+	const size_t size = job->size;
+	if (job->sort_only)
+	{
+		dyn_stable_sort(job->src + job->begin * size, job->dst + job->begin * size, job->end - job->begin, size,
+						job->compare);
+		return NULL;
+	}
+	const uint8_t *left = job->src + job->begin * size;
+	const uint8_t *right = job->src + job->middle * size;
+	const size_t left_count = job->middle - job->begin, right_count = job->end - job->middle;
+	size_t left_from = dyn_merge_split(left, left_count, right, right_count, job->out_begin, size, job->compare);
+	size_t left_to = dyn_merge_split(left, left_count, right, right_count, job->out_end, size, job->compare);
+	size_t right_from = job->out_begin - left_from, right_to = job->out_end - left_to;
+	dyn_merge_runs(job->dst + (job->begin + job->out_begin) * size, left + left_from * size, left_to - left_from,
+				   right + right_from * size, right_to - right_from, size, job->compare);
+	return NULL;
+}
+
+#ifdef DYN_ARRAY_STATS
+// Thread entry that hands the job's counters to the thread that joins it
+static void *dyn_sort_thread(void *arg)
+{
+	dyn_array_stats_reset();
+	dyn_sort_worker(arg);
+	dyn_array_stats_t *stats = (dyn_array_stats_t *) malloc(sizeof(dyn_array_stats_t));
+	if (stats)
+	{
+		*stats = dyn_stats;
+	}
+	return stats;
+}
+#else
+#define dyn_sort_thread dyn_sort_worker
+#endif
+
+// Runs every job, the calling thread takes the first one
+static bool dyn_run_sort_jobs(dyn_sort_job_t *jobs, const size_t count, pthread_t *threads)
+{
+	size_t started = 1;
+	bool success = true;
+	for (; started < count; ++started)
+	{
+		if (pthread_create(&threads[started], NULL, dyn_sort_thread, &jobs[started]))
+		{
+			break;
+		}
+	}
+	dyn_sort_worker(&jobs[0]);
+	// anything that couldn't get a thread runs here instead
+	for (size_t idx = started; idx < count; ++idx)
+	{
+		dyn_sort_worker(&jobs[idx]);
+	}
+	for (size_t idx = 1; idx < started; ++idx)
+	{
+#ifdef DYN_ARRAY_STATS
+		void *stats = NULL;
+		success = !pthread_join(threads[idx], &stats) && success;
+		dyn_array_stats_add((dyn_array_stats_t *) stats);
+		free(stats);
+#else
+		success = !pthread_join(threads[idx], NULL) && success;
+#endif
+	}
+	return success;
+}
+
+bool dyn_array_sort_parallel(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *),
+							 const size_t nthreads)
+{
+	if (!dyn_array || !dyn_array->size || !compare)
+	{
+		return false;
+	}
+	if (dyn_already_sorted(dyn_array, compare))
+	{
+		return true;
+	}
+	// a failed sort can leave the objects in any order
+	CLEAR_FLAG(dyn_array, SORTED);
+
+	size_t threads = nthreads;
+	if (!threads)
+	{
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 0 ? (size_t) online : 1;
+	}
+	if (threads > dyn_array->size / DYN_SORT_PARALLEL_CUTOFF)
+	{
+		threads = dyn_array->size / DYN_SORT_PARALLEL_CUTOFF;
+	}
+	if (!threads)
+	{
+		threads = 1;
+	}
+
+	const size_t count = dyn_array->size, size = dyn_array->data_size;
+	uint8_t *scratch = (uint8_t *) malloc(DYN_SIZE_N_ELEMS(dyn_array, count));
+	DYN_STAT_ADD(mallocs, 1);
+	if (!scratch)
+	{
+		return false;
+	}
+	if (threads == 1)
+	{
+		dyn_stable_sort((uint8_t *) dyn_array->array, scratch, count, size, compare);
+		free(scratch);
+		dyn_mark_sorted(dyn_array, compare);
+		return true;
+	}
+
+	// run boundaries, run i is [bounds[i], bounds[i + 1])
+	size_t *bounds = (size_t *) malloc((threads + 1) * sizeof(size_t));
+	dyn_sort_job_t *jobs = (dyn_sort_job_t *) malloc(threads * sizeof(dyn_sort_job_t));
+	pthread_t *pool = (pthread_t *) malloc(threads * sizeof(pthread_t));
+	DYN_STAT_ADD(mallocs, 3);
+	bool success = bounds && jobs && pool;
+	if (success)
+	{
+		uint8_t *src = (uint8_t *) dyn_array->array, *dst = scratch;
+		size_t runs = threads;
+		for (size_t run = 0; run <= runs; ++run)
+		{
+			bounds[run] = count / runs * run + (run < count % runs ? run : count % runs);
+		}
+
+		// every thread sorts its own run first
+		for (size_t run = 0; run < runs; ++run)
+		{
+			jobs[run] = (dyn_sort_job_t){src, dst, size, compare, bounds[run], 0, bounds[run + 1], 0, 0, true};
+		}
+		success = dyn_run_sort_jobs(jobs, runs, pool);
+
+		// then runs are merged pairwise, splitting each merge across the threads it is due
+		while (success && runs > 1)
+		{
+			size_t pairs = runs / 2, job_count = 0;
+			size_t per_pair = threads / pairs ? threads / pairs : 1;
+			for (size_t pair = 0; pair < pairs; ++pair)
+			{
+				size_t begin = bounds[2 * pair], middle = bounds[2 * pair + 1], end = bounds[2 * pair + 2];
+				for (size_t part = 0; part < per_pair; ++part)
+				{
+					jobs[job_count++] = (dyn_sort_job_t){src,	   dst,
+														 size,	   compare,
+														 begin,	   middle,
+														 end,	   (end - begin) * part / per_pair,
+														 (end - begin) * (part + 1) / per_pair, false};
+				}
+			}
+			if (runs & 1)
+			{
+				// odd run out just moves over
+				memcpy(dst + bounds[runs - 1] * size, src + bounds[runs - 1] * size, (count - bounds[runs - 1]) * size);
+			}
+			success = dyn_run_sort_jobs(jobs, job_count, pool);
+
+			for (size_t pair = 0; pair < pairs; ++pair)
+			{
+				bounds[pair] = bounds[2 * pair];
+			}
+			if (runs & 1)
+			{
+				bounds[pairs] = bounds[runs - 1];
+			}
+			runs = (runs + 1) / 2;
+			bounds[runs] = count;
+			uint8_t *swap = src;
+			src = dst;
+			dst = swap;
+		}
+		if (success && src != dyn_array->array)
+		{
+			memcpy(dyn_array->array, src, count * size);
+		}
+		if (success)
+		{
+			dyn_mark_sorted(dyn_array, compare);
+		}
+	}
+	free(bounds);
+	free(jobs);
+	free(pool);
+	free(scratch);
+	return success;
+}
+
+
 bool dyn_array_insert_sorted(dyn_array_t *const dyn_array, const void *const object,
 							 int (*const compare)(const void *, const void *)) 
 {
 	if (dyn_array && compare && object) 
 	{
-		size_t ordered_position = 0;
-		if (dyn_array->size) 
+		// binary search for the first object not less than the new one (ahead of any equal ones)
+		size_t ordered_position = 0, remaining = dyn_array->size;
+		while (remaining)
 		{
-			while (ordered_position < dyn_array->size
-				   && compare(object, DYN_ARRAY_POSITION(dyn_array, ordered_position)) > 0) 
+			const size_t half = remaining >> 1;
+			if (DYN_COMPARE(compare, object, DYN_ARRAY_POSITION(dyn_array, ordered_position + half)) > 0)
+			{
+				ordered_position += half + 1;
+				remaining -= half + 1;
+			}
+			else
 			{
-				++ordered_position;
+				remaining = half;
 			}
 		}
 		return dyn_shift_insert(dyn_array, ordered_position, 1, MODE_INSERT, object);
@@ -288,6 +750,79 @@ bool dyn_array_insert_sorted(dyn_array_t *const dyn_array, const void *const obj
 }
 
 
+bool dyn_array_merge_sorted(dyn_array_t *const dyn_array, const void *const objects, const size_t count,
+							 int (*const compare)(const void *, const void *))
+{
+	if (!dyn_array || !objects || !count || !compare || !dyn_request_size_increase(dyn_array, count))
+	{
+		return false;
+	}
+	const bool keep_sorted = dyn_array_is_sorted(dyn_array, compare);
+
+	// merge from the back so nothing in the array moves more than once
+	// on ties the array's object goes later, so batch objects land ahead of equal ones like insert_sorted
+	const uint8_t *batch = (const uint8_t *) objects;
+	size_t existing = dyn_array->size, incoming = count, write = dyn_array->size + count;
+	while (incoming)
+	{
+		if (existing && DYN_COMPARE(compare, DYN_ARRAY_POSITION(dyn_array, existing - 1),
+									batch + DYN_SIZE_N_ELEMS(dyn_array, incoming - 1)) >= 0)
+		{
+			memcpy(DYN_ARRAY_POSITION(dyn_array, --write), DYN_ARRAY_POSITION(dyn_array, --existing),
+				   dyn_array->data_size);
+			DYN_STAT_ADD(bytes_shifted, dyn_array->data_size);
+		}
+		else
+		{
+			memcpy(DYN_ARRAY_POSITION(dyn_array, --write), batch + DYN_SIZE_N_ELEMS(dyn_array, --incoming),
+				   dyn_array->data_size);
+		}
+	}
+	dyn_array->size += count;
+	if (keep_sorted)
+	{
+		dyn_mark_sorted(dyn_array, compare);
+	}
+	else
+	{
+		CLEAR_FLAG(dyn_array, SORTED);
+	}
+	return true;
+}
+
+size_t dyn_array_erase_if(dyn_array_t *const dyn_array, bool (*const predicate)(const void *const, void *), void *arg)
+{
+	if (!dyn_array || !predicate)
+	{
+		return 0;
+	}
+	// survivors slide down over the erased ones as we go, one pass and each object moves at most once
+	size_t kept = 0;
+	for (size_t idx = 0; idx < dyn_array->size; ++idx)
+	{
+		void *object = DYN_ARRAY_POSITION(dyn_array, idx);
+		if (predicate(object, arg))
+		{
+			if (dyn_array->destructor)
+			{
+				dyn_array->destructor(object);
+			}
+		}
+		else
+		{
+			if (kept != idx)
+			{
+				memcpy(DYN_ARRAY_POSITION(dyn_array, kept), object, dyn_array->data_size);
+				DYN_STAT_ADD(bytes_shifted, dyn_array->data_size);
+			}
+			++kept;
+		}
+	}
+	const size_t erased = dyn_array->size - kept;
+	dyn_array->size = kept;
+	return erased;
+}
+
 bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *const, void *), void *arg) 
 {
 	if (dyn_array && dyn_array->array && func) 
@@ -300,6 +835,8 @@ bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *c
 		// Not checking it will segfault, which is good for debugging, but not so much for the end user
 		// but good for the tester. But the tester may not trigger this if it's a crazy edge case.
 		// HMMMMMMMMM...
+		// func can change anything, so the order is anyone's guess afterwards
+		CLEAR_FLAG(dyn_array, SORTED);
 		uint8_t *data_walker = (uint8_t *) dyn_array->array;
 		for (size_t idx = 0; idx < dyn_array->size; ++idx, data_walker += dyn_array->data_size) 
 		{
@@ -311,18 +848,34 @@ bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *c
 }
 
 
-/*
-	// No return value. It either goes or it doesn't. shrink_to_fit is more of a request
-	void dyn_array_shrink_to_fit(dyn_array_t *const dyn_array) {
-	if (dyn_array) {
-		void *new_address = realloc(dyn_array->data, DYN_ARRAY_SIZE_N_ELEMS(dyn_array, dyn_array->size));
-		if (new_address) {
-			dyn_array->data = new_address;
-			SET_FLAG(dyn_array,SHRUNK);
-		}
+bool dyn_array_reserve(dyn_array_t *const dyn_array, const size_t capacity)
+{
+	if (dyn_array)
+	{
+		return capacity <= dyn_array->size || dyn_request_size_increase(dyn_array, capacity - dyn_array->size);
 	}
+	return false;
+}
+
+// No return value. It either goes or it doesn't. shrink_to_fit is more of a request
+void dyn_array_shrink_to_fit(dyn_array_t *const dyn_array)
+{
+	// keep room for one so the storage never has to be a zero-byte allocation
+	const size_t fitted = dyn_array && dyn_array->size ? dyn_array->size : 1;
+	if (dyn_array && fitted < dyn_array->capacity)
+	{
+		void *new_address = dyn_array->allocator.reallocate(dyn_array->allocator.ctx, dyn_array->array,
+															DYN_SIZE_N_ELEMS(dyn_array, dyn_array->capacity),
+															DYN_SIZE_N_ELEMS(dyn_array, fitted));
+		DYN_STAT_ADD(reallocs, 1);
+		if (new_address)
+		{
+			dyn_array->array	= new_address;
+			dyn_array->capacity = fitted;
+			SET_FLAG(dyn_array, SHRUNK);
+		}
 	}
-*/
+}
 
 
 
@@ -334,8 +887,6 @@ bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *c
 //
 
 
-// Checks to see if the object can handle an increase in size (and optionally increases capacity)
-bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increment);
 
 #define MODE_IS_TYPE(mode, type) ((mode) & (type))
 
@@ -361,9 +912,25 @@ bool dyn_shift_insert(dyn_array_t *const dyn_array, const size_t position, const
 			{  // wasn't a gap at the end, we need to move data
 				memmove(DYN_ARRAY_POSITION(dyn_array, position + count), DYN_ARRAY_POSITION(dyn_array, position),
 						DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - position));
+				DYN_STAT_ADD(bytes_shifted, DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - position));
 			}
 			memcpy(DYN_ARRAY_POSITION(dyn_array, position), data_src, dyn_array->data_size * count);
 			dyn_array->size += count;
+			if (HAS_FLAG(dyn_array, SORTED))
+			{
+				// still sorted only if the new objects fit between their neighbours (and each other)
+				const size_t first = position ? position - 1 : 0;
+				const size_t last  = position + count < dyn_array->size ? position + count : dyn_array->size - 1;
+				for (size_t idx = first; idx < last; ++idx)
+				{
+					if (DYN_COMPARE(dyn_array->sorted_by, DYN_ARRAY_POSITION(dyn_array, idx),
+									DYN_ARRAY_POSITION(dyn_array, idx + 1)) > 0)
+					{
+						CLEAR_FLAG(dyn_array, SORTED);
+						break;
+					}
+				}
+			}
 			return true;
 		}
 	}
@@ -414,6 +981,7 @@ bool dyn_shift_remove(dyn_array_t *const dyn_array, const size_t position, const
 			// there's a actual gap, not just a hole to make at the end
 			memmove(DYN_ARRAY_POSITION(dyn_array, position), DYN_ARRAY_POSITION(dyn_array, position + count),
 					DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - (position + count)));
+			DYN_STAT_ADD(bytes_shifted, DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - (position + count)));
 		}
 		// decrease the size and return
 		dyn_array->size -= count;
@@ -439,11 +1007,11 @@ bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increm
 		// have to reallocate, is that even possible?
 		size_t needed_size = dyn_array->size + increment;
 
-		// INSERT SHRINK_TO_FIT CORRECTION HERE
-
 		if (needed_size <= DYN_MAX_CAPACITY) 
 		{
-			size_t new_capacity = dyn_array->capacity << 1;
+			// a shrunk capacity can be anything (even 1, which would double very slowly),
+			// so climb back to the power of two grid from the start
+			size_t new_capacity = HAS_FLAG(dyn_array, SHRUNK) || !dyn_array->capacity ? 16 : dyn_array->capacity << 1;
 			while (new_capacity < needed_size) 
 			{
 				new_capacity <<= 1;
@@ -452,15 +1020,51 @@ bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increm
 			// we can theoretically hold this, check if we can allocate that
 			// if (!MULTIPLY_MAY_OVERFLOW(new_capacity, dyn_array->data_size)) {
 			// we won't overflow, so we can at least REQUEST this change
-			void *new_array = realloc(dyn_array->array, new_capacity * dyn_array->data_size);
+			void *new_array = dyn_array->allocator.reallocate(dyn_array->allocator.ctx, dyn_array->array,
+															  DYN_SIZE_N_ELEMS(dyn_array, dyn_array->capacity),
+															  DYN_SIZE_N_ELEMS(dyn_array, new_capacity));
+			DYN_STAT_ADD(reallocs, 1);
 			if (new_array) 
 			{
 				// success! Wasn't that easy?
 				dyn_array->array	= new_array;
 				dyn_array->capacity = new_capacity;
+				CLEAR_FLAG(dyn_array, SHRUNK);
 				return true;
 			}
 		}
 	}
 	return false;
 }
+
+
+dyn_array_stats_t dyn_array_stats(void)
+{
+#ifdef DYN_ARRAY_STATS
+	return dyn_stats;
+#else
+	return (dyn_array_stats_t){0, 0, 0, 0};
+#endif
+}
+
+void dyn_array_stats_reset(void)
+{
+#ifdef DYN_ARRAY_STATS
+	memset(&dyn_stats, 0, sizeof(dyn_stats));
+#endif
+}
+
+void dyn_array_stats_add(const dyn_array_stats_t *const stats)
+{
+#ifdef DYN_ARRAY_STATS
+	if (stats)
+	{
+		dyn_stats.mallocs += stats->mallocs;
+		dyn_stats.reallocs += stats->reallocs;
+		dyn_stats.bytes_shifted += stats->bytes_shifted;
+		dyn_stats.comparisons += stats->comparisons;
+	}
+#else
+	(void) stats;
+#endif
+}
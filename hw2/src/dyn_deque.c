@@ -0,0 +1,230 @@
+#include "dyn_deque.h"
+
+struct dyn_deque
+{
+	size_t capacity;  // always a power of two, so wrapping is a mask
+	size_t size;
+	size_t head;	  // slot of the front object
+	size_t data_size;
+	uint8_t *array;
+	void (*destructor)(void *);
+	dyn_allocator_t allocator;
+};
+
+// Same cap as dyn_array
+#ifndef DYN_MAX_CAPACITY
+#define DYN_MAX_CAPACITY (((size_t) 1) << ((sizeof(size_t) << 3) - 8))
+#endif
+
+// Storage growths, counted like dyn_array's
+#ifdef DYN_ARRAY_STATS
+#define DYN_DEQUE_COUNT(mallocs, reallocs) dyn_array_stats_add(&(dyn_array_stats_t){(mallocs), (reallocs), 0, 0})
+#else
+#define DYN_DEQUE_COUNT(mallocs, reallocs) ((void) 0)
+#endif
+
+// Address of the slot index places from the front
+#define DYN_DEQUE_SLOT(dyn_deque_ptr, idx) \
+	((dyn_deque_ptr)->array + ((((dyn_deque_ptr)->head + (idx)) & ((dyn_deque_ptr)->capacity - 1)) * (dyn_deque_ptr)->data_size))
+
+dyn_deque_t *dyn_deque_create(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *))
+{
+	return dyn_deque_create_with(capacity, data_type_size, destruct_func, NULL);
+}
+
+dyn_deque_t *dyn_deque_create_with(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *),
+								   const dyn_allocator_t *const allocator)
+{
+	const dyn_allocator_t alloc = allocator ? *allocator : dyn_allocator_system(DYN_ALLOC_DEFAULT);
+	if (data_type_size && capacity <= DYN_MAX_CAPACITY && alloc.allocate && alloc.reallocate && alloc.release)
+	{
+		dyn_deque_t *dyn_deque = (dyn_deque_t *) alloc.allocate(alloc.ctx, sizeof(dyn_deque_t));
+		if (dyn_deque)
+		{
+			size_t actual_capacity = 16;
+			while (capacity > actual_capacity)
+			{
+				actual_capacity <<= 1;
+			}
+			*dyn_deque = (dyn_deque_t){actual_capacity, 0, 0, data_type_size,
+									   (uint8_t *) alloc.allocate(alloc.ctx, data_type_size * actual_capacity),
+									   destruct_func, alloc};
+			DYN_DEQUE_COUNT(2, 0);
+			if (dyn_deque->array)
+			{
+				return dyn_deque;
+			}
+			alloc.release(alloc.ctx, dyn_deque, sizeof(dyn_deque_t));
+		}
+	}
+	return NULL;
+}
+
+void dyn_deque_destroy(dyn_deque_t *const dyn_deque)
+{
+	if (dyn_deque)
+	{
+		dyn_deque_clear(dyn_deque);
+		const dyn_allocator_t alloc = dyn_deque->allocator;
+		alloc.release(alloc.ctx, dyn_deque->array, dyn_deque->capacity * dyn_deque->data_size);
+		alloc.release(alloc.ctx, dyn_deque, sizeof(dyn_deque_t));
+	}
+}
+
+// Makes room for one more object, doubling the ring when it's full
+static bool dyn_deque_reserve_one(dyn_deque_t *const dyn_deque)
+{
+	if (dyn_deque->size < dyn_deque->capacity)
+	{
+		return true;
+	}
+	const size_t old_capacity = dyn_deque->capacity;
+	if (old_capacity > DYN_MAX_CAPACITY >> 1)
+	{
+		return false;
+	}
+	uint8_t *grown = (uint8_t *) dyn_deque->allocator.reallocate(dyn_deque->allocator.ctx, dyn_deque->array,
+																	old_capacity * dyn_deque->data_size,
+																	(old_capacity << 1) * dyn_deque->data_size);
+	DYN_DEQUE_COUNT(0, 1);
+	if (!grown)
+	{
+		return false;
+	}
+	// The ring was full, so it wraps at head: [head, old_capacity) then [0, head)
+	// Moving the [0, head) part right after the old end straightens it out again
+	memcpy(grown + old_capacity * dyn_deque->data_size, grown, dyn_deque->head * dyn_deque->data_size);
+	dyn_deque->array	= grown;
+	dyn_deque->capacity = old_capacity << 1;
+	return true;
+}
+
+void *dyn_deque_front(const dyn_deque_t *const dyn_deque)
+{
+	return dyn_deque_at(dyn_deque, 0);
+}
+
+bool dyn_deque_push_front(dyn_deque_t *const dyn_deque, const void *const object)
+{
+	if (dyn_deque && object && dyn_deque_reserve_one(dyn_deque))
+	{
+		dyn_deque->head = (dyn_deque->head - 1) & (dyn_deque->capacity - 1);
+		dyn_deque->size++;
+		memcpy(DYN_DEQUE_SLOT(dyn_deque, 0), object, dyn_deque->data_size);
+		return true;
+	}
+	return false;
+}
+
+bool dyn_deque_extract_front(dyn_deque_t *const dyn_deque, void *const object)
+{
+	if (dyn_deque && object && dyn_deque->size)
+	{
+		memcpy(object, DYN_DEQUE_SLOT(dyn_deque, 0), dyn_deque->data_size);
+		dyn_deque->head = (dyn_deque->head + 1) & (dyn_deque->capacity - 1);
+		dyn_deque->size--;
+		return true;
+	}
+	return false;
+}
+
+bool dyn_deque_pop_front(dyn_deque_t *const dyn_deque)
+{
+	if (dyn_deque && dyn_deque->size)
+	{
+		if (dyn_deque->destructor)
+		{
+			dyn_deque->destructor(DYN_DEQUE_SLOT(dyn_deque, 0));
+		}
+		dyn_deque->head = (dyn_deque->head + 1) & (dyn_deque->capacity - 1);
+		dyn_deque->size--;
+		return true;
+	}
+	return false;
+}
+
+void *dyn_deque_back(const dyn_deque_t *const dyn_deque)
+{
+	return dyn_deque && dyn_deque->size ? dyn_deque_at(dyn_deque, dyn_deque->size - 1) : NULL;
+}
+
+bool dyn_deque_push_back(dyn_deque_t *const dyn_deque, const void *const object)
+{
+	if (dyn_deque && object && dyn_deque_reserve_one(dyn_deque))
+	{
+		memcpy(DYN_DEQUE_SLOT(dyn_deque, dyn_deque->size), object, dyn_deque->data_size);
+		dyn_deque->size++;
+		return true;
+	}
+	return false;
+}
+
+bool dyn_deque_extract_back(dyn_deque_t *const dyn_deque, void *const object)
+{
+	if (dyn_deque && object && dyn_deque->size)
+	{
+		memcpy(object, DYN_DEQUE_SLOT(dyn_deque, dyn_deque->size - 1), dyn_deque->data_size);
+		dyn_deque->size--;
+		return true;
+	}
+	return false;
+}
+
+bool dyn_deque_pop_back(dyn_deque_t *const dyn_deque)
+{
+	if (dyn_deque && dyn_deque->size)
+	{
+		if (dyn_deque->destructor)
+		{
+			dyn_deque->destructor(DYN_DEQUE_SLOT(dyn_deque, dyn_deque->size - 1));
+		}
+		dyn_deque->size--;
+		return true;
+	}
+	return false;
+}
+
+void *dyn_deque_at(const dyn_deque_t *const dyn_deque, const size_t index)
+{
+	if (dyn_deque && index < dyn_deque->size)
+	{
+		return DYN_DEQUE_SLOT(dyn_deque, index);
+	}
+	return NULL;
+}
+
+void dyn_deque_clear(dyn_deque_t *const dyn_deque)
+{
+	if (dyn_deque)
+	{
+		if (dyn_deque->destructor)
+		{
+			for (size_t idx = 0; idx < dyn_deque->size; ++idx)
+			{
+				dyn_deque->destructor(DYN_DEQUE_SLOT(dyn_deque, idx));
+			}
+		}
+		dyn_deque->size = 0;
+		dyn_deque->head = 0;
+	}
+}
+
+bool dyn_deque_empty(const dyn_deque_t *const dyn_deque)
+{
+	return dyn_deque_size(dyn_deque) == 0;
+}
+
+size_t dyn_deque_size(const dyn_deque_t *const dyn_deque)
+{
+	return dyn_deque ? dyn_deque->size : 0;
+}
+
+size_t dyn_deque_capacity(const dyn_deque_t *const dyn_deque)
+{
+	return dyn_deque ? dyn_deque->capacity : 0;
+}
+
+size_t dyn_deque_data_size(const dyn_deque_t *const dyn_deque)
+{
+	return dyn_deque ? dyn_deque->data_size : 0;
+}
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "io_scheduling.h"
+#include "scheduling_internal.h"
+
+// Phases read per fread in load_io_trace
+#ifndef IO_LOAD_CHUNK
+#define IO_LOAD_CHUNK 1024
+#endif
+
+// The event loop keeps each process's pending I/O completion on a timing wheel, whose ids stop short of this
+#define IO_MAX_PROCESSES (UINT32_MAX - 2)
+
+static bool io_phase_ok(const IoTrace_t *trace, const IoPhase_t *phase)
+{
+    return !phase->io || phase->device < trace->device_count;
+}
+
+// Makes room for one more process with phase_count phases, false if the trace can't take it
+static bool io_trace_room(IoTrace_t *trace, size_t phase_count)
+{
+    size_t processes = dyn_array_size(trace->processes);
+    size_t phases = dyn_array_size(trace->phases);
+    if(!phase_count || processes >= IO_MAX_PROCESSES || phase_count > UINT32_MAX - phases) {
+        return false;
+    }
+    return dyn_array_reserve(trace->processes, processes + 1) && dyn_array_reserve(trace->phases, phases + phase_count);
+}
+
+IoTrace_t *io_trace_create(const uint32_t device_count)
+{
+    IoTrace_t *trace = (IoTrace_t *)malloc(sizeof(IoTrace_t));
+    if(!trace) return NULL;
+    trace->processes = dyn_array_create(0, sizeof(IoProcess_t), NULL);
+    trace->phases = dyn_array_create(0, sizeof(IoPhase_t), NULL);
+    trace->device_count = device_count;
+    if(!trace->processes || !trace->phases) {
+        io_trace_destroy(trace);
+        return NULL;
+    }
+    return trace;
+}
+
+void io_trace_destroy(IoTrace_t *const trace)
+{
+    if(trace) {
+        dyn_array_destroy(trace->processes);
+        dyn_array_destroy(trace->phases);
+        free(trace);
+    }
+}
+
+bool io_trace_add(IoTrace_t *const trace, const uint32_t arrival, const uint32_t priority, const IoPhase_t *const phases,
+                  const size_t phase_count)
+{
+    if(!trace || !phases) return false;
+    for(size_t i = 0; i < phase_count; i++) {
+        if(!io_phase_ok(trace, &phases[i])) return false;
+    }
+    if(!io_trace_room(trace, phase_count)) return false;
+
+    // both arrays have the room now, so neither push can fail
+    IoProcess_t process = {arrival, priority, (uint32_t)dyn_array_size(trace->phases), (uint32_t)phase_count};
+    return dyn_array_push_back_n(trace->phases, phases, phase_count) && dyn_array_push_back(trace->processes, &process);
+}
+
+IoTrace_t *io_trace_from_pcbs(const dyn_array_t *const pcbs)
+{
+    if(!pcbs || dyn_array_data_size(pcbs) != sizeof(ProcessControlBlock_t)) return NULL;
+    IoTrace_t *trace = io_trace_create(0);
+    size_t n = dyn_array_size(pcbs);
+    if(!trace || n > IO_MAX_PROCESSES || !dyn_array_reserve(trace->processes, n) || !dyn_array_reserve(trace->phases, n)) {
+        io_trace_destroy(trace);
+        return NULL;
+    }
+    const ProcessControlBlock_t *pcb = (const ProcessControlBlock_t *)dyn_array_contents(pcbs);
+    for(size_t i = 0; i < n; i++) {
+        IoPhase_t phase = {pcb[i].remaining_burst_time, 0, 0};
+        IoProcess_t process = {pcb[i].arrival, pcb[i].priority, (uint32_t)i, 1};
+        dyn_array_push_back(trace->phases, &phase);         // both reserved above
+        dyn_array_push_back(trace->processes, &process);
+    }
+    return trace;
+}
+
+// Reads one process record and its phases onto the end of the trace
+static bool io_load_process(FILE *fp, IoTrace_t *trace)
+{
+    uint32_t header[3];     // arrival, priority, phase count
+    if(fread(header, sizeof(uint32_t), 3, fp) != 3 || !io_trace_room(trace, header[2])) {
+        return false;
+    }
+    IoProcess_t process = {header[0], header[1], (uint32_t)dyn_array_size(trace->phases), header[2]};
+
+    uint32_t raw[IO_LOAD_CHUNK][3];
+    IoPhase_t chunk[IO_LOAD_CHUNK];
+    for(uint32_t loaded = 0; loaded < process.phase_count; ) {
+        size_t want = process.phase_count - loaded < IO_LOAD_CHUNK ? process.phase_count - loaded : IO_LOAD_CHUNK;
+        if(fread(raw, sizeof(raw[0]), want, fp) != want) {
+            return false;
+        }
+        for(size_t i = 0; i < want; i++) {
+            chunk[i].cpu = raw[i][0];
+            chunk[i].io = raw[i][1];
+            chunk[i].device = raw[i][2];
+            if(!io_phase_ok(trace, &chunk[i])) return false;
+        }
+        dyn_array_push_back_n(trace->phases, chunk, want);  // reserved by io_trace_room
+        loaded += (uint32_t)want;
+    }
+    return dyn_array_push_back(trace->processes, &process);
+}
+
+IoTrace_t *load_io_trace(const char *input_file)
+{
+    if(!input_file) return NULL;
+
+    FILE *fp = fopen(input_file, "rb");
+    if(!fp) return NULL;
+
+    uint32_t header[2];     // device count, process count
+    IoTrace_t *trace = NULL;
+    if(fread(header, sizeof(uint32_t), 2, fp) == 2) {
+        trace = io_trace_create(header[0]);
+    }
+    for(uint32_t i = 0; trace && i < header[1]; i++) {
+        if(!io_load_process(fp, trace)) {
+            io_trace_destroy(trace);
+            trace = NULL;
+        }
+    }
+    fclose(fp);
+    return trace;
+}
+
+// A trace schedule_io can run: well formed arrays, every process's phases inside them, every device valid
+static bool io_trace_check(const IoTrace_t *trace)
+{
+    if(!trace || !trace->processes || !trace->phases
+       || dyn_array_data_size(trace->processes) != sizeof(IoProcess_t)
+       || dyn_array_data_size(trace->phases) != sizeof(IoPhase_t)) {
+        return false;
+    }
+    size_t n = dyn_array_size(trace->processes);
+    size_t phase_total = dyn_array_size(trace->phases);
+    if(!n || n > IO_MAX_PROCESSES) return false;
+
+    const IoProcess_t *processes = (const IoProcess_t *)dyn_array_contents(trace->processes);
+    const IoPhase_t *phases = (const IoPhase_t *)dyn_array_contents(trace->phases);
+    // ready queue ranks are 32 bit and every phase can take one, so processes may share phases
+    // but not run through more than 2^32 of them altogether
+    uint64_t phases_run = 0;
+    for(size_t i = 0; i < n; i++) {
+        if(!processes[i].phase_count || processes[i].first_phase > phase_total
+           || processes[i].phase_count > phase_total - processes[i].first_phase) {
+            return false;
+        }
+        phases_run += processes[i].phase_count;
+    }
+    if(phases_run > UINT32_MAX) return false;
+    for(size_t i = 0; i < phase_total; i++) {
+        if(!io_phase_ok(trace, &phases[i])) return false;
+    }
+    return true;
+}
+
+bool schedule_io(const IoTrace_t *const trace, const IO_POLICY policy, const size_t quantum, IoScheduleResult_t *result)
+{
+    if(!result || !io_trace_check(trace) || (policy == IO_POLICY_RR && !quantum)) {
+        return false;
+    }
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = sched_engine_run_io(trace, policy, quantum, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+
+#include "pcb_view.h"
+#include "scheduling_internal.h"
+
+// One block of the arrival-ordered trace, handled by one worker
+typedef struct
+{
+    size_t begin;              // first position in arrival order
+    size_t end;                // one past the last position
+    sched_time_t work;         // total burst + overhead of the block
+    sched_time_t from_zero;    // completion time of the block when started at time 0
+    sched_time_t start;        // completion time of everything before the block
+    sched_time_t finish;       // completion time of the block's last PCB
+    schedule_totals_t totals;  // metrics of the block's PCBs
+} fcfs_block_t;
+
+typedef struct
+{
+    const ProcessControlBlock_t *pcbs;
+    const uint32_t *by_arrival;
+    fcfs_block_t *blocks;
+    ScheduleOverhead_t costs;
+    bool replay;               // false for pass one, true for pass two
+} fcfs_scan_t;
+
+// Overhead paid before the PCB at arrival position `position` runs.
+// Consecutive FCFS PCBs are always different processes, so everyone but the first pays a switch.
+static sched_time_t fcfs_cost(const ScheduleOverhead_t *costs, size_t position)
+{
+    return (sched_time_t)costs->dispatch_cost + (position ? costs->context_switch_cost : 0);
+}
+
+static void fcfs_scan_block(void *context, size_t worker)
+{
+    fcfs_scan_t *scan = (fcfs_scan_t *)context;
+    fcfs_block_t *block = &scan->blocks[worker];
+    sched_time_t current_time = scan->replay ? block->start : 0;
+    sched_time_t work = 0;
+
+    for(size_t i = block->begin; i < block->end; i++) {
+        const ProcessControlBlock_t *pcb = &scan->pcbs[scan->by_arrival[i]];
+        sched_time_t cost = fcfs_cost(&scan->costs, i);
+        if(current_time < pcb->arrival) {
+            if(scan->replay) SCHED_STAT_CLOCK(pcb->arrival - current_time);
+            current_time = pcb->arrival;
+        }
+        current_time += cost + pcb->remaining_burst_time;
+        if(scan->replay) {
+            totals_record(&block->totals, pcb->arrival, pcb->remaining_burst_time, current_time);
+            block->totals.switches += i ? 1 : 0;
+            block->totals.overhead += cost;
+            SCHED_STAT_ADD(pcbs_scanned, 1);
+            SCHED_STAT_ADD(dispatches, 1);
+            SCHED_STAT_ADD(context_switches, i ? 1 : 0);
+            SCHED_STAT_CLOCK(pcb->remaining_burst_time);
+        }
+        else {
+            work += cost + pcb->remaining_burst_time;
+        }
+    }
+
+    if(scan->replay) {
+        block->finish = current_time;
+    }
+    else {
+        block->work = work;
+        block->from_zero = current_time;
+    }
+}
+
+bool first_come_first_serve_parallel_view(pcb_view_t *view, ScheduleResult_t *result, size_t nthreads)
+{
+    if(!view || !result) return false;
+    size_t n = pcb_view_size(view);
+    if(n == 0) return false;
+
+    const uint32_t *by_arrival = pcb_view_order(view, PCB_ORDER_ARRIVAL);
+    if(!by_arrival) return false;
+
+    size_t workers = sched_resolve_threads(nthreads);
+    if(workers > n) {
+        workers = n;
+    }
+    fcfs_block_t *blocks = (fcfs_block_t *)SCHED_CALLOC(workers, sizeof(fcfs_block_t));
+    if(!blocks) return false;
+
+    fcfs_scan_t scan = { pcb_view_pcbs(view), by_arrival, blocks, get_schedule_overhead(), false };
+    for(size_t worker = 0; worker < workers; worker++) {
+        blocks[worker].begin = n / workers * worker + (worker < n % workers ? worker : n % workers);
+        blocks[worker].end = blocks[worker].begin + n / workers + (worker < n % workers ? 1 : 0);
+        totals_init(&blocks[worker].totals);
+    }
+
+    // pass one: each block as a function of its start time, max(start + work, from_zero)
+    sched_run_workers(workers, fcfs_scan_block, &scan);
+
+    // chain the blocks (from_zero covers the start at 0, so max() with it is exact for any start >= 0)
+    sched_time_t current_time = 0;
+    for(size_t worker = 0; worker < workers; worker++) {
+        blocks[worker].start = current_time;
+        current_time += blocks[worker].work;
+        if(current_time < blocks[worker].from_zero) {
+            current_time = blocks[worker].from_zero;
+        }
+    }
+
+    // pass two: replay every block from its real start time and collect the metrics
+    scan.replay = true;
+    sched_run_workers(workers, fcfs_scan_block, &scan);
+
+    schedule_totals_t totals;
+    totals_init(&totals);
+    for(size_t worker = 0; worker < workers; worker++) {
+        totals_merge(&totals, &blocks[worker].totals);
+    }
+    totals_finish(&totals, blocks[workers - 1].finish, result);
+
+    free(blocks);
+    return true;
+}
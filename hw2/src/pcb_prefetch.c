@@ -0,0 +1,452 @@
+// syscall() for io_uring, pread()
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pcb_prefetch.h"
+#include "scheduling_internal.h"
+
+// define PCB_PREFETCH_NO_URING to always read with pread
+#if defined(__linux__) && defined(__has_include) && !defined(PCB_PREFETCH_NO_URING)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define PCB_PREFETCH_URING 1
+#endif
+#endif
+#endif
+
+// Records per read: one chunk is converted while the read of the next one is in flight
+#ifndef PCB_PREFETCH_CHUNK
+#define PCB_PREFETCH_CHUNK 65536
+#endif
+
+typedef uint32_t pcb_record_t[3];   // burst, priority, arrival as stored in the file
+
+#ifdef PCB_PREFETCH_URING
+// A submission/completion ring pair, set up with raw syscalls (liburing isn't a dependency).
+// One read in flight at a time is all the loader needs.
+typedef struct
+{
+    int fd;
+    unsigned *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_bytes, cq_ring_bytes, sqe_bytes;
+} prefetch_ring_t;
+#endif
+
+typedef struct
+{
+    const char *path;
+    dyn_array_t *pcbs;              // NULL if the file couldn't be loaded
+    double load_seconds;
+} prefetch_entry_t;
+
+struct pcb_prefetch
+{
+    const char *(*next_file)(void *context);
+    void *context;
+    size_t depth;
+
+    pthread_mutex_t lock;
+    pthread_cond_t loaded;          // an entry was added, or the thread is done
+    pthread_cond_t taken;           // an entry was taken, or the caller wants the thread to stop
+    prefetch_entry_t *entries;      // ring of depth loaded files
+    size_t first, count;
+    dyn_array_t **spare;            // recycled arrays, up to depth + 1
+    size_t spare_count;
+    bool done;                      // the thread has loaded its last file
+    bool stopping;
+    bool threaded;                  // false: no thread could be started, files load in pcb_prefetch_next
+
+    pthread_t thread;
+    pcb_record_t *raw[2];           // the loader's double buffered chunks
+#ifdef PCB_PREFETCH_URING
+    prefetch_ring_t ring;
+    bool uring;                     // ring is set up and reads work on it
+    bool reading;                   // a read is in flight on it
+#endif
+};
+
+static double prefetch_seconds_since(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+#ifdef PCB_PREFETCH_URING
+static void ring_teardown(prefetch_ring_t *ring)
+{
+    if(ring->sqes) munmap(ring->sqes, ring->sqe_bytes);
+    if(ring->cq_ring && ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_bytes);
+    if(ring->sq_ring) munmap(ring->sq_ring, ring->sq_ring_bytes);
+    if(ring->fd >= 0) close(ring->fd);
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+static bool ring_setup(prefetch_ring_t *ring)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = (int)syscall(__NR_io_uring_setup, 2, &params);
+    if(ring->fd < 0) return false;
+
+    ring->sq_ring_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_bytes = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if(single && ring->cq_ring_bytes > ring->sq_ring_bytes) ring->sq_ring_bytes = ring->cq_ring_bytes;
+    ring->sqe_bytes = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    void *sq = mmap(NULL, ring->sq_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, IORING_OFF_SQ_RING);
+    ring->sq_ring = sq == MAP_FAILED ? NULL : sq;
+    void *cq = single ? sq : mmap(NULL, ring->cq_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, IORING_OFF_CQ_RING);
+    ring->cq_ring = cq == MAP_FAILED ? NULL : cq;
+    void *sqes = mmap(NULL, ring->sqe_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, IORING_OFF_SQES);
+    ring->sqes = sqes == MAP_FAILED ? NULL : (struct io_uring_sqe *)sqes;
+    if(!ring->sq_ring || !ring->cq_ring || !ring->sqes) {
+        ring_teardown(ring);
+        return false;
+    }
+
+    char *sq_base = (char *)ring->sq_ring, *cq_base = (char *)ring->cq_ring;
+    ring->sq_tail = (unsigned *)(sq_base + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq_base + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq_base + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq_base + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq_base + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq_base + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq_base + params.cq_off.cqes);
+    return true;
+}
+
+static bool ring_submit_read(prefetch_ring_t *ring, int fd, void *buffer, size_t bytes, off_t offset)
+{
+    unsigned tail = *ring->sq_tail;     // only this thread submits
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buffer;
+    sqe->len = (uint32_t)bytes;
+    sqe->off = (uint64_t)offset;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    while(syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0) < 0) {
+        if(errno != EINTR) {
+            __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);   // the kernel never took it
+            return false;
+        }
+    }
+    return true;
+}
+
+// Waits for the read in flight, returns its result (bytes read or -errno)
+static int ring_wait(prefetch_ring_t *ring)
+{
+    for(;;) {
+        unsigned head = *ring->cq_head;
+        if(head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+            int result = ring->cqes[head & *ring->cq_mask].res;
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+            return result;
+        }
+        if(syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR) {
+            return -errno;
+        }
+    }
+}
+#endif
+
+// Reads exactly bytes at offset with pread, false on an error or the end of the file
+static bool prefetch_pread(int fd, char *buffer, size_t bytes, off_t offset)
+{
+    while(bytes) {
+        ssize_t got = pread(fd, buffer, bytes, offset);
+        if(got < 0 && errno == EINTR) continue;
+        if(got <= 0) return false;
+        buffer += got;
+        bytes -= (size_t)got;
+        offset += got;
+    }
+    return true;
+}
+
+// Starts reading bytes at offset into buffer on the ring, if there is one (pread does it all in prefetch_finish)
+static void prefetch_start(pcb_prefetch_t *prefetch, int fd, void *buffer, size_t bytes, off_t offset)
+{
+#ifdef PCB_PREFETCH_URING
+    prefetch->reading = prefetch->uring && ring_submit_read(&prefetch->ring, fd, buffer, bytes, offset);
+    prefetch->uring = prefetch->reading;
+#else
+    (void)prefetch, (void)fd, (void)buffer, (void)bytes, (void)offset;
+#endif
+}
+
+// Completes the read prefetch_start began: all of it, or false
+static bool prefetch_finish(pcb_prefetch_t *prefetch, int fd, void *buffer, size_t bytes, off_t offset)
+{
+#ifdef PCB_PREFETCH_URING
+    if(prefetch->reading) {
+        prefetch->reading = false;
+        int got = ring_wait(&prefetch->ring);
+        if(got == -EINVAL || got == -EOPNOTSUPP) {
+            prefetch->uring = false;    // kernel without IORING_OP_READ, pread from now on
+            got = 0;
+        }
+        else if(got <= 0) {
+            return false;
+        }
+        // the rest of a short read is just read directly
+        return prefetch_pread(fd, (char *)buffer + got, bytes - (size_t)got, offset + got);
+    }
+#endif
+    return prefetch_pread(fd, (char *)buffer, bytes, offset);
+}
+
+// Loads a PCB file into *pcbs (cleared, or created if NULL), the same PCBs load_process_control_blocks gives
+static bool prefetch_load(pcb_prefetch_t *prefetch, const char *path, dyn_array_t **pcbs)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return false;
+    uint32_t n = 0;
+    bool ok = prefetch_pread(fd, (char *)&n, sizeof(n), 0);
+    if(ok && !*pcbs) {
+        const dyn_allocator_t allocator = dyn_allocator_system(DYN_ALLOC_ALIGNED | DYN_ALLOC_HUGE);
+        *pcbs = dyn_array_create_with(n, sizeof(ProcessControlBlock_t), NULL, &allocator);
+        ok = *pcbs != NULL;
+    }
+    else if(ok) {
+        dyn_array_clear(*pcbs);
+        dyn_array_mark_unsorted(*pcbs);
+        ok = dyn_array_reserve(*pcbs, n);
+    }
+
+    // read chunk k + 1 while chunk k is converted
+    off_t offset = sizeof(uint32_t);
+    size_t want = n < PCB_PREFETCH_CHUNK ? n : PCB_PREFETCH_CHUNK;
+    if(ok && want) {
+        prefetch_start(prefetch, fd, prefetch->raw[0], want * sizeof(pcb_record_t), offset);
+    }
+    ProcessControlBlock_t converted[256];
+    for(uint32_t loaded = 0, chunk = 0; ok && loaded < n; chunk ^= 1) {
+        size_t bytes = want * sizeof(pcb_record_t);
+        if(!prefetch_finish(prefetch, fd, prefetch->raw[chunk], bytes, offset)) {
+            ok = false;
+            break;
+        }
+        const pcb_record_t *raw = prefetch->raw[chunk];
+        size_t have = want;
+        offset += (off_t)bytes;
+        loaded += (uint32_t)have;
+        want = n - loaded < PCB_PREFETCH_CHUNK ? n - loaded : PCB_PREFETCH_CHUNK;
+        if(want) {
+            prefetch_start(prefetch, fd, prefetch->raw[chunk ^ 1], want * sizeof(pcb_record_t), offset);
+        }
+
+        for(size_t done = 0; ok && done < have; ) {
+            size_t batch = have - done < 256 ? have - done : 256;
+            for(size_t i = 0; i < batch; i++) {
+                converted[i].remaining_burst_time = raw[done + i][0];
+                converted[i].priority = raw[done + i][1];
+                converted[i].arrival = raw[done + i][2];
+                converted[i].started = false;
+            }
+            ok = dyn_array_push_back_n(*pcbs, converted, batch);
+            done += batch;
+        }
+    }
+#ifdef PCB_PREFETCH_URING
+    if(prefetch->reading) {
+        // gave up with a read in flight, the kernel may still be writing into the chunk buffer
+        ring_wait(&prefetch->ring);
+        prefetch->reading = false;
+    }
+#endif
+    close(fd);
+    return ok;
+}
+
+// Takes a spare array to load into, NULL if there is none (call with the lock held)
+static dyn_array_t *prefetch_take_spare(pcb_prefetch_t *prefetch)
+{
+    return prefetch->spare_count ? prefetch->spare[--prefetch->spare_count] : NULL;
+}
+
+// Claims and loads the next file into entry, false once there are no more
+static bool prefetch_one(pcb_prefetch_t *prefetch, dyn_array_t *spare, prefetch_entry_t *entry)
+{
+    entry->path = prefetch->next_file(prefetch->context);
+    if(!entry->path) {
+        dyn_array_destroy(spare);
+        return false;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    entry->pcbs = spare;
+    if(!prefetch_load(prefetch, entry->path, &entry->pcbs)) {
+        dyn_array_destroy(entry->pcbs);
+        entry->pcbs = NULL;
+    }
+    entry->load_seconds = prefetch_seconds_since(&start);
+    return true;
+}
+
+static void *prefetch_thread(void *arg)
+{
+    pcb_prefetch_t *prefetch = (pcb_prefetch_t *)arg;
+    for(;;) {
+        pthread_mutex_lock(&prefetch->lock);
+        while(prefetch->count == prefetch->depth && !prefetch->stopping) {
+            pthread_cond_wait(&prefetch->taken, &prefetch->lock);
+        }
+        bool stopping = prefetch->stopping;
+        dyn_array_t *spare = stopping ? NULL : prefetch_take_spare(prefetch);
+        pthread_mutex_unlock(&prefetch->lock);
+
+        prefetch_entry_t entry;
+        bool more = !stopping && prefetch_one(prefetch, spare, &entry);
+
+        pthread_mutex_lock(&prefetch->lock);
+        if(more) {
+            prefetch->entries[(prefetch->first + prefetch->count++) % prefetch->depth] = entry;
+        }
+        else {
+            prefetch->done = true;
+        }
+        pthread_cond_signal(&prefetch->loaded);
+        pthread_mutex_unlock(&prefetch->lock);
+        if(!more) return NULL;
+    }
+}
+
+pcb_prefetch_t *pcb_prefetch_start(const char *(*next_file)(void *context), void *context, const size_t depth)
+{
+    if(!next_file || !depth) return NULL;
+    pcb_prefetch_t *prefetch = (pcb_prefetch_t *)SCHED_CALLOC(1, sizeof(pcb_prefetch_t));
+    if(!prefetch) return NULL;
+    prefetch->next_file = next_file;
+    prefetch->context = context;
+    prefetch->depth = depth;
+    prefetch->entries = (prefetch_entry_t *)SCHED_MALLOC(depth * sizeof(prefetch_entry_t));
+    prefetch->spare = (dyn_array_t **)SCHED_MALLOC((depth + 1) * sizeof(dyn_array_t *));
+    prefetch->raw[0] = (pcb_record_t *)SCHED_MALLOC(2 * PCB_PREFETCH_CHUNK * sizeof(pcb_record_t));
+    prefetch->raw[1] = prefetch->raw[0] ? prefetch->raw[0] + PCB_PREFETCH_CHUNK : NULL;
+    if(!prefetch->entries || !prefetch->spare || !prefetch->raw[0]) {
+        free(prefetch->entries);
+        free(prefetch->spare);
+        free(prefetch->raw[0]);
+        free(prefetch);
+        return NULL;
+    }
+#ifdef PCB_PREFETCH_URING
+    prefetch->uring = ring_setup(&prefetch->ring);
+#endif
+    pthread_mutex_init(&prefetch->lock, NULL);
+    pthread_cond_init(&prefetch->loaded, NULL);
+    pthread_cond_init(&prefetch->taken, NULL);
+    prefetch->threaded = pthread_create(&prefetch->thread, NULL, prefetch_thread, prefetch) == 0;
+    return prefetch;
+}
+
+dyn_array_t *pcb_prefetch_next(pcb_prefetch_t *const prefetch, const char **path, double *load_seconds)
+{
+    if(!prefetch || !path) return NULL;
+    prefetch_entry_t entry = { NULL, NULL, 0.0 };
+    pthread_mutex_lock(&prefetch->lock);
+    if(!prefetch->threaded) {
+        // no background thread: load it here, still into a recycled array
+        dyn_array_t *spare = prefetch_take_spare(prefetch);
+        pthread_mutex_unlock(&prefetch->lock);
+        if(prefetch->done || !prefetch_one(prefetch, spare, &entry)) {
+            prefetch->done = true;
+        }
+    }
+    else {
+        while(!prefetch->count && !prefetch->done) {
+            pthread_cond_wait(&prefetch->loaded, &prefetch->lock);
+        }
+        if(prefetch->count) {
+            entry = prefetch->entries[prefetch->first];
+            prefetch->first = (prefetch->first + 1) % prefetch->depth;
+            prefetch->count--;
+            pthread_cond_signal(&prefetch->taken);
+        }
+        pthread_mutex_unlock(&prefetch->lock);
+    }
+    *path = entry.path;
+    if(load_seconds) {
+        *load_seconds = entry.load_seconds;
+    }
+    return entry.pcbs;
+}
+
+void pcb_prefetch_recycle(pcb_prefetch_t *const prefetch, dyn_array_t *const pcbs)
+{
+    if(!prefetch || !pcbs) return;
+    pthread_mutex_lock(&prefetch->lock);
+    bool kept = prefetch->spare_count < prefetch->depth + 1;
+    if(kept) {
+        prefetch->spare[prefetch->spare_count++] = pcbs;
+    }
+    pthread_mutex_unlock(&prefetch->lock);
+    if(!kept) {
+        dyn_array_destroy(pcbs);
+    }
+}
+
+void pcb_prefetch_destroy(pcb_prefetch_t *const prefetch)
+{
+    if(!prefetch) return;
+    if(prefetch->threaded) {
+        pthread_mutex_lock(&prefetch->lock);
+        prefetch->stopping = true;
+        pthread_cond_signal(&prefetch->taken);
+        pthread_mutex_unlock(&prefetch->lock);
+        pthread_join(prefetch->thread, NULL);
+    }
+    for(size_t i = 0; i < prefetch->count; i++) {
+        dyn_array_destroy(prefetch->entries[(prefetch->first + i) % prefetch->depth].pcbs);
+    }
+    for(size_t i = 0; i < prefetch->spare_count; i++) {
+        dyn_array_destroy(prefetch->spare[i]);
+    }
+#ifdef PCB_PREFETCH_URING
+    if(prefetch->ring.fd >= 0) {
+        ring_teardown(&prefetch->ring);
+    }
+#endif
+    pthread_cond_destroy(&prefetch->taken);
+    pthread_cond_destroy(&prefetch->loaded);
+    pthread_mutex_destroy(&prefetch->lock);
+    free(prefetch->entries);
+    free(prefetch->spare);
+    free(prefetch->raw[0]);
+    free(prefetch);
+}
+
+bool pcb_prefetch_uses_uring(void)
+{
+#ifdef PCB_PREFETCH_URING
+    prefetch_ring_t ring;
+    if(ring_setup(&ring)) {
+        ring_teardown(&ring);
+        return true;
+    }
+#endif
+    return false;
+}
@@ -0,0 +1,158 @@
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pcb_queue.h"
+
+// Keeps the producers' tail and the consumer's head from sharing a cache line
+#define PCB_QUEUE_LINE 64
+
+// PCBs copied out per batch while draining
+#define PCB_QUEUE_DRAIN_CHUNK 64
+
+typedef struct
+{
+	// position + 1 once the PCB for position is published. Whether a slot is free producers tell
+	// from head instead, so nothing resets this: a slot that was published last lap reads one lap short.
+	atomic_size_t sequence;
+	ProcessControlBlock_t pcb;
+} pcb_queue_slot_t;
+
+struct pcb_queue
+{
+	_Alignas(PCB_QUEUE_LINE) atomic_size_t tail;	// next position a producer claims
+	_Alignas(PCB_QUEUE_LINE) atomic_size_t head;	// next position the consumer drains (only it writes this)
+	_Alignas(PCB_QUEUE_LINE) size_t mask;			// capacity - 1
+	pcb_queue_slot_t *slots;
+};
+
+pcb_queue_t *pcb_queue_create(const size_t capacity)
+{
+	if (!capacity || capacity > SIZE_MAX / 2 + 1)
+	{
+		return NULL;
+	}
+	size_t rounded = 1;
+	while (rounded < capacity)
+	{
+		rounded <<= 1;
+	}
+	if (rounded > SIZE_MAX / sizeof(pcb_queue_slot_t))
+	{
+		return NULL;
+	}
+
+	pcb_queue_t *queue = (pcb_queue_t *) aligned_alloc(PCB_QUEUE_LINE, sizeof(pcb_queue_t));
+	if (!queue)
+	{
+		return NULL;
+	}
+	queue->slots = (pcb_queue_slot_t *) malloc(rounded * sizeof(pcb_queue_slot_t));
+	if (!queue->slots)
+	{
+		free(queue);
+		return NULL;
+	}
+	for (size_t i = 0; i < rounded; ++i)
+	{
+		atomic_init(&queue->slots[i].sequence, i);
+	}
+	atomic_init(&queue->tail, 0);
+	atomic_init(&queue->head, 0);
+	queue->mask = rounded - 1;
+	return queue;
+}
+
+void pcb_queue_destroy(pcb_queue_t *const queue)
+{
+	if (queue)
+	{
+		free(queue->slots);
+		free(queue);
+	}
+}
+
+size_t pcb_queue_capacity(const pcb_queue_t *const queue)
+{
+	return queue ? queue->mask + 1 : 0;
+}
+
+bool pcb_queue_push(pcb_queue_t *const queue, const ProcessControlBlock_t *const pcb)
+{
+	return pcb_queue_push_n(queue, pcb, 1) == 1;
+}
+
+size_t pcb_queue_push_n(pcb_queue_t *const queue, const ProcessControlBlock_t *const pcbs, const size_t count)
+{
+	if (!queue || !pcbs || !count)
+	{
+		return 0;
+	}
+	const size_t capacity = queue->mask + 1;
+	size_t position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	size_t claimed;
+	for (;;)
+	{
+		// The consumer moves head only once it has copied out the slots before it, so the ones up to
+		// head + capacity are free. A stale position can make this look bigger
+		// than it is, but then the swap below fails.
+		const size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+		const size_t room = head + capacity - position;
+		if (!room)
+		{
+			return 0;
+		}
+		claimed = count < room ? count : room;
+		if (atomic_compare_exchange_weak_explicit(&queue->tail, &position, position + claimed,
+				memory_order_relaxed, memory_order_relaxed))
+		{
+			break;
+		}
+	}
+	for (size_t i = 0; i < claimed; ++i)
+	{
+		pcb_queue_slot_t *const slot = &queue->slots[(position + i) & queue->mask];
+		slot->pcb = pcbs[i];
+		atomic_store_explicit(&slot->sequence, position + i + 1, memory_order_release);
+	}
+	return claimed;
+}
+
+size_t pcb_queue_drain(pcb_queue_t *const queue, dyn_array_t *const into, const size_t max)
+{
+	if (!queue || !into || dyn_array_data_size(into) != sizeof(ProcessControlBlock_t))
+	{
+		return 0;
+	}
+	size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	size_t drained = 0;
+	ProcessControlBlock_t chunk[PCB_QUEUE_DRAIN_CHUNK];
+	while (drained < max)
+	{
+		// copy out a run of published PCBs, append them, and only then give their slots back
+		size_t want = max - drained < PCB_QUEUE_DRAIN_CHUNK ? max - drained : PCB_QUEUE_DRAIN_CHUNK;
+		size_t got = 0;
+		for (; got < want; ++got)
+		{
+			pcb_queue_slot_t *const slot = &queue->slots[(head + got) & queue->mask];
+			if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != head + got + 1)
+			{
+				break;
+			}
+			chunk[got] = slot->pcb;
+		}
+		if (!got || !dyn_array_push_back_n(into, chunk, got))
+		{
+			break;
+		}
+		head += got;
+		drained += got;
+		// hands the slots back: producers read head before they claim and write a slot
+		atomic_store_explicit(&queue->head, head, memory_order_release);
+		if (got < want)
+		{
+			break;
+		}
+	}
+	return drained;
+}
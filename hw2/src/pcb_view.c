@@ -0,0 +1,212 @@
+#include "pcb_view.h"
+#include "scheduling_internal.h"
+
+struct pcb_view
+{
+	const ProcessControlBlock_t *pcbs;
+	size_t size;
+	size_t sort_threads;
+	bool arrival_sorted;					 // the array said it's sorted by arrival, so that order is the identity
+	bool cached[PCB_ORDER_COUNT];			 // orders[order] is valid for the current PCBs
+	uint32_t *orders[PCB_ORDER_COUNT];		 // NULL until asked for, kept across rebinds
+	size_t order_capacity[PCB_ORDER_COUNT];	 // indexes orders[order] has room for
+	uint64_t *packed;						 // sort scratch for single threaded sorts, kept across rebinds
+	size_t packed_capacity;
+};
+
+// Views can only cover arrays of PCBs that fit 32 bit indexes
+static bool pcb_view_accepts(const dyn_array_t *const pcbs)
+{
+	return pcbs && dyn_array_data_size(pcbs) == sizeof(ProcessControlBlock_t) && dyn_array_size(pcbs) <= UINT32_MAX;
+}
+
+pcb_view_t *pcb_view_create(const dyn_array_t *const pcbs)
+{
+	if (pcb_view_accepts(pcbs))
+	{
+		pcb_view_t *view = (pcb_view_t *) SCHED_CALLOC(1, sizeof(pcb_view_t));
+		if (view)
+		{
+			view->pcbs = (const ProcessControlBlock_t *) dyn_array_contents(pcbs);
+			view->size = dyn_array_size(pcbs);
+			view->sort_threads = 1;
+			view->arrival_sorted = dyn_array_is_sorted(pcbs, pcb_arrival_cmp);
+			return view;
+		}
+	}
+	return NULL;
+}
+
+bool pcb_view_rebind(pcb_view_t *const view, const dyn_array_t *const pcbs)
+{
+	if (!view || !pcb_view_accepts(pcbs))
+	{
+		return false;
+	}
+	view->pcbs = (const ProcessControlBlock_t *) dyn_array_contents(pcbs);
+	view->size = dyn_array_size(pcbs);
+	view->arrival_sorted = dyn_array_is_sorted(pcbs, pcb_arrival_cmp);
+	memset(view->cached, 0, sizeof(view->cached));
+	return true;
+}
+
+void pcb_view_destroy(pcb_view_t *const view)
+{
+	if (view)
+	{
+		for (int order = 0; order < PCB_ORDER_COUNT; ++order)
+		{
+			free(view->orders[order]);
+		}
+		free(view->packed);
+		free(view);
+	}
+}
+
+size_t pcb_view_size(const pcb_view_t *const view)
+{
+	return view ? view->size : 0;
+}
+
+const ProcessControlBlock_t *pcb_view_pcbs(const pcb_view_t *const view)
+{
+	return view ? view->pcbs : NULL;
+}
+
+void pcb_view_set_sort_threads(pcb_view_t *const view, const size_t nthreads)
+{
+	if (view)
+	{
+		view->sort_threads = nthreads;
+	}
+}
+
+// Sort key for a PCB under an order
+static uint32_t pcb_order_key(const ProcessControlBlock_t *const pcb, const PCB_ORDER order)
+{
+	switch (order)
+	{
+		case PCB_ORDER_ARRIVAL:
+			return pcb->arrival;
+		case PCB_ORDER_BURST:
+			return pcb->remaining_burst_time;
+		default:
+			return pcb->priority;
+	}
+}
+
+// Keys are packed as (key << 32 | index), so they are unique and sorting them is stable
+static int packed_key_cmp(const void *a, const void *b)
+{
+	const uint64_t ka = *(const uint64_t *) a;
+	const uint64_t kb = *(const uint64_t *) b;
+	return (ka > kb) - (ka < kb);
+}
+
+// The in-place sort bypasses dyn_array, so it counts its own comparisons
+static int packed_key_cmp_counted(const void *a, const void *b)
+{
+	SCHED_STAT_ADD(comparisons, 1);
+	return packed_key_cmp(a, b);
+}
+
+// Returns a buffer with room for at least count objects, reallocating (without keeping the contents) if
+// the current one is too small. NULL if that fails, the old buffer is gone either way.
+static void *pcb_view_grow(void *buffer, size_t *capacity, const size_t count, const size_t size)
+{
+	if (buffer && *capacity >= count)
+	{
+		return buffer;
+	}
+	free(buffer);
+	void *grown = SCHED_MALLOC(count * size);
+	*capacity = grown ? count : 0;
+	return grown;
+}
+
+bool pcb_view_prepare(pcb_view_t *const view, const PCB_ORDER order)
+{
+	if (!view || (unsigned) order >= PCB_ORDER_COUNT)
+	{
+		return false;
+	}
+	if (view->cached[order] || !view->size)
+	{
+		return true;
+	}
+
+	// storage is kept from earlier traces when it is big enough
+	view->orders[order] = (uint32_t *) pcb_view_grow(view->orders[order], &view->order_capacity[order], view->size,
+													  sizeof(uint32_t));
+	uint32_t *permutation = view->orders[order];
+	if (!permutation)
+	{
+		return false;
+	}
+
+	// Already in order? Then the identity is the answer and there's nothing to sort
+	// (no need to look if the array already knows it's in arrival order)
+	bool sorted = true;
+	const bool known = order == PCB_ORDER_ARRIVAL && view->arrival_sorted;
+	for (size_t idx = 0; idx < view->size; ++idx)
+	{
+		permutation[idx] = (uint32_t) idx;
+		sorted = known || (sorted && (idx == 0 || pcb_order_key(&view->pcbs[idx - 1], order) <= pcb_order_key(&view->pcbs[idx], order)));
+	}
+
+	if (!sorted && (view->sort_threads == 1 || view->size < PCB_VIEW_PARALLEL_SORT_THRESHOLD))
+	{
+		// small enough for one thread: sort in the view's own scratch, nothing to allocate once it has grown
+		view->packed = (uint64_t *) pcb_view_grow(view->packed, &view->packed_capacity, view->size, sizeof(uint64_t));
+		if (!view->packed)
+		{
+			return false;
+		}
+		for (size_t idx = 0; idx < view->size; ++idx)
+		{
+			view->packed[idx] = ((uint64_t) pcb_order_key(&view->pcbs[idx], order) << 32) | idx;
+		}
+		qsort(view->packed, view->size, sizeof(uint64_t), packed_key_cmp_counted);
+		for (size_t idx = 0; idx < view->size; ++idx)
+		{
+			permutation[idx] = (uint32_t) view->packed[idx];
+		}
+	}
+	else if (!sorted)
+	{
+		dyn_array_t *packed = dyn_array_create(view->size, sizeof(uint64_t), NULL);
+		bool success = packed != NULL;
+		for (size_t idx = 0; success && idx < view->size; ++idx)
+		{
+			uint64_t key = ((uint64_t) pcb_order_key(&view->pcbs[idx], order) << 32) | idx;
+			success = dyn_array_push_back(packed, &key);
+		}
+		if (success)
+		{
+			success = dyn_array_sort_parallel(packed, packed_key_cmp, view->sort_threads);
+		}
+		if (!success)
+		{
+			dyn_array_destroy(packed);
+			return false;
+		}
+		const uint64_t *keys = (const uint64_t *) dyn_array_contents(packed);
+		for (size_t idx = 0; idx < view->size; ++idx)
+		{
+			permutation[idx] = (uint32_t) keys[idx];
+		}
+		dyn_array_destroy(packed);
+	}
+
+	view->cached[order] = true;
+	return true;
+}
+
+const uint32_t *pcb_view_order(pcb_view_t *const view, const PCB_ORDER order)
+{
+	if (view && view->size && pcb_view_prepare(view, order))
+	{
+		return view->orders[order];
+	}
+	return NULL;
+}
@@ -5,258 +5,178 @@
 
 #include "dyn_array.h"
 #include "processing_scheduling.h"
+#include "pcb_view.h"
+#include "sched_checkpoint.h"
+#include "sched_workspace.h"
+#include "scheduling_internal.h"
 
 
 // You might find this handy.  I put it around unused parameters, but you should
 // remove it before you submit. Just allows things to compile initially.
 #define UNUSED(x) (void)(x)
 
-static int pcb_arrival_cmp(const void *a, const void *b);
+// Overhead model shared by all schedulers, see set_schedule_overhead()
+static ScheduleOverhead_t schedule_overhead = {0, 0};
 
-// private function
-void virtual_cpu(ProcessControlBlock_t *process_control_block) 
+void set_schedule_overhead(const ScheduleOverhead_t *overhead)
 {
-	// decrement the burst time of the pcb
-	--process_control_block->remaining_burst_time;
+    if(overhead) {
+        schedule_overhead = *overhead;
+    }
+    else {
+        schedule_overhead.context_switch_cost = 0;
+        schedule_overhead.dispatch_cost = 0;
+    }
 }
 
-// Implements a queue for the processes coming in.
-bool first_come_first_serve(dyn_array_t *ready_queue, ScheduleResult_t *result) 
+ScheduleOverhead_t get_schedule_overhead(void)
 {
-    if(!ready_queue || !result) return false;
-    size_t n = dyn_array_size(ready_queue);
-    if(n == 0) return false;
-
-    // sort by arrival
-    if(!dyn_array_sort(ready_queue, pcb_arrival_cmp)) {
-        return false;
-    }
-
-    unsigned long current_time = 0;
-    float total_wait = 0.0f, total_turn = 0.0f;
-
-    for(size_t i=0; i<n; i++) {
-        ProcessControlBlock_t *pcb = (ProcessControlBlock_t*)dyn_array_at(ready_queue, i);
-        if(!pcb) return false;
+    return schedule_overhead;
+}
 
-        // if process arrives later than current_time, jump time forward
-        if(current_time < pcb->arrival) {
-            current_time = pcb->arrival;
-        }
-        // waiting time is when we actually start - arrival
-        float wait = (float)(current_time - pcb->arrival);
-        total_wait += wait;
+// Thread budget shared by all schedulers, see set_schedule_threads()
+static size_t schedule_threads = 0;
 
-        // run the process fully
-        current_time += pcb->remaining_burst_time;
+void set_schedule_threads(size_t nthreads)
+{
+    schedule_threads = nthreads;
+}
 
-        // turnaround = completion - arrival
-        float turn = (float)(current_time - pcb->arrival);
-        total_turn += turn;
-    }
+size_t get_schedule_threads(void)
+{
+    return schedule_threads;
+}
 
-    // fill out result
-    result->average_waiting_time = total_wait / (float)n;
-    result->average_turnaround_time = total_turn / (float)n;
-    result->total_run_time = current_time;
+// Per-thread hot-path counters, see get_schedule_stats()
+#ifdef SCHED_STATS
+_Thread_local ScheduleStats_t sched_stats;
+#endif
 
+bool schedule_stats_enabled(void)
+{
+#ifdef SCHED_STATS
     return true;
+#else
+    return false;
+#endif
 }
 
-bool shortest_job_first(dyn_array_t *ready_queue, ScheduleResult_t *result) 
+void reset_schedule_stats(void)
 {
-	if(!ready_queue || !result) return false;
-    size_t n = dyn_array_size(ready_queue);
-    if(n == 0) return false;
-
-    unsigned long current_time = 0;
-    float total_wait = 0.0f, total_turn = 0.0f;
-    bool completed_array[n];
-    size_t number_completed = 0;
-
-    for(size_t i = 0; i < n; i++){
-        completed_array[i] = 0;
-    }
+#ifdef SCHED_STATS
+    memset(&sched_stats, 0, sizeof(sched_stats));
+#endif
+    dyn_array_stats_reset();
+}
 
-    //sort array by arrival time
-    if(!dyn_array_sort(ready_queue, pcb_arrival_cmp)) {
-        return false;
-    }
+ScheduleStats_t get_schedule_stats(void)
+{
+    ScheduleStats_t stats = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+#ifdef SCHED_STATS
+    stats = sched_stats;
+#endif
+    // the dyn_array side is counted by the dyn_array library itself
+    dyn_array_stats_t array_stats = dyn_array_stats();
+    stats.comparisons += array_stats.comparisons;
+    stats.reallocs += array_stats.reallocs;
+    stats.bytes_moved += array_stats.bytes_shifted;
+    stats.mallocs += array_stats.mallocs;
+    return stats;
+}
 
-    //we want to keep looping until all values have been processed
-    while(number_completed < n){
+void sched_stats_absorb(const ScheduleStats_t *stats, const dyn_array_stats_t *array_stats)
+{
+#ifdef SCHED_STATS
+    sched_stats.dispatches += stats->dispatches;
+    sched_stats.pcbs_scanned += stats->pcbs_scanned;
+    sched_stats.comparisons += stats->comparisons;
+    sched_stats.context_switches += stats->context_switches;
+    sched_stats.clock_jumps += stats->clock_jumps;
+    sched_stats.unit_ticks += stats->unit_ticks;
+    sched_stats.mallocs += stats->mallocs;
+    dyn_array_stats_add(array_stats);
+#else
+    (void)stats;
+    (void)array_stats;
+#endif
+}
 
-        //smallest burst value in data set
-        size_t smallest_burst = SIZE_MAX;
-        //the index of smallest burst within system time
-        size_t optimal_choice = SIZE_MAX;
+// private function
+void virtual_cpu(ProcessControlBlock_t *process_control_block)
+{
+	// decrement the burst time of the pcb
+	--process_control_block->remaining_burst_time;
+}
 
-        //loop to find optimal choice index
-        for(size_t j = 0; j < n; j++){
+// Implements a queue for the processes coming in.
+bool first_come_first_serve_view_ws(pcb_view_t *view, ScheduleResult_t *result, sched_workspace_t *ws)
+{
+    if(!view || !result || !ws) return false;
+    size_t n = pcb_view_size(view);
+    if(n == 0) return false;
 
-            //skip if a completed value
-            if(completed_array[j] == 1){
-                continue;
-            }
+    // huge traces go to the prefix scan, it gives the exact same answer
+    if(n >= SCHED_PARALLEL_FCFS_THRESHOLD && sched_resolve_threads(schedule_threads) > 1) {
+        return first_come_first_serve_parallel_view(view, result, schedule_threads);
+    }
 
-            ProcessControlBlock_t *pcb = (ProcessControlBlock_t*)dyn_array_at(ready_queue, j);
-            if(!pcb) return false;
+    // earliest arrival first, each one runs to completion
+    return sched_engine_run(view, SCHED_ENGINE_FCFS, 0, result, ws);
+}
 
-            //if true a possible optimal choice found
-            if(pcb->arrival <= current_time && pcb->remaining_burst_time < smallest_burst){
-                smallest_burst = pcb->remaining_burst_time;
-                optimal_choice = j;
-            }
-        }
+bool shortest_job_first_view_ws(pcb_view_t *view, ScheduleResult_t *result, sched_workspace_t *ws)
+{
+	if(!view || !result || !ws) return false;
+    size_t n = pcb_view_size(view);
+    if(n == 0) return false;
 
-        //if no  optimal choice found we update system time
-        if(optimal_choice == SIZE_MAX){
-            for(size_t j = 0; j < n; j++){
-                
-                //skip completed values 
-                if(completed_array[j] == 1){
-                    continue;
-                }
-                //update current time to smallest arrival time
-                else{
-                    ProcessControlBlock_t *pcb = (ProcessControlBlock_t*)dyn_array_at(ready_queue, j);
-                    if(!pcb) return false;
-                    current_time = pcb->arrival;
-                    break;
-                }
-            }
-        }
-        //else optimal choice found
-        else{
-
-            //mark index in array as completed
-            completed_array[optimal_choice] = 1;
-            //update number completed
-            number_completed++;
-
-            ProcessControlBlock_t *pcb = (ProcessControlBlock_t*)dyn_array_at(ready_queue, optimal_choice);
-            if(!pcb) return false;
-            
-            // waiting time is when we actually start - arrival
-            float wait = (float)(current_time - pcb->arrival);
-            total_wait += wait;
-
-            // run the process fully
-            current_time += pcb->remaining_burst_time;
-
-            // turnaround = completion - arrival
-            float turn = (float)(current_time - pcb->arrival);
-            total_turn += turn;
-        }
+    // huge traces are split at their idle gaps and scheduled in parallel
+    if(n >= SCHED_PARALLEL_BUSY_PERIOD_THRESHOLD && sched_resolve_threads(schedule_threads) > 1) {
+        return busy_period_view(view, BUSY_PERIOD_SJF, result, schedule_threads);
     }
 
-    // fill out result
-    result->average_waiting_time = total_wait / (float)n;
-    result->average_turnaround_time = total_turn / (float)n;
-    result->total_run_time = current_time;
-
-    return true;
+    // shortest burst among the arrived ones, ties go to the earliest arrival
+    return sched_engine_run(view, SCHED_ENGINE_SJF, 0, result, ws);
 }
 
-bool priority(dyn_array_t *ready_queue, ScheduleResult_t *result) 
+bool priority_view_ws(pcb_view_t *view, ScheduleResult_t *result, sched_workspace_t *ws)
 {
      //Checking input pointers
-    if (!ready_queue || !result)
+    if (!view || !result || !ws)
     {
         return false;
     }
 
     // Checking for empty queue
-    if (dyn_array_empty(ready_queue))
+    size_t n = pcb_view_size(view);
+    if (n == 0)
     {
         return false;
     }
-        
-    size_t n = dyn_array_size(ready_queue);
-    
-    // Allocate temporary arrays to track scheduling statistics.
-    bool *done = (bool *)malloc(n * sizeof(bool));
-    uint32_t *burst = (uint32_t *)malloc(n * sizeof(uint32_t));
-    uint32_t *waiting = (uint32_t *)malloc(n * sizeof(uint32_t));
-    uint32_t *turnaround = (uint32_t *)malloc(n * sizeof(uint32_t));
-
-    // Initialize arrays.
-    for (size_t i = 0; i < n; i++) 
-    {
-        done[i] = false;
-        waiting[i] = 0;
-        turnaround[i] = 0;
-        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, i);
-        burst[i] = pcb->remaining_burst_time; // Original burst time.
-    }
-    
-    uint32_t time = 0;
-    size_t completed = 0;
-    
-    // Simulate the scheduling until all processes are completed.
-    while (completed < n) 
-    {
-        int index = 0;
-        uint32_t best_priority = UINT32_MAX;
-        
-        // Find the not-yet-done process that has arrived and has the highest priority (lowest number).
-        for (size_t i = 0; i < n; i++) 
-        {
-            ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, i);
-            if (!done[i] && pcb->arrival <= time) //If arrived (The addition of !done[i] was suggested by ChatGPT while debugging)
-            {
-                if (pcb->priority < best_priority) // If a process with lower priority is found
-                {
-                    best_priority = pcb->priority; //updating priority
-                    index = (int)i; // Updating index
-                }
-            }
-        }
-        
-        if (index == -1) {
-            time++;
-            continue;
-        }
 
-        // Process idx is scheduled.
-        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, index);
-        waiting[index] = time - pcb->arrival;
-        time += burst[index];  // Run the process to completion.
-        turnaround[index] = time - pcb->arrival;
-        done[index] = true;
-        completed++;
-    }
-    
-    uint32_t total_waiting = 0;
-    uint32_t total_turnaround = 0;
-    for (size_t i = 0; i < n; i++) 
+    // Huge traces are split at their idle gaps and scheduled in parallel
+    if (n >= SCHED_PARALLEL_BUSY_PERIOD_THRESHOLD && sched_resolve_threads(schedule_threads) > 1)
     {
-        total_waiting += waiting[i];
-        total_turnaround += turnaround[i];
+        return busy_period_view(view, BUSY_PERIOD_PRIORITY, result, schedule_threads);
     }
 
-    // Assigning values
-    result->total_run_time = time;
-    result->average_waiting_time = (float)total_waiting / n;
-    result->average_turnaround_time = (float)total_turnaround / n;
-    
-    free(done);
-    free(burst);
-    free(waiting);
-    free(turnaround);
-    return true;
+    // Highest priority (lowest number) among the arrived ones, equal priorities go to the lowest index
+    return sched_engine_run(view, SCHED_ENGINE_PRIORITY, 0, result, ws);
 }
 
-bool round_robin(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum) 
+// round_robin_view_ws, saving and resuming through checkpoint unless it's NULL
+static bool round_robin_run(pcb_view_t *view, ScheduleResult_t *result, size_t quantum, sched_workspace_t *ws,
+                            sched_checkpoint_t *checkpoint)
 {
      // Checking for invalid pointers
-    if (!ready_queue || !result)
+    if (!view || !result || !ws)
     {
         return false;
-    }  
-        
+    }
+
     // Checking for empty array
-    if (dyn_array_empty(ready_queue))
+    size_t n = pcb_view_size(view);
+    if (n == 0)
     {
         return false;
     }
@@ -267,89 +187,39 @@ bool round_robin(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quan
         return false;
     }
 
-    size_t n = dyn_array_size(ready_queue);
-    
-    // Allocating arrays 
-    uint32_t *orig = (uint32_t *)malloc(n * sizeof(uint32_t));
-    uint32_t *remaining = (uint32_t *)malloc(n * sizeof(uint32_t));
-    uint32_t *finish = (uint32_t *)malloc(n * sizeof(uint32_t));
-    uint32_t *arrival = (uint32_t *)malloc(n * sizeof(uint32_t));
-    
-    // Initializing arrays
-    for (size_t i = 0; i < n; i++)
+    const ProcessControlBlock_t *pcbs = pcb_view_pcbs(view);
+
+    // Batch traces (everyone arrives together) have a closed form, no need to run the slices
+    size_t first_late = 1;
+    while (first_late < n && pcbs[first_late].arrival == pcbs[0].arrival)
     {
-        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, i);
-        orig[i] = pcb->remaining_burst_time;
-        remaining[i] = pcb->remaining_burst_time;
-        arrival[i] = pcb->arrival;
-        finish[i] = 0;
+        first_late++;
     }
-    
-    uint32_t time = 0;
-    size_t completed = 0;
-    
-    // Simulating the Round Robin scheduling.
-    while (completed < n) 
+    if (first_late == n)
     {
-        bool ran_proc = false; /* track if anything ran this pass */
-        for (size_t i = 0; i < n; i++) 
-        {
-            
-            if (arrival[i] <= time && remaining[i] > 0) // IF processes that have arrived and are not finished.
-            {
-                ran_proc = true;
-                uint32_t timeSlice;
-                if (remaining[i] < quantum) 
-                {
-                    timeSlice = remaining[i]; // Whathever is remaining
-                } 
-                else 
-                {
-                    timeSlice = quantum; // The full quantum
-                }
-
-                time += timeSlice; // Adding to the current time
-                remaining[i] -= timeSlice; // Removing from remaining
-                
-                if (remaining[i] == 0) // If the process finishes
-                {
-                    finish[i] = time;// Saving its finish time.
-                    completed++;
-                }
-            }
-        }
-        /* If no process ran in that entire for-loop, CPU was idle; move time forward by 1 */
-        if(!ran_proc) {
-            time++;
-        }
+        return round_robin_all_arrived(pcbs, n, quantum, result, ws);
     }
-    
-    uint32_t total_waiting = 0;
-    uint32_t total_turnaround = 0;
-    for (size_t i = 0; i < n; i++) 
+
+    // Sweeps the PCBs in index order, a quantum each for the ones that have arrived
+    if (checkpoint)
     {
-        // Calculating total waiting time and turnaround time.
-        uint32_t turnaround = finish[i] - arrival[i];
-        uint32_t waiting = turnaround - orig[i];
-        total_turnaround += turnaround;
-        total_waiting += waiting;
+        return sched_engine_run_checkpointed(view, SCHED_ENGINE_RR, quantum, result, ws, checkpoint);
     }
-    
-    // Assigning values
-    result->total_run_time = time;
-    result->average_waiting_time = (float)total_waiting / n;
-    result->average_turnaround_time = (float)total_turnaround / n;
-    
-    free(orig);
-    free(remaining);
-    free(finish);
-    free(arrival);
-    
-    return true;
+    return sched_engine_run(view, SCHED_ENGINE_RR, quantum, result, ws);
+}
+
+bool round_robin_view_ws(pcb_view_t *view, ScheduleResult_t *result, size_t quantum, sched_workspace_t *ws)
+{
+    return round_robin_run(view, result, quantum, ws, NULL);
 }
 
 // Loads the process from the PCB File.
-dyn_array_t *load_process_control_blocks(const char *input_file) 
+// Records per read in load_process_control_blocks
+#ifndef PCB_LOAD_CHUNK
+#define PCB_LOAD_CHUNK 1024
+#endif
+
+dyn_array_t *load_process_control_blocks(const char *input_file)
 {
     if(!input_file) return NULL; // corner case
 
@@ -363,137 +233,233 @@ dyn_array_t *load_process_control_blocks(const char *input_file)
         return NULL;
     }
 
-    dyn_array_t *arr = dyn_array_create(N, sizeof(ProcessControlBlock_t), NULL);
+    // cache line aligned, and big traces get huge pages to keep TLB misses down on the scans
+    const dyn_allocator_t allocator = dyn_allocator_system(DYN_ALLOC_ALIGNED | DYN_ALLOC_HUGE);
+    dyn_array_t *arr = dyn_array_create_with(N, sizeof(ProcessControlBlock_t), NULL, &allocator);
     if(!arr) {
         fclose(fp);
         return NULL;
     }
 
-    for(uint32_t i=0; i<N; i++) {
-        ProcessControlBlock_t temp;
-        size_t r1 = fread(&temp.remaining_burst_time, sizeof(uint32_t), 1, fp);
-        size_t r2 = fread(&temp.priority, sizeof(uint32_t), 1, fp);
-        size_t r3 = fread(&temp.arrival, sizeof(uint32_t), 1, fp);
-        temp.started = false;
-        if(r1!=1 || r2!=1 || r3!=1) {
+    // Records are read a chunk at a time and appended in one go (one fread and one copy per chunk)
+    uint32_t raw[PCB_LOAD_CHUNK][3];
+    ProcessControlBlock_t chunk[PCB_LOAD_CHUNK];
+    for(uint32_t loaded = 0; loaded < N; ) {
+        size_t want = N - loaded < PCB_LOAD_CHUNK ? N - loaded : PCB_LOAD_CHUNK;
+        if(fread(raw, sizeof(raw[0]), want, fp) != want) {
             dyn_array_destroy(arr);
             fclose(fp);
             return NULL;
         }
-        if(!dyn_array_push_back(arr, &temp)) {
+        for(size_t i = 0; i < want; i++) {
+            chunk[i].remaining_burst_time = raw[i][0];
+            chunk[i].priority = raw[i][1];
+            chunk[i].arrival = raw[i][2];
+            chunk[i].started = false;
+        }
+        if(!dyn_array_push_back_n(arr, chunk, want)) {
             dyn_array_destroy(arr);
             fclose(fp);
             return NULL;
         }
+        loaded += (uint32_t)want;
     }
     fclose(fp);
+    // capacity was rounded up to a power of two, hand the slack back (a remap for huge arrays)
+    dyn_array_shrink_to_fit(arr);
+    return arr;
+}
+
+dyn_array_t *load_process_control_blocks_sorted(const char *input_file, size_t nthreads)
+{
+    dyn_array_t *arr = load_process_control_blocks(input_file);
+    if(arr && dyn_array_size(arr) && !dyn_array_sort_parallel(arr, pcb_arrival_cmp, nthreads)) {
+        dyn_array_destroy(arr);
+        return NULL;
+    }
     return arr;
 }
 
-bool shortest_remaining_time_first(dyn_array_t *ready_queue, ScheduleResult_t *result) 
+bool shortest_remaining_time_first_view_ws(pcb_view_t *view, ScheduleResult_t *result, sched_workspace_t *ws)
 {
     //Checking for invalid pointers
-    if (!ready_queue || !result) 
+    if (!view || !result || !ws)
     {
         return false;
     }
 
-    size_t n = dyn_array_size(ready_queue);
+    size_t n = pcb_view_size(view);
     if (n == 0) // If empty
     {
         return false;
     }
 
-    // Making a copy of the PCBs so we don't modify the original ready_queue.
-    ProcessControlBlock_t *processes = malloc(n * sizeof(ProcessControlBlock_t));
-    if (!processes) 
-    {
-        return false;
-    }
+    // Least remaining burst runs, an arrival with less left takes the CPU over
+    return sched_engine_run(view, SCHED_ENGINE_SRT, 0, result, ws);
+}
 
-    // Iterating to copy data to processes
-    for (size_t i = 0; i < n; i++) 
-    {
-        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, i);
-        if (!pcb) // If not valid
-        {
-            free(processes);
-            return false;
-        }
-        // if pointer is valid
-        processes[i] = *pcb; // Copy data
-    }
-    
-    uint32_t *start_times = malloc(n * sizeof(uint32_t)); // Records when a process is first executed.
-    uint32_t *finish_times = malloc(n * sizeof(uint32_t));// Records when a process completes.
-    uint32_t *original_burst = malloc(n * sizeof(uint32_t));// Stores the initial burst time.
+// The view entry points borrow a workspace for the one call.
 
-    for (size_t i = 0; i < n; i++) 
-    {
-        start_times[i] = UINT32_MAX;  // flag value to indicate not started
-        finish_times[i] = 0;
-        original_burst[i] = processes[i].remaining_burst_time;
-    }
+bool first_come_first_serve_view(pcb_view_t *view, ScheduleResult_t *result)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = first_come_first_serve_view_ws(view, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
 
-    uint32_t time = 0;
-    size_t completed = 0;
-    while (completed < n) // While there are still processes to be completed
-    {
-        int index = 0;
-        uint32_t min_remaining = UINT32_MAX;
- 
-        for (size_t i = 0; i < n; i++) 
-        {
-            if (processes[i].remaining_burst_time > 0 && processes[i].arrival <= time) // Finding the process that has arrived
-            {
-                if (processes[i].remaining_burst_time < min_remaining) // Finding procees with the smallest remaining burst time.
-                {
-                    min_remaining = processes[i].remaining_burst_time;
-                    index = (int)i; //update index
-                }
-            }
-        }
-        if(index<0){
-            /* no arrived process found, so CPU is idle */
-            time++;
-            continue;
-        }
-        // Executing the selected process
-        processes[index].remaining_burst_time--;
-        time++;
-        
-        if (processes[index].remaining_burst_time == 0)  // If the process has finished executing
-        {
-            finish_times[index] = time; //Save its finish time.
-            completed++; // Update completed counter
-        }
-    }
+bool shortest_job_first_view(pcb_view_t *view, ScheduleResult_t *result)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = shortest_job_first_view_ws(view, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
+
+bool priority_view(pcb_view_t *view, ScheduleResult_t *result)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = priority_view_ws(view, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
+
+bool round_robin_view(pcb_view_t *view, ScheduleResult_t *result, size_t quantum)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = round_robin_view_ws(view, result, quantum, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
+
+bool shortest_remaining_time_first_view(pcb_view_t *view, ScheduleResult_t *result)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = shortest_remaining_time_first_view_ws(view, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
+
+// The dyn_array entry points run over the workspace's view, so the caller's PCBs are never reordered.
+// Callers that run several schedulers on one trace should build a view once and use the _view functions.
+
+bool first_come_first_serve_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, sched_workspace_t *ws)
+{
+    pcb_view_t *view = ws ? sched_ws_view(ws, ready_queue) : NULL;
+    return view && first_come_first_serve_view_ws(view, result, ws);
+}
+
+bool shortest_job_first_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, sched_workspace_t *ws)
+{
+    pcb_view_t *view = ws ? sched_ws_view(ws, ready_queue) : NULL;
+    return view && shortest_job_first_view_ws(view, result, ws);
+}
+
+bool priority_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, sched_workspace_t *ws)
+{
+    pcb_view_t *view = ws ? sched_ws_view(ws, ready_queue) : NULL;
+    return view && priority_view_ws(view, result, ws);
+}
+
+bool round_robin_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum, sched_workspace_t *ws)
+{
+    pcb_view_t *view = ws ? sched_ws_view(ws, ready_queue) : NULL;
+    return view && round_robin_view_ws(view, result, quantum, ws);
+}
+
+bool shortest_remaining_time_first_ws(dyn_array_t *ready_queue, ScheduleResult_t *result, sched_workspace_t *ws)
+{
+    pcb_view_t *view = ws ? sched_ws_view(ws, ready_queue) : NULL;
+    return view && shortest_remaining_time_first_view_ws(view, result, ws);
+}
 
-    uint32_t total_waiting_time = 0;
-    uint32_t total_turnaround_time = 0;
+bool first_come_first_serve(dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = first_come_first_serve_ws(ready_queue, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
 
-    for (size_t i = 0; i < n; i++)
+bool shortest_job_first(dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = shortest_job_first_ws(ready_queue, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
+
+bool priority(dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = priority_ws(ready_queue, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
+
+bool round_robin(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = round_robin_ws(ready_queue, result, quantum, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
+
+bool shortest_remaining_time_first(dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    bool success = shortest_remaining_time_first_ws(ready_queue, result, &ws);
+    sched_ws_release(&ws);
+    return success;
+}
+
+// The checkpointed entry points (sched_checkpoint.h) run the same engine with a checkpoint attached.
+
+bool round_robin_checkpointed(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum,
+                              sched_checkpoint_t *checkpoint)
+{
+    if (!checkpoint)
     {
-        // Computing total waiting time and turnaround time.
-        uint32_t turnaround = finish_times[i] - processes[i].arrival;
-        uint32_t waiting = turnaround - original_burst[i];
-        total_turnaround_time += turnaround;
-        total_waiting_time += waiting;
+        return false;
     }
+    checkpoint->resumed = false;
+    checkpoint->written = 0;
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    pcb_view_t *view = sched_ws_view(&ws, ready_queue);
+    bool success = view && round_robin_run(view, result, quantum, &ws, checkpoint);
+    sched_ws_release(&ws);
+    return success;
+}
 
-    //Assinging average values
-    result->average_waiting_time = (float)total_waiting_time / n;
-    result->average_turnaround_time = (float)total_turnaround_time / n;
-    result->total_run_time = time;
-
-    free(processes);
-    free(start_times);
-    free(finish_times);
-    free(original_burst);
-    return true;
+bool shortest_remaining_time_first_checkpointed(dyn_array_t *ready_queue, ScheduleResult_t *result,
+                                                sched_checkpoint_t *checkpoint)
+{
+    if (!checkpoint)
+    {
+        return false;
+    }
+    checkpoint->resumed = false;
+    checkpoint->written = 0;
+    sched_workspace_t ws;
+    sched_ws_init(&ws);
+    pcb_view_t *view = sched_ws_view(&ws, ready_queue);
+    bool success = view && result && sched_engine_run_checkpointed(view, SCHED_ENGINE_SRT, 0, result, &ws, checkpoint);
+    sched_ws_release(&ws);
+    return success;
 }
 
-static int pcb_arrival_cmp(const void *a, const void *b) {
+int pcb_arrival_cmp(const void *a, const void *b) {
     const ProcessControlBlock_t *pa = (const ProcessControlBlock_t*)a;
     const ProcessControlBlock_t *pb = (const ProcessControlBlock_t*)b;
     if(pa->arrival < pb->arrival) return -1;
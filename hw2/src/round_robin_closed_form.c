@@ -0,0 +1,162 @@
+#include <stdlib.h>
+
+#include "scheduling_internal.h"
+
+/*
+	Round robin when every PCB arrives at the same time.
+
+	With nobody arriving late, the simulation is a sequence of rounds: round r gives one
+	slice, in index order, to every PCB that needs at least r slices. A PCB with burst b
+	needs k = ceil(b / q) slices and finishes in round k. Everything about its finish time
+	follows from how the other PCBs compare to it:
+
+	- PCBs needing fewer slices finished earlier and did all of their work.
+	- Earlier-index PCBs needing exactly k slices finished earlier in round k.
+	- Earlier-index PCBs needing more got k full quanta.
+	- Later-index PCBs needing k or more got k - 1 full quanta.
+
+	Sorting by (k, index) turns all of those into prefix sums, except the count of
+	earlier-index PCBs needing more, which comes from a Fenwick tree. O(n log n) overall,
+	no matter how small the quantum or how long the bursts.
+
+	Overhead: every slice is a dispatch, and every slice but the first is a context switch,
+	except once a single PCB is left and keeps getting the CPU back.
+*/
+
+// Fenwick tree over index ranks, counts how many inserted ranks sit below a rank
+static void fenwick_add(uint32_t *tree, size_t size, size_t rank)
+{
+    for(size_t node = rank + 1; node <= size; node += node & (~node + 1)) {
+        tree[node - 1]++;
+    }
+}
+
+static sched_time_t fenwick_count_below(const uint32_t *tree, size_t rank)
+{
+    sched_time_t count = 0;
+    for(size_t node = rank; node > 0; node -= node & (~node + 1)) {
+        count += tree[node - 1];
+    }
+    return count;
+}
+
+static int packed_slices_cmp(const void *a, const void *b)
+{
+    const uint64_t ka = *(const uint64_t *)a;
+    const uint64_t kb = *(const uint64_t *)b;
+    SCHED_STAT_ADD(comparisons, 1);
+    return (ka > kb) - (ka < kb);
+}
+
+bool round_robin_all_arrived(const ProcessControlBlock_t *pcbs, size_t n, sched_time_t quantum, ScheduleResult_t *result,
+                             sched_workspace_t *ws)
+{
+    schedule_totals_t totals;
+    totals_init(&totals);
+    const sched_time_t arrival = pcbs[0].arrival;
+
+    // rank = position among the PCBs that actually need the CPU, in index order
+    uint32_t *runnable = (uint32_t *)sched_ws_buffer(ws, SCHED_WS_INDEX, n * sizeof(uint32_t));
+    if(!runnable) return false;
+    size_t m = 0;
+    SCHED_STAT_ADD(pcbs_scanned, n);
+    for(size_t i = 0; i < n; i++) {
+        if(pcbs[i].remaining_burst_time) {
+            runnable[m++] = (uint32_t)i;
+        }
+        else {
+            totals_record(&totals, arrival, 0, arrival); // empty bursts finish on arrival
+        }
+    }
+    if(m == 0) {
+        totals_finish(&totals, 0, result);
+        return true;
+    }
+
+    // (slices << 32 | rank), sorted, is the order in which PCBs finish
+    uint64_t *order = (uint64_t *)sched_ws_buffer(ws, SCHED_WS_KEYS, m * sizeof(uint64_t));
+    uint32_t *tree = (uint32_t *)sched_ws_buffer(ws, SCHED_WS_TREE, m * sizeof(uint32_t));
+    sched_time_t *bigger_before = (sched_time_t *)sched_ws_buffer(ws, SCHED_WS_TIMES, m * sizeof(sched_time_t));
+    if(!order || !tree || !bigger_before) return false;
+    memset(tree, 0, m * sizeof(uint32_t));
+    for(size_t rank = 0; rank < m; rank++) {
+        sched_time_t burst = pcbs[runnable[rank]].remaining_burst_time;
+        order[rank] = (burst / quantum + (burst % quantum != 0)) << 32 | rank;
+    }
+    qsort(order, m, sizeof(uint64_t), packed_slices_cmp);
+
+    // walk from the most slices down: before a group is inserted, the tree holds exactly
+    // the PCBs needing more slices, so it can count the earlier-index ones
+    for(size_t end = m; end > 0;) {
+        size_t begin = end - 1;
+        while(begin > 0 && order[begin - 1] >> 32 == order[end - 1] >> 32) {
+            begin--;
+        }
+        for(size_t pos = begin; pos < end; pos++) {
+            bigger_before[pos] = fenwick_count_below(tree, (uint32_t)order[pos]);
+        }
+        for(size_t pos = begin; pos < end; pos++) {
+            fenwick_add(tree, m, (uint32_t)order[pos]);
+        }
+        end = begin;
+    }
+
+    const sched_time_t dispatch = totals.costs.dispatch_cost;
+    const sched_time_t switch_cost = totals.costs.context_switch_cost;
+    sched_time_t fewer_slices = 0;  // slices of every PCB in earlier groups
+    sched_time_t fewer_work = 0;    // bursts of every PCB in earlier groups
+    sched_time_t second_last_slices = 0;
+    sched_time_t finish = 0;
+    for(size_t begin = 0; begin < m;) {
+        const sched_time_t slices = order[begin] >> 32;
+        size_t end = begin;
+        while(end < m && order[end] >> 32 == slices) {
+            end++;
+        }
+        const sched_time_t more = m - end;  // PCBs needing more slices than this group
+        sched_time_t same_work_before = 0;  // bursts of earlier-index PCBs in this group
+
+        for(size_t pos = begin; pos < end; pos++) {
+            const ProcessControlBlock_t *pcb = &pcbs[runnable[(uint32_t)order[pos]]];
+            const sched_time_t burst = pcb->remaining_burst_time;
+            const sched_time_t same_after = end - pos - 1;
+            const sched_time_t still_waiting = more - bigger_before[pos] + same_after;  // later index, k or more
+
+            // slices handed out up to and including this PCB's last one, and the work they did
+            sched_time_t slice_count = fewer_slices + slices * (m - begin) - still_waiting;
+            sched_time_t work = fewer_work + same_work_before + burst
+                              + bigger_before[pos] * slices * quantum + still_waiting * (slices - 1) * quantum;
+
+            // the last PCB keeps the CPU without switching once everyone else is done
+            sched_time_t switches = slice_count - 1;
+            if(pos == m - 1 && m > 1 && slice_count > second_last_slices + 1) {
+                switches -= slice_count - second_last_slices - 1;
+            }
+            else if(m == 1) {
+                switches = 0;
+            }
+
+            finish = arrival + work + slice_count * dispatch + switches * switch_cost;
+            totals_record(&totals, pcb->arrival, burst, finish);
+            if(pos == m - 2) {
+                second_last_slices = slice_count;
+            }
+            if(pos == m - 1) {
+                totals.switches = switches;
+                totals.overhead = slice_count * dispatch + switches * switch_cost;
+                SCHED_STAT_ADD(dispatches, slice_count);
+                SCHED_STAT_ADD(context_switches, switches);
+            }
+            same_work_before += burst;
+        }
+
+        for(size_t pos = begin; pos < end; pos++) {
+            fewer_work += pcbs[runnable[(uint32_t)order[pos]]].remaining_burst_time;
+        }
+        fewer_slices += slices * (end - begin);
+        begin = end;
+    }
+
+    totals_finish(&totals, finish, result);
+    return true;
+}
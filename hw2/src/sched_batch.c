@@ -0,0 +1,392 @@
+#include <stdlib.h>
+
+#include "sched_batch.h"
+#include "scheduling_internal.h"
+
+// Workloads scheduled side by side, one per 64 bit lane of the widest vector registers the target has
+#ifndef BATCH_LANES
+#if defined(__AVX512F__)
+#define BATCH_LANES 8
+#elif defined(__AVX2__)
+#define BATCH_LANES 4
+#else
+#define BATCH_LANES 2
+#endif
+#endif
+
+// RR workloads needing more slices than this go to round_robin rather than keep their group's other lanes waiting
+#ifndef BATCH_MAX_SLICES
+#define BATCH_MAX_SLICES (16 * SCHED_BATCH_MAX_PCBS)
+#endif
+
+typedef uint64_t batch_vec_t __attribute__((vector_size(BATCH_LANES * sizeof(uint64_t))));
+
+// Padding arrival, past the last one of a lane
+#define BATCH_NONE UINT64_MAX
+
+// Lanes where mask is set take a, the others b (masks are all ones or all zeros per lane, as comparisons give)
+static inline batch_vec_t batch_select(batch_vec_t mask, batch_vec_t a, batch_vec_t b)
+{
+    return (a & mask) | (b & ~mask);
+}
+
+static inline batch_vec_t batch_splat(uint64_t value)
+{
+    batch_vec_t vec = { 0 };
+    return vec + value;
+}
+
+static inline batch_vec_t batch_max(batch_vec_t a, batch_vec_t b)
+{
+    return batch_select((batch_vec_t)(a > b), a, b);
+}
+
+static inline bool batch_any(batch_vec_t mask)
+{
+    uint64_t any = 0;
+    for(size_t lane = 0; lane < BATCH_LANES; lane++) {
+        any |= mask[lane];
+    }
+    return any != 0;
+}
+
+// rows[at] of every lane, lane by lane (the vector extensions have no gather)
+static inline batch_vec_t batch_gather(const batch_vec_t *rows, batch_vec_t at)
+{
+    batch_vec_t out;
+    for(size_t lane = 0; lane < BATCH_LANES; lane++) {
+        out[lane] = rows[at[lane]][lane];
+    }
+    return out;
+}
+
+// Position of the one bit set in each lane (0 for lanes without one)
+static inline batch_vec_t batch_bit_index(batch_vec_t bits)
+{
+    batch_vec_t out;
+    for(size_t lane = 0; lane < BATCH_LANES; lane++) {
+        out[lane] = bits[lane] ? (uint64_t)__builtin_ctzll(bits[lane]) : 0;
+    }
+    return out;
+}
+
+// A group of workloads, transposed: arrival[k] holds the k-th arrival (ties by index) of every lane's workload.
+// SJF and RR keep each lane's ready PCBs as a bit set, in burst order for SJF and index order for RR, so the
+// next dispatch is the lowest bit (the first one at or after the sweep for RR).
+typedef struct
+{
+    batch_vec_t arrival[SCHED_BATCH_MAX_PCBS + 1];  // BATCH_NONE past a lane's rows
+    batch_vec_t bit[SCHED_BATCH_MAX_PCBS + 1];      // SJF and RR: the k-th arrival's bit in the ready set
+    batch_vec_t burst[SCHED_BATCH_MAX_PCBS];        // FCFS: of the k-th arrival, SJF: by bit, RR: by index
+    batch_vec_t rows;                   // arrivals laid out per lane (RR leaves out empty bursts)
+    batch_vec_t time;                   // clock, at the end when the last PCB finished
+    batch_vec_t completion;             // sum of completion times, turnaround and waiting follow from it
+    batch_vec_t switches;
+    batch_vec_t overhead;
+    uint64_t count[BATCH_LANES];        // PCBs in each lane's workload
+    uint64_t arrivals[BATCH_LANES];     // sum of arrival times
+    uint64_t bursts[BATCH_LANES];       // sum of bursts
+    uint64_t empty[BATCH_LANES];        // RR: sum of arrival times of the empty bursts, done as they arrive
+    ScheduleResult_t *results[BATCH_LANES];
+    size_t lanes;                       // lanes in use
+    size_t width;                       // most rows in any lane
+} batch_group_t;
+
+// Sorts up to SCHED_BATCH_MAX_PCBS keys, insertion sort since traces mostly come in arrival order already
+static void batch_sort(uint64_t *keys, size_t n)
+{
+    for(size_t i = 1; i < n; i++) {
+        uint64_t key = keys[i];
+        size_t at = i;
+        for(; at > 0 && keys[at - 1] > key; at--) {
+            keys[at] = keys[at - 1];
+        }
+        keys[at] = key;
+    }
+}
+
+// Lays a workload out in the group's next lane
+static void batch_add(batch_group_t *group, const uint32_t *pcbs, size_t n, BATCH_POLICY policy, ScheduleResult_t *result)
+{
+    size_t lane = group->lanes++;
+    uint64_t order[SCHED_BATCH_MAX_PCBS];
+    uint64_t arrivals = 0, bursts = 0, empty = 0;
+    size_t rows = 0;
+    for(size_t i = 0; i < n; i++) {
+        const uint32_t *pcb = pcbs + 3 * i;
+        arrivals += pcb[2];
+        bursts += pcb[0];
+        if(policy == BATCH_POLICY_RR) {
+            group->burst[i][lane] = pcb[0];
+            if(!pcb[0]) {
+                empty += pcb[2];
+                continue;
+            }
+        }
+        order[rows++] = (uint64_t)pcb[2] << 32 | i;
+    }
+    batch_sort(order, rows);
+
+    uint64_t by_burst[SCHED_BATCH_MAX_PCBS];
+    for(size_t k = 0; k < rows; k++) {
+        uint32_t index = (uint32_t)order[k];
+        group->arrival[k][lane] = order[k] >> 32;
+        switch(policy) {
+            case BATCH_POLICY_FCFS:
+                group->burst[k][lane] = pcbs[3 * index];
+                break;
+            case BATCH_POLICY_SJF:
+                by_burst[k] = (uint64_t)pcbs[3 * index] << 32 | k;
+                break;
+            case BATCH_POLICY_RR:
+                group->bit[k][lane] = (uint64_t)1 << index;
+                break;
+        }
+    }
+    if(policy == BATCH_POLICY_SJF) {
+        // shortest burst first, ties to the earliest arrival
+        batch_sort(by_burst, rows);
+        for(size_t place = 0; place < rows; place++) {
+            group->burst[place][lane] = by_burst[place] >> 32;
+            group->bit[(uint32_t)by_burst[place]][lane] = (uint64_t)1 << place;
+        }
+    }
+
+    group->rows[lane] = rows;
+    group->count[lane] = n;
+    group->arrivals[lane] = arrivals;
+    group->bursts[lane] = bursts;
+    group->empty[lane] = empty;
+    group->results[lane] = result;
+    if(rows > group->width) group->width = rows;
+}
+
+// Adds everything arrived by `now` to the ready sets, leaving the cursors at each lane's next arrival
+static inline void batch_admit(const batch_group_t *group, batch_vec_t now, batch_vec_t *cursor, batch_vec_t *ready)
+{
+    for(;;) {
+        batch_vec_t in = (batch_vec_t)(batch_gather(group->arrival, *cursor) <= now);
+        if(!batch_any(in)) return;
+        *ready |= batch_gather(group->bit, *cursor) & in;
+        *cursor -= in;
+    }
+}
+
+// Run to completion in arrival order: c = max(c, arrival) + overhead + burst down every lane at once
+static void batch_fcfs(batch_group_t *group, const ScheduleOverhead_t *costs)
+{
+    batch_vec_t time = group->time, completion = group->completion;
+    for(size_t k = 0; k < group->width; k++) {
+        batch_vec_t active = (batch_vec_t)(group->rows > (uint64_t)k);
+        uint64_t cost = (uint64_t)costs->dispatch_cost + (k ? costs->context_switch_cost : 0);
+        batch_vec_t done_at = batch_max(time, group->arrival[k]) + cost + group->burst[k];
+        time = batch_select(active, done_at, time);
+        completion += done_at & active;
+    }
+    group->time = time;
+    group->completion = completion;
+}
+
+// Shortest burst among the arrived PCBs: the lowest bit of the ready set, one dispatch per lane per step
+static void batch_sjf(batch_group_t *group, const ScheduleOverhead_t *costs)
+{
+    batch_vec_t time = group->time, completion = group->completion;
+    batch_vec_t cursor = batch_splat(0), ready = batch_splat(0);
+    for(size_t k = 0; k < group->width; k++) {
+        batch_vec_t active = (batch_vec_t)(group->rows > (uint64_t)k);
+        batch_admit(group, time, &cursor, &ready);
+        // nothing ready means idling until the next arrival
+        batch_vec_t idle = active & (batch_vec_t)(ready == 0);
+        batch_vec_t now = batch_select(idle, batch_gather(group->arrival, cursor), time);
+        if(batch_any(idle)) {
+            batch_admit(group, now, &cursor, &ready);
+        }
+
+        batch_vec_t chosen = ready & -ready;
+        ready ^= chosen;
+        uint64_t cost = (uint64_t)costs->dispatch_cost + (k ? costs->context_switch_cost : 0);
+        batch_vec_t done_at = now + cost + batch_gather(group->burst, batch_bit_index(chosen));
+        time = batch_select(active, done_at, time);
+        completion += done_at & active;
+    }
+    group->time = time;
+    group->completion = completion;
+}
+
+// Round robin sweeping by index: the lowest ready bit at or after the sweep (wrapping around), a quantum at a time
+static void batch_rr(batch_group_t *group, size_t quantum, const ScheduleOverhead_t *costs)
+{
+    const batch_vec_t all = batch_splat(BATCH_NONE);
+    batch_vec_t time = group->time, completion = group->completion, switches = group->switches, overhead = group->overhead;
+    batch_vec_t cursor = batch_splat(0), ready = batch_splat(0);
+    batch_vec_t after = all;                // indexes the sweep hasn't passed yet
+    batch_vec_t last = batch_splat(0);      // bit of the process that last held the CPU
+    for(;;) {
+        batch_admit(group, time, &cursor, &ready);
+        batch_vec_t active = (batch_vec_t)(ready != 0) | (batch_vec_t)(cursor < group->rows);
+        if(!batch_any(active)) break;
+
+        // idling starts a new sweep from index 0
+        batch_vec_t idle = active & (batch_vec_t)(ready == 0);
+        batch_vec_t now = batch_select(idle, batch_gather(group->arrival, cursor), time);
+        if(batch_any(idle)) {
+            batch_admit(group, now, &cursor, &ready);
+            after |= idle;
+        }
+
+        batch_vec_t later = ready & after;
+        batch_vec_t next = batch_select((batch_vec_t)(later != 0), later, ready);
+        batch_vec_t chosen = next & -next;
+        batch_vec_t index = batch_bit_index(chosen);
+        batch_vec_t slice, finished;
+        for(size_t lane = 0; lane < BATCH_LANES; lane++) {
+            uint64_t left = group->burst[index[lane]][lane];
+            slice[lane] = left < quantum ? left : quantum;
+            group->burst[index[lane]][lane] = left - slice[lane];
+            finished[lane] = left == slice[lane] ? BATCH_NONE : 0;
+        }
+        finished &= active;
+
+        batch_vec_t switched = active & (batch_vec_t)(last != 0) & (batch_vec_t)(last != chosen);
+        batch_vec_t cost = ((uint64_t)costs->dispatch_cost & active) + ((uint64_t)costs->context_switch_cost & switched);
+        switches -= switched;
+        overhead += cost;
+        batch_vec_t done_at = now + cost + slice;
+        time = batch_select(active, done_at, time);
+        completion += done_at & finished;
+        ready ^= chosen & finished;
+        last = batch_select(active, chosen, last);
+        after = batch_select(active, -(chosen << 1), after);
+    }
+    group->time = time;
+    group->completion = completion;
+    group->switches = switches;
+    group->overhead = overhead;
+}
+
+// Pads the group's lanes, schedules it and writes out the results, leaving the group empty
+static void batch_run(batch_group_t *group, BATCH_POLICY policy, size_t quantum, const ScheduleOverhead_t *costs)
+{
+    for(size_t lane = 0; lane < BATCH_LANES; lane++) {
+        if(lane >= group->lanes) {
+            group->rows[lane] = 0;
+            group->empty[lane] = 0;
+        }
+        for(size_t k = group->rows[lane]; k <= group->width; k++) {
+            group->arrival[k][lane] = BATCH_NONE;
+            group->bit[k][lane] = 0;
+        }
+        group->time[lane] = 0;
+        group->completion[lane] = group->empty[lane];
+        group->switches[lane] = 0;
+        group->overhead[lane] = 0;
+    }
+
+    switch(policy) {
+        case BATCH_POLICY_FCFS:
+            batch_fcfs(group, costs);
+            break;
+        case BATCH_POLICY_SJF:
+            batch_sjf(group, costs);
+            break;
+        case BATCH_POLICY_RR:
+            batch_rr(group, quantum, costs);
+            break;
+    }
+
+    for(size_t lane = 0; lane < group->lanes; lane++) {
+        uint64_t n = group->count[lane];
+        schedule_totals_t totals;
+        totals_init(&totals);
+        totals.turnaround = group->completion[lane] - group->arrivals[lane];
+        totals.waiting = totals.turnaround - group->bursts[lane];
+        totals.count = n;
+        if(policy == BATCH_POLICY_RR) {
+            totals.switches = group->switches[lane];
+            totals.overhead = group->overhead[lane];
+        }
+        else {
+            // one dispatch per PCB, each to another process but the first
+            totals.switches = n - 1;
+            totals.overhead = n * costs->dispatch_cost + (n - 1) * costs->context_switch_cost;
+        }
+        totals_finish(&totals, group->time[lane], group->results[lane]);
+    }
+    group->lanes = 0;
+    group->width = 0;
+}
+
+// Schedules a workload on its own with the regular schedulers, reusing one scratch array
+static bool batch_single(dyn_array_t **scratch, const uint32_t *pcbs, size_t n, BATCH_POLICY policy, size_t quantum,
+                         ScheduleResult_t *result)
+{
+    if(!*scratch && !(*scratch = dyn_array_create(n, sizeof(ProcessControlBlock_t), NULL))) return false;
+    dyn_array_clear(*scratch);
+    for(size_t i = 0; i < n; i++) {
+        ProcessControlBlock_t pcb = { pcbs[3 * i], pcbs[3 * i + 1], pcbs[3 * i + 2], false };
+        if(!dyn_array_push_back(*scratch, &pcb)) return false;
+    }
+    switch(policy) {
+        case BATCH_POLICY_FCFS:
+            return first_come_first_serve(*scratch, result);
+        case BATCH_POLICY_SJF:
+            return shortest_job_first(*scratch, result);
+        case BATCH_POLICY_RR:
+            return round_robin(*scratch, result, quantum);
+    }
+    return false;
+}
+
+size_t schedule_batch_count(const uint32_t *const packed, const size_t words)
+{
+    if(!packed) return 0;
+    size_t count = 0;
+    for(size_t at = 0; at < words; count++) {
+        size_t n = packed[at];
+        if(!n || (words - at - 1) / 3 < n) return 0;
+        at += 1 + 3 * n;
+    }
+    return count;
+}
+
+bool schedule_batch(const uint32_t *const packed, const size_t words, const BATCH_POLICY policy, const size_t quantum,
+                    ScheduleResult_t *results, const size_t count)
+{
+    if(!packed || !results || (unsigned)policy > BATCH_POLICY_RR || (policy == BATCH_POLICY_RR && !quantum)) return false;
+    if(!count || schedule_batch_count(packed, words) != count) return false;
+
+    const ScheduleOverhead_t costs = get_schedule_overhead();
+    batch_group_t group;
+    group.lanes = 0;
+    group.width = 0;
+    dyn_array_t *scratch = NULL;
+    bool success = true;
+    const uint32_t *at = packed;
+    for(size_t w = 0; w < count && success; w++) {
+        size_t n = *at;
+        const uint32_t *pcbs = at + 1;
+        at += 1 + 3 * n;
+
+        bool fits = n <= SCHED_BATCH_MAX_PCBS;
+        if(fits && policy == BATCH_POLICY_RR) {
+            uint64_t slices = 0;
+            for(size_t i = 0; i < n; i++) {
+                slices += pcbs[3 * i] / quantum + (pcbs[3 * i] % quantum != 0);
+            }
+            fits = slices <= BATCH_MAX_SLICES;
+        }
+        if(!fits) {
+            success = batch_single(&scratch, pcbs, n, policy, quantum, &results[w]);
+            continue;
+        }
+        batch_add(&group, pcbs, n, policy, &results[w]);
+        if(group.lanes == BATCH_LANES) {
+            batch_run(&group, policy, quantum, &costs);
+        }
+    }
+    if(success && group.lanes) {
+        batch_run(&group, policy, quantum, &costs);
+    }
+    dyn_array_destroy(scratch);
+    return success;
+}
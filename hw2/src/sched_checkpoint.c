@@ -0,0 +1,221 @@
+// fork(), fsync() and friends (rename() is stdio)
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "sched_checkpoint.h"
+#include "scheduling_internal.h"
+
+// "SCHDCKP1" read as a little endian word, first in every checkpoint file
+#define CHECKPOINT_MAGIC 0x31504b4344484353ull
+
+// The file: this header, the remaining bursts (pcb count of time_bytes each), then a checksum of both
+typedef struct
+{
+    uint64_t magic;
+    uint64_t identity[5];
+    uint64_t time_bytes;
+    uint64_t time, completed, arrived, pass, sweep, running;
+    uint64_t waiting[2], turnaround[2];     // 128 bit sums, low half first
+    uint64_t count, switches, overhead, last_ran;
+} checkpoint_header_t;
+
+#define CHECKPOINT_HASH_START 0xcbf29ce484222325ull
+#define CHECKPOINT_HASH_PRIME 0x100000001b3ull
+
+// FNV-1a style mixing a word at a time (a byte at a time for what's left over)
+static uint64_t checkpoint_hash(uint64_t hash, const void *data, size_t bytes)
+{
+    const unsigned char *at = (const unsigned char *)data;
+    for(; bytes >= sizeof(uint64_t); bytes -= sizeof(uint64_t), at += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, at, sizeof(word));
+        hash = (hash ^ word) * CHECKPOINT_HASH_PRIME;
+    }
+    for(; bytes; bytes--, at++) {
+        hash = (hash ^ *at) * CHECKPOINT_HASH_PRIME;
+    }
+    return hash;
+}
+
+// Hash of the PCBs' fields (not their padding), so a checkpoint is only resumed on the trace it came from
+static uint64_t checkpoint_trace_hash(const ProcessControlBlock_t *pcbs, size_t n)
+{
+    uint64_t hash = CHECKPOINT_HASH_START;
+    for(size_t i = 0; i < n; i++) {
+        uint64_t word = (uint64_t)pcbs[i].remaining_burst_time << 32 | pcbs[i].priority;
+        hash = (hash ^ word) * CHECKPOINT_HASH_PRIME;
+        hash = (hash ^ pcbs[i].arrival) * CHECKPOINT_HASH_PRIME;
+    }
+    return hash;
+}
+
+static bool checkpoint_write_all(int fd, const void *data, size_t bytes)
+{
+    const char *at = (const char *)data;
+    while(bytes) {
+        ssize_t done = write(fd, at, bytes);
+        if(done < 0 && errno == EINTR) continue;
+        if(done <= 0) return false;
+        at += done;
+        bytes -= (size_t)done;
+    }
+    return true;
+}
+
+static bool checkpoint_read_all(int fd, void *data, size_t bytes)
+{
+    char *at = (char *)data;
+    while(bytes) {
+        ssize_t done = read(fd, at, bytes);
+        if(done < 0 && errno == EINTR) continue;
+        if(done <= 0) return false;
+        at += done;
+        bytes -= (size_t)done;
+    }
+    return true;
+}
+
+// Writes a whole checkpoint to the temporary file and renames it into place.
+// Runs in the forked child, so it sticks to system calls (no stdio streams, no malloc).
+static bool checkpoint_write(const sched_checkpoint_run_t *run, const sched_run_state_t *state, const void *remaining)
+{
+    checkpoint_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CHECKPOINT_MAGIC;
+    memcpy(header.identity, run->identity, sizeof(header.identity));
+    header.time_bytes = run->time_bytes;
+    header.time = state->time;
+    header.completed = state->completed;
+    header.arrived = state->arrived;
+    header.pass = state->pass;
+    header.sweep = state->sweep;
+    header.running = state->running;
+    header.waiting[0] = (uint64_t)state->totals.waiting;
+    header.waiting[1] = (uint64_t)(state->totals.waiting >> 64);
+    header.turnaround[0] = (uint64_t)state->totals.turnaround;
+    header.turnaround[1] = (uint64_t)(state->totals.turnaround >> 64);
+    header.count = state->totals.count;
+    header.switches = state->totals.switches;
+    header.overhead = state->totals.overhead;
+    header.last_ran = state->totals.last_ran;
+
+    size_t bytes = run->identity[2] * run->time_bytes;
+    uint64_t sum = checkpoint_hash(checkpoint_hash(CHECKPOINT_HASH_START, &header, sizeof(header)), remaining, bytes);
+    int fd = open(run->temp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) return false;
+    bool ok = checkpoint_write_all(fd, &header, sizeof(header)) && checkpoint_write_all(fd, remaining, bytes)
+              && checkpoint_write_all(fd, &sum, sizeof(sum)) && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    return ok && rename(run->temp_path, run->options->path) == 0;
+}
+
+// Collects the child writing the last save. false if it is still going (only when not blocking).
+static bool checkpoint_reap(sched_checkpoint_run_t *run, bool block)
+{
+    int status = 0;
+    pid_t done;
+    do {
+        done = waitpid(run->child, &status, block ? 0 : WNOHANG);
+    } while(done < 0 && errno == EINTR);
+    if(done == 0) return false;
+    if(done == run->child && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) {
+        run->options->written++;
+    }
+    run->child = 0;
+    return true;
+}
+
+bool sched_checkpoint_open(sched_checkpoint_run_t *run, sched_checkpoint_t *options, sched_engine_policy_t policy,
+                           const ProcessControlBlock_t *pcbs, size_t n, size_t quantum, size_t time_bytes)
+{
+    if(!run || !options || !options->path || !pcbs) return false;
+    size_t length = strlen(options->path);
+    run->temp_path = (char *)SCHED_MALLOC(length + sizeof(".tmp"));
+    if(!run->temp_path) return false;
+    memcpy(run->temp_path, options->path, length);
+    memcpy(run->temp_path + length, ".tmp", sizeof(".tmp"));
+
+    ScheduleOverhead_t costs = get_schedule_overhead();
+    run->identity[0] = policy;
+    run->identity[1] = quantum;
+    run->identity[2] = n;
+    run->identity[3] = (uint64_t)costs.context_switch_cost << 32 | costs.dispatch_cost;
+    run->identity[4] = checkpoint_trace_hash(pcbs, n);
+    run->time_bytes = time_bytes;
+    run->options = options;
+    run->child = 0;
+    options->resumed = false;
+    options->written = 0;
+    return true;
+}
+
+bool sched_checkpoint_restore(sched_checkpoint_run_t *run, sched_run_state_t *state, void *remaining)
+{
+    if(!run->options->resume) return true;
+    int fd = open(run->options->path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return errno == ENOENT;     // nothing saved yet, start from the beginning
+
+    checkpoint_header_t header;
+    uint64_t sum = 0;
+    char extra;
+    size_t n = run->identity[2];
+    size_t bytes = n * run->time_bytes;
+    bool ok = checkpoint_read_all(fd, &header, sizeof(header)) && header.magic == CHECKPOINT_MAGIC
+              && memcmp(header.identity, run->identity, sizeof(header.identity)) == 0
+              && header.time_bytes == run->time_bytes
+              && checkpoint_read_all(fd, remaining, bytes) && checkpoint_read_all(fd, &sum, sizeof(sum))
+              && read(fd, &extra, 1) == 0
+              && sum == checkpoint_hash(checkpoint_hash(CHECKPOINT_HASH_START, &header, sizeof(header)), remaining, bytes)
+              && header.completed <= n && header.arrived <= n && header.sweep <= n
+              && (header.running == UINT64_MAX || header.running < n);
+    close(fd);
+    if(!ok) return false;
+
+    totals_init(&state->totals);
+    state->time = header.time;
+    state->completed = header.completed;
+    state->arrived = header.arrived;
+    state->pass = header.pass;
+    state->sweep = header.sweep;
+    state->running = header.running;
+    state->totals.waiting = (sched_sum_t)header.waiting[1] << 64 | header.waiting[0];
+    state->totals.turnaround = (sched_sum_t)header.turnaround[1] << 64 | header.turnaround[0];
+    state->totals.count = header.count;
+    state->totals.switches = header.switches;
+    state->totals.overhead = header.overhead;
+    state->totals.last_ran = header.last_ran;
+    run->options->resumed = true;
+    return true;
+}
+
+void sched_checkpoint_save(sched_checkpoint_run_t *run, const sched_run_state_t *state, const void *remaining)
+{
+    if(run->child > 0 && !checkpoint_reap(run, false)) {
+        return;     // the last save is still being written, skip this one rather than wait for it
+    }
+    // the child gets a copy-on-write snapshot of the state to write out, the simulation goes on here
+    pid_t child = fork();
+    if(child == 0) {
+        _exit(checkpoint_write(run, state, remaining) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    if(child > 0) {
+        run->child = child;
+    }
+    else if(checkpoint_write(run, state, remaining)) {
+        run->options->written++;
+    }
+}
+
+void sched_checkpoint_close(sched_checkpoint_run_t *run)
+{
+    if(run->child > 0) {
+        checkpoint_reap(run, true);
+    }
+    free(run->temp_path);
+    run->temp_path = NULL;
+}
@@ -0,0 +1,1029 @@
+// The sequential scheduling engine.
+//
+// Every policy is the same event loop: admit whatever has arrived into a ready heap, pick the
+// smallest entry, charge the dispatch, run it for as long as its preemption rule allows, repeat.
+// What differs between policies is only how a ready entry is keyed and when a running process
+// has to give the CPU back, so those are template parameters. Each instantiation gets its own
+// copy of the loop with the key comparisons inlined and the branches for other preemption
+// rules compiled away. The time type is a parameter too: traces whose clock provably fits in
+// 32 bits run with 12 byte heap entries instead of 16. So is the ready queue: a binary heap by
+// default, a bucket queue when priorities span only a few levels, a radix heap for SJF and SRT.
+//
+// A new policy is a struct with its queue flags, an entry() function and one line in sched_engine_run().
+//
+// Preemptive runs can be checkpointed (sched_checkpoint.h): every so many dispatches the loop hands
+// its state to sched_checkpoint_save, and a resumed run restores it and rebuilds the ready queue.
+//
+// I/O traces (io_scheduling.h) run the same policies and preemption rules through IoRun, a loop
+// that also has devices to keep track of.
+
+#include <algorithm>
+
+#include "dyn_deque.h"
+#include "scheduling_internal.h"
+
+namespace {
+
+// A ready process as the heap sees it: ordered by key, then tie (both chosen by the policy)
+template <typename Time>
+struct Entry {
+    Time key;
+    uint32_t tie;
+    uint32_t index;
+};
+
+template <typename Time>
+inline bool entry_less(const Entry<Time> &a, const Entry<Time> &b)
+{
+    SCHED_STAT_ADD(comparisons, 1);
+    return a.key < b.key || (a.key == b.key && a.tie < b.tie);
+}
+
+// Key range of the PCBs a run schedules, for queues that index by key
+struct KeyRange {
+    sched_time_t low, high;
+};
+
+// Ready queues. Each takes its storage from the workspace and says whether it got it with ok().
+
+// Binary min-heap, works for any keys (room for every PCB, each is in it at most once)
+template <typename Time>
+class ReadyHeap {
+public:
+    // sized for the widest instantiation so switching time types never regrows the workspace
+    ReadyHeap(sched_workspace_t *ws, size_t n, const KeyRange &)
+        : heap_((Entry<Time> *)sched_ws_buffer(ws, SCHED_WS_HEAP, n * sizeof(Entry<sched_time_t>))), size_(0) {}
+
+    bool ok() const { return heap_ != NULL; }
+    bool empty() const { return size_ == 0; }
+    const Entry<Time> &top() const { return heap_[0]; }
+
+    void push(const Entry<Time> &entry)
+    {
+        size_t hole = size_++;
+        while (hole > 0 && entry_less(entry, heap_[(hole - 1) / 2])) {
+            heap_[hole] = heap_[(hole - 1) / 2];
+            hole = (hole - 1) / 2;
+        }
+        heap_[hole] = entry;
+    }
+
+    Entry<Time> pop()
+    {
+        Entry<Time> smallest = heap_[0];
+        Entry<Time> last = heap_[--size_];
+        size_t hole = 0;
+        for (;;) {
+            size_t child = 2 * hole + 1;
+            if (child >= size_) break;
+            if (child + 1 < size_ && entry_less(heap_[child + 1], heap_[child])) child++;
+            if (!entry_less(heap_[child], last)) break;
+            heap_[hole] = heap_[child];
+            hole = child;
+        }
+        heap_[hole] = last;
+        return smallest;
+    }
+
+private:
+    Entry<Time> *heap_;
+    size_t size_;
+};
+
+// Bucket queue for keys in a small range whose ties are the index (priority).
+// Every (key, index) pair has a bit, key major, so the lowest set bit is the next entry. Above that
+// bitmap sits a bit per non-empty word, and so on up to a single word: finding the lowest bit is one
+// find-first-set per layer, and a push or pop touches at most one word per layer.
+static const size_t SCHED_BUCKET_LEVELS = 64;   // widest key range worth it, as many bits per PCB
+
+static size_t bucket_words(sched_sum_t bits)
+{
+    size_t words = 0;
+    do {
+        bits = (bits + 63) / 64;
+        words += (size_t)bits;
+    } while (bits > 1);
+    return words;
+}
+
+template <typename Time>
+class BucketQueue {
+public:
+    BucketQueue(sched_workspace_t *ws, size_t n, const KeyRange &keys)
+        : low_(keys.low), n_(n), layers_(0), size_(0)
+    {
+        sched_sum_t bits = (sched_sum_t)(keys.high - keys.low + 1) * n;
+        size_t words = bucket_words(bits);
+        uint64_t *storage = (uint64_t *)sched_ws_buffer(ws, SCHED_WS_BUCKETS, words * sizeof(uint64_t));
+        if (!storage) return;
+        memset(storage, 0, words * sizeof(uint64_t));
+        do {
+            layer_[layers_++] = storage;
+            bits = (bits + 63) / 64;
+            storage += (size_t)bits;
+        } while (bits > 1);
+    }
+
+    bool ok() const { return layers_ != 0; }
+    bool empty() const { return size_ == 0; }
+    Entry<Time> top() const { return unpack(lowest()); }
+
+    void push(const Entry<Time> &entry)
+    {
+        size_t bit = (size_t)(entry.key - low_) * n_ + entry.index;
+        for (size_t layer = 0; layer < layers_; layer++, bit /= 64) {
+            uint64_t was = layer_[layer][bit / 64];
+            layer_[layer][bit / 64] = was | (uint64_t)1 << (bit % 64);
+            if (was) break;     // the layers above already know this word isn't empty
+        }
+        size_++;
+    }
+
+    Entry<Time> pop()
+    {
+        size_t lowest_bit = lowest();
+        for (size_t layer = 0, bit = lowest_bit; layer < layers_; layer++, bit /= 64) {
+            layer_[layer][bit / 64] &= ~((uint64_t)1 << (bit % 64));
+            if (layer_[layer][bit / 64]) break;
+        }
+        size_--;
+        return unpack(lowest_bit);
+    }
+
+private:
+    size_t lowest() const
+    {
+        size_t bit = 0;
+        for (size_t layer = layers_; layer-- > 0;) {
+            bit = bit * 64 + (size_t)__builtin_ctzll(layer_[layer][bit]);
+        }
+        return bit;
+    }
+
+    Entry<Time> unpack(size_t bit) const
+    {
+        uint32_t index = (uint32_t)(bit % n_);
+        return Entry<Time>{(Time)(low_ + bit / n_), index, index};
+    }
+
+    sched_time_t low_;
+    size_t n_;
+    uint64_t *layer_[8];    // bottom up, 64 levels of 2^32 PCBs is 7 layers
+    size_t layers_;
+    size_t size_;
+};
+
+// Radix heap for 32 bit keys with 32 bit ties (shortest job, shortest remaining), packed into 64.
+// An entry waits in the bucket of the highest bit where it differs from the last minimum, so the
+// next minimum only ever redistributes one bucket and every entry moves at most 64 times.
+// Buckets are lists of fixed size chunks from a pool with room for every PCB, so redistributing
+// reads and writes whole chunks instead of chasing a pointer per entry.
+// It only works while extractions are monotone: nothing smaller than the last minimum may be
+// pushed. A batch that all arrives at once stays monotone. The first push that breaks it (a
+// shorter job arriving later, SRT putting back a preempted process) moves everything into a
+// binary heap, which takes over for the rest of the run.
+static const size_t SCHED_RADIX_CHUNK = 64;
+
+struct RadixChunk {
+    uint64_t keys[SCHED_RADIX_CHUNK];
+    uint32_t indexes[SCHED_RADIX_CHUNK];
+    uint32_t next;
+    uint32_t count;
+};
+
+// Every bucket has at most one chunk that isn't full, plus one chunk being emptied while it's redistributed
+static size_t radix_chunks(size_t n)
+{
+    return (n + SCHED_RADIX_CHUNK - 1) / SCHED_RADIX_CHUNK + 66;
+}
+
+template <typename Time>
+class RadixHeap {
+public:
+    RadixHeap(sched_workspace_t *ws, size_t n, const KeyRange &keys)
+        : chunks_((RadixChunk *)sched_ws_buffer(ws, SCHED_WS_RADIX, radix_chunks(n) * sizeof(RadixChunk))),
+          fallback_(ws, n, keys), free_(NIL), radix_(true), last_(0), occupied_(0), size_(0)
+    {
+        for (size_t bucket = 0; bucket < 65; bucket++) {
+            head_[bucket] = tail_[bucket] = NIL;
+        }
+        for (size_t chunk = 0; chunks_ && chunk < radix_chunks(n); chunk++) {
+            release(chunk);
+        }
+    }
+
+    bool ok() const { return chunks_ && fallback_.ok(); }
+    bool empty() const { return radix_ ? size_ == 0 : fallback_.empty(); }
+
+    Entry<Time> top()
+    {
+        if (!radix_) return fallback_.top();
+        settle();
+        return unpack(chunks_[head_[0]], 0);
+    }
+
+    void push(const Entry<Time> &entry)
+    {
+        uint64_t key = (uint64_t)entry.key << 32 | entry.tie;
+        if (radix_ && key < last_) {
+            spill();
+        }
+        if (!radix_) {
+            fallback_.push(entry);
+            return;
+        }
+        link(key, entry.index);
+        size_++;
+    }
+
+    Entry<Time> pop()
+    {
+        if (!radix_) return fallback_.pop();
+        settle();
+        // keys are unique, so bucket 0 holds just the minimum
+        uint32_t chunk = head_[0];
+        Entry<Time> smallest = unpack(chunks_[chunk], 0);
+        head_[0] = tail_[0] = NIL;
+        release(chunk);
+        size_--;
+        return smallest;
+    }
+
+private:
+    static const uint32_t NIL = UINT32_MAX;
+
+    void release(size_t chunk)
+    {
+        chunks_[chunk].next = free_;
+        free_ = (uint32_t)chunk;
+    }
+
+    void link(uint64_t key, uint32_t index)
+    {
+        size_t bucket = key == last_ ? 0 : 64 - (size_t)__builtin_clzll(key ^ last_);
+        uint32_t tail = tail_[bucket];
+        if (tail == NIL || chunks_[tail].count == SCHED_RADIX_CHUNK) {
+            uint32_t fresh = free_;
+            free_ = chunks_[fresh].next;
+            chunks_[fresh].next = NIL;
+            chunks_[fresh].count = 0;
+            if (tail == NIL) {
+                head_[bucket] = fresh;
+            }
+            else {
+                chunks_[tail].next = fresh;
+            }
+            tail_[bucket] = tail = fresh;
+        }
+        RadixChunk &chunk = chunks_[tail];
+        chunk.keys[chunk.count] = key;
+        chunk.indexes[chunk.count++] = index;
+        if (bucket) occupied_ |= (uint64_t)1 << (bucket - 1);
+    }
+
+    // Makes the minimum the new last one and redistributes its bucket, which leaves it alone in bucket 0
+    void settle()
+    {
+        if (head_[0] != NIL) return;
+        size_t bucket = (size_t)__builtin_ctzll(occupied_) + 1;
+        uint32_t chunk = head_[bucket];
+        head_[bucket] = tail_[bucket] = NIL;
+        occupied_ &= ~((uint64_t)1 << (bucket - 1));
+        last_ = UINT64_MAX;
+        for (uint32_t at = chunk; at != NIL; at = chunks_[at].next) {
+            for (uint32_t slot = 0; slot < chunks_[at].count; slot++) {
+                if (chunks_[at].keys[slot] < last_) last_ = chunks_[at].keys[slot];
+            }
+        }
+        while (chunk != NIL) {
+            const RadixChunk &from = chunks_[chunk];
+            for (uint32_t slot = 0; slot < from.count; slot++) {
+                link(from.keys[slot], from.indexes[slot]);
+            }
+            uint32_t next = from.next;
+            release(chunk);
+            chunk = next;
+        }
+    }
+
+    void spill()
+    {
+        for (size_t bucket = 0; bucket < 65; bucket++) {
+            for (uint32_t chunk = head_[bucket]; chunk != NIL; chunk = chunks_[chunk].next) {
+                for (uint32_t slot = 0; slot < chunks_[chunk].count; slot++) {
+                    fallback_.push(unpack(chunks_[chunk], slot));
+                }
+            }
+        }
+        radix_ = false;
+    }
+
+    static Entry<Time> unpack(const RadixChunk &chunk, uint32_t slot)
+    {
+        return Entry<Time>{(Time)(chunk.keys[slot] >> 32), (uint32_t)chunk.keys[slot], chunk.indexes[slot]};
+    }
+
+    RadixChunk *chunks_;
+    ReadyHeap<Time> fallback_;
+    uint32_t free_;             // chunks not in any bucket
+    bool radix_;                // still monotone
+    uint64_t last_;             // last minimum
+    uint64_t occupied_;         // bit b - 1 set when bucket b (1 to 64) isn't empty
+    uint32_t head_[65];
+    uint32_t tail_[65];
+    size_t size_;
+};
+
+// Selection policies. rank is the position in arrival order, remaining the burst still to run,
+// pass the round robin sweep the entry belongs to.
+// bucketed: keys are a PCB field in a small range with index ties, worth a BucketQueue when it is
+// radix:    key and tie both fit 32 bits and usually come out in increasing order, worth a RadixHeap
+
+struct FirstCome {      // earliest arrival, ties by index (the arrival order already breaks them)
+    static const bool bucketed = false, radix = false;
+    template <typename Time>
+    static Entry<Time> entry(const ProcessControlBlock_t &, uint32_t index, uint32_t rank, Time, Time)
+    {
+        return Entry<Time>{0, rank, index};
+    }
+};
+
+struct ShortestJob {    // shortest burst, ties to the earliest arrival
+    static const bool bucketed = false, radix = true;
+    template <typename Time>
+    static Entry<Time> entry(const ProcessControlBlock_t &pcb, uint32_t index, uint32_t rank, Time, Time)
+    {
+        return Entry<Time>{pcb.remaining_burst_time, rank, index};
+    }
+};
+
+struct HighestPriority { // lowest priority number, ties by index
+    static const bool bucketed = true, radix = false;
+    static uint32_t field(const ProcessControlBlock_t &pcb) { return pcb.priority; }
+    template <typename Time>
+    static Entry<Time> entry(const ProcessControlBlock_t &pcb, uint32_t index, uint32_t, Time, Time)
+    {
+        return Entry<Time>{pcb.priority, index, index};
+    }
+};
+
+struct ShortestRemaining { // least remaining burst, ties by index
+    static const bool bucketed = false, radix = true;
+    template <typename Time>
+    static Entry<Time> entry(const ProcessControlBlock_t &, uint32_t index, uint32_t, Time remaining, Time)
+    {
+        return Entry<Time>{remaining, index, index};
+    }
+};
+
+struct IndexSweep {     // round robin's sweep: everything in this pass by index, then the next pass
+    static const bool bucketed = false, radix = false;
+    template <typename Time>
+    static Entry<Time> entry(const ProcessControlBlock_t &, uint32_t index, uint32_t, Time, Time pass)
+    {
+        return Entry<Time>{pass, index, index};
+    }
+};
+
+// Preemption rules.
+// preemptive: bursts are tracked as remaining time, and empty bursts are done on arrival without a dispatch
+// on_arrival: the running process is checked against the ready ones whenever something arrives,
+//             and only a change of process is a dispatch
+// sliced:     every dispatch runs for at most a quantum, then the process goes back in the heap
+
+struct RunToCompletion {
+    static const bool preemptive = false, on_arrival = false, sliced = false;
+};
+
+struct PreemptOnArrival {
+    static const bool preemptive = true, on_arrival = true, sliced = false;
+};
+
+struct TimeSlice {
+    static const bool preemptive = true, on_arrival = false, sliced = true;
+};
+
+template <typename Time, typename Policy, typename Preemption, typename Queue>
+bool run(const ProcessControlBlock_t *pcbs, const uint32_t *by_arrival, size_t n, size_t quantum,
+         const KeyRange &keys, ScheduleResult_t *result, sched_workspace_t *ws, sched_checkpoint_t *checkpoint)
+{
+    Queue ready(ws, n, keys);
+    Time *remaining = Preemption::preemptive
+        ? (Time *)sched_ws_buffer(ws, SCHED_WS_TIMES, n * sizeof(sched_time_t)) : NULL;
+    if (!ready.ok() || (Preemption::preemptive && !remaining)) return false;
+
+    schedule_totals_t totals;
+    totals_init(&totals);
+    const Time slice_limit = quantum < (Time)-1 ? (Time)quantum : (Time)-1;
+
+    Time time = 0;
+    size_t completed = 0;
+    size_t arrived = 0;        // everything before this in by_arrival has been admitted (or was empty)
+    Time pass = 0;             // round robin sweep in progress
+    size_t sweep = 0;          // indexes below this have had their turn in this pass
+    size_t running = SIZE_MAX; // on_arrival: unfinished process holding the CPU
+
+    // only preemptive runs are checkpointed, the others have no remaining bursts to save
+    sched_checkpoint_run_t saver;
+    sched_run_state_t state;
+    if (checkpoint) {
+        const sched_engine_policy_t policy = Preemption::sliced ? SCHED_ENGINE_RR : SCHED_ENGINE_SRT;
+        if (!Preemption::preemptive || !sched_checkpoint_open(&saver, checkpoint, policy, pcbs, n, quantum, sizeof(Time))) {
+            return false;
+        }
+        if (!sched_checkpoint_restore(&saver, &state, remaining)) {
+            sched_checkpoint_close(&saver);
+            return false;
+        }
+    }
+    const uint64_t save_every = Preemption::preemptive && checkpoint ? checkpoint->every : 0;
+    uint64_t since_save = 0;
+
+    if (Preemption::preemptive && checkpoint && checkpoint->resumed) {
+        time = (Time)state.time;
+        completed = state.completed;
+        arrived = state.arrived;
+        pass = (Time)state.pass;
+        sweep = state.sweep;
+        running = state.running;
+        totals = state.totals;
+        // the queue held every admitted PCB with work left but the running one, and a round robin
+        // entry is in the next pass exactly when the sweep has already gone past its index
+        for (size_t i = 0; i < arrived; i++) {
+            uint32_t index = by_arrival[i];
+            if (!remaining[index] || index == running) continue;
+            Time entry_pass = Preemption::sliced && index < sweep ? pass + 1 : pass;
+            ready.push(Policy::template entry<Time>(pcbs[index], index, (uint32_t)i, remaining[index], entry_pass));
+        }
+    }
+    else if (Preemption::preemptive) {
+        for (size_t i = 0; i < n; i++) {
+            remaining[i] = pcbs[i].remaining_burst_time;
+            if (!remaining[i]) {
+                totals_record(&totals, pcbs[i].arrival, 0, pcbs[i].arrival);
+                completed++;
+            }
+        }
+    }
+
+    while (completed < n) {
+        for (; arrived < n && pcbs[by_arrival[arrived]].arrival <= time; arrived++) {
+            uint32_t index = by_arrival[arrived];
+            if (Preemption::preemptive && !remaining[index]) continue;
+            SCHED_STAT_ADD(pcbs_scanned, 1);
+            // arrivals the sweep has already gone past wait for the next pass
+            Time entry_pass = Preemption::sliced && index < sweep ? pass + 1 : pass;
+            ready.push(Policy::template entry<Time>(pcbs[index], index, (uint32_t)arrived,
+                                                   Preemption::preemptive ? remaining[index] : 0, entry_pass));
+        }
+
+        Entry<Time> chosen;
+        if (Preemption::on_arrival && running != SIZE_MAX) {
+            chosen = Policy::template entry<Time>(pcbs[running], (uint32_t)running, 0, remaining[running], 0);
+            if (!ready.empty() && entry_less(ready.top(), chosen)) {
+                ready.push(chosen);
+                chosen = ready.pop();
+            }
+        }
+        else if (ready.empty()) {
+            // idle until the next arrival that has something to run
+            while (Preemption::preemptive && !remaining[by_arrival[arrived]]) arrived++;
+            Time next = pcbs[by_arrival[arrived]].arrival;
+            SCHED_STAT_CLOCK(next - time);
+            time = next;
+            if (Preemption::sliced) {
+                pass++;
+                sweep = 0;
+            }
+            continue;
+        }
+        else {
+            chosen = ready.pop();
+        }
+
+        SCHED_STAT_ADD(pcbs_scanned, 1);
+        const size_t index = chosen.index;
+        const ProcessControlBlock_t &pcb = pcbs[index];
+        if (!Preemption::on_arrival || index != running) {
+            time += charge_dispatch(&totals, index);
+        }
+
+        Time slice = Preemption::preemptive ? remaining[index] : pcb.remaining_burst_time;
+        if (Preemption::sliced && slice > slice_limit) {
+            slice = slice_limit;
+        }
+        if (Preemption::on_arrival) {
+            // run until the next arrival with work could change the choice (at least one unit)
+            while (arrived < n && !remaining[by_arrival[arrived]]) arrived++;
+            if (arrived < n) {
+                Time next = pcbs[by_arrival[arrived]].arrival;
+                Time until = next > time ? next - time : 1;
+                if (until < slice) slice = until;
+            }
+        }
+        SCHED_STAT_CLOCK(slice);
+        time += slice;
+
+        if (Preemption::preemptive) {
+            remaining[index] -= slice;
+        }
+        if (Preemption::sliced) {
+            pass = chosen.key;
+            sweep = index + 1;
+        }
+        if (!Preemption::preemptive || !remaining[index]) {
+            totals_record(&totals, pcb.arrival, pcb.remaining_burst_time, time);
+            completed++;
+            running = SIZE_MAX;
+        }
+        else if (Preemption::sliced) {
+            ready.push(Policy::template entry<Time>(pcb, (uint32_t)index, 0, remaining[index], pass + 1));
+        }
+        else {
+            running = index;
+        }
+
+        if (save_every && ++since_save == save_every) {
+            since_save = 0;
+            state.time = time;
+            state.completed = completed;
+            state.arrived = arrived;
+            state.pass = pass;
+            state.sweep = sweep;
+            state.running = running;
+            state.totals = totals;
+            sched_checkpoint_save(&saver, &state, remaining);
+        }
+    }
+
+    totals_finish(&totals, time, result);
+    if (checkpoint) {
+        sched_checkpoint_close(&saver);
+    }
+    return true;
+}
+
+// Largest clock value a run could reach: every arrival, every burst and every dispatch's overhead
+template <typename Preemption>
+sched_sum_t clock_bound(const ProcessControlBlock_t *pcbs, size_t n, size_t quantum)
+{
+    sched_sum_t bursts = 0;
+    sched_time_t last_arrival = 0;
+    for (size_t i = 0; i < n; i++) {
+        bursts += pcbs[i].remaining_burst_time;
+        if (pcbs[i].arrival > last_arrival) last_arrival = pcbs[i].arrival;
+    }
+    // a dispatch per process, per arrival that preempts, or per slice
+    sched_sum_t dispatches = Preemption::sliced ? bursts / quantum + n : Preemption::on_arrival ? 2 * (sched_sum_t)n : n;
+    ScheduleOverhead_t costs = get_schedule_overhead();
+    return last_arrival + bursts + dispatches * ((sched_sum_t)costs.context_switch_cost + costs.dispatch_cost);
+}
+
+template <template <typename> class Queue, typename Policy, typename Preemption>
+bool run_sized(pcb_view_t *view, size_t quantum, const KeyRange &keys, ScheduleResult_t *result, sched_workspace_t *ws,
+               sched_checkpoint_t *checkpoint)
+{
+    const uint32_t *by_arrival = pcb_view_order(view, PCB_ORDER_ARRIVAL);
+    if (!by_arrival) return false;
+    const ProcessControlBlock_t *pcbs = pcb_view_pcbs(view);
+    size_t n = pcb_view_size(view);
+    if (clock_bound<Preemption>(pcbs, n, quantum) <= UINT32_MAX) {
+        return run<uint32_t, Policy, Preemption, Queue<uint32_t> >(pcbs, by_arrival, n, quantum, keys, result, ws, checkpoint);
+    }
+    return run<sched_time_t, Policy, Preemption, Queue<sched_time_t> >(pcbs, by_arrival, n, quantum, keys, result, ws, checkpoint);
+}
+
+// Range of the policy's key field over the PCBs
+template <typename Policy>
+KeyRange key_range(const ProcessControlBlock_t *pcbs, size_t n)
+{
+    KeyRange keys = {Policy::field(pcbs[0]), Policy::field(pcbs[0])};
+    for (size_t i = 1; i < n; i++) {
+        sched_time_t key = Policy::field(pcbs[i]);
+        if (key < keys.low) keys.low = key;
+        if (key > keys.high) keys.high = key;
+    }
+    return keys;
+}
+
+// Picks the ready queue from the policy's keys: a binary heap unless they suit something cheaper
+template <typename Policy, typename Preemption, bool bucketed = Policy::bucketed, bool radix = Policy::radix>
+struct QueueChoice {
+    static bool run(pcb_view_t *view, size_t quantum, ScheduleResult_t *result, sched_workspace_t *ws,
+                    sched_checkpoint_t *checkpoint)
+    {
+        const KeyRange keys = {0, 0};
+        return run_sized<ReadyHeap, Policy, Preemption>(view, quantum, keys, result, ws, checkpoint);
+    }
+};
+
+template <typename Policy, typename Preemption>
+struct QueueChoice<Policy, Preemption, false, true> {
+    static bool run(pcb_view_t *view, size_t quantum, ScheduleResult_t *result, sched_workspace_t *ws,
+                    sched_checkpoint_t *checkpoint)
+    {
+        const KeyRange keys = {0, 0};
+        return run_sized<RadixHeap, Policy, Preemption>(view, quantum, keys, result, ws, checkpoint);
+    }
+};
+
+// buckets only when the range is small enough, it costs a bit per PCB per key in it
+template <typename Policy, typename Preemption>
+struct QueueChoice<Policy, Preemption, true, false> {
+    static bool run(pcb_view_t *view, size_t quantum, ScheduleResult_t *result, sched_workspace_t *ws,
+                    sched_checkpoint_t *checkpoint)
+    {
+        const KeyRange keys = key_range<Policy>(pcb_view_pcbs(view), pcb_view_size(view));
+        if (keys.high - keys.low < SCHED_BUCKET_LEVELS) {
+            return run_sized<BucketQueue, Policy, Preemption>(view, quantum, keys, result, ws, checkpoint);
+        }
+        return run_sized<ReadyHeap, Policy, Preemption>(view, quantum, keys, result, ws, checkpoint);
+    }
+};
+
+// I/O traces: processes alternate CPU bursts with I/O bursts on FIFO devices.
+// Each CPU burst joins the ready queue as if it were a PCB of its own, ranked by when it became
+// ready. Arrivals come from the trace in (arrival, index) order and I/O completions from a timing
+// wheel, where a process's pending completion is filed under its index.
+struct IoJob {
+    sched_time_t remaining;     // of the current CPU burst
+    sched_time_t queued_at;     // when it joined its device's queue
+    sched_time_t device_wait;   // time spent queued for devices so far
+    uint32_t phase;             // current phase, phase_count once done
+};
+
+struct IoDevice {
+    dyn_deque_t *queue;         // processes waiting for it (uint32_t), created the first time one has to wait
+    uint32_t job;               // process on it
+    bool busy;
+};
+
+template <typename Policy, typename Preemption>
+class IoRun {
+public:
+    IoRun(const IoTrace_t *trace, size_t quantum, sched_workspace_t *ws)
+        : processes_((const IoProcess_t *)dyn_array_contents(trace->processes)),
+          phases_((const IoPhase_t *)dyn_array_contents(trace->phases)),
+          n_(dyn_array_size(trace->processes)),
+          device_count_(trace->device_count),
+          slice_limit_(quantum),
+          ready_(ws, n_, KeyRange()),
+          jobs_((IoJob *)sched_ws_buffer(ws, SCHED_WS_JOBS, n_ * sizeof(IoJob))),
+          by_arrival_((uint64_t *)sched_ws_buffer(ws, SCHED_WS_KEYS, n_ * sizeof(uint64_t))),
+          batch_((uint32_t *)sched_ws_buffer(ws, SCHED_WS_INDEX, n_ * sizeof(uint32_t))),
+          wheel_(sched_ws_wheel(ws, n_, 0)),
+          devices_(device_count_ ? (IoDevice *)SCHED_CALLOC(device_count_, sizeof(IoDevice)) : NULL) {}
+
+    ~IoRun()
+    {
+        for (size_t d = 0; devices_ && d < device_count_; d++) {
+            dyn_deque_destroy(devices_[d].queue);
+        }
+        free(devices_);
+    }
+
+    bool ok() const
+    {
+        return ready_.ok() && jobs_ && by_arrival_ && batch_ && wheel_ && (devices_ || !device_count_);
+    }
+
+    bool run(IoScheduleResult_t *result)
+    {
+        totals_init(&totals_);
+        for (size_t i = 0; i < n_; i++) {
+            by_arrival_[i] = (uint64_t)processes_[i].arrival << 32 | i;
+            jobs_[i].device_wait = 0;
+            jobs_[i].phase = 0;
+        }
+        std::sort(by_arrival_, by_arrival_ + n_);
+
+        while (completed_ < n_) {
+            if (!events(time_)) return false;
+            // the burst on the CPU ends after everything else that happens at the same time
+            if (segment_ != NONE && !end_segment()) return false;
+            if (completed_ == n_) break;
+
+            Entry<sched_time_t> chosen;
+            if (Preemption::on_arrival && running_ != NONE) {
+                chosen = entry(running_, 0, 0);
+                if (!ready_.empty() && entry_less(ready_.top(), chosen)) {
+                    ready_.push(chosen);
+                    chosen = ready_.pop();
+                }
+            }
+            else if (ready_.empty()) {
+                // idle until something arrives or comes back from a device (every unfinished process
+                // that isn't ready is doing one or the other, or queued behind a device that's busy)
+                sched_time_t next;
+                if (!next_event(&next)) return false;
+                SCHED_STAT_CLOCK(next - time_);
+                time_ = next;
+                if (Preemption::sliced) {
+                    pass_++;
+                    sweep_ = 0;
+                }
+                continue;
+            }
+            else {
+                chosen = ready_.pop();
+            }
+
+            SCHED_STAT_ADD(pcbs_scanned, 1);
+            const uint32_t index = chosen.index;
+            if (!Preemption::on_arrival || index != running_) {
+                time_ += charge_dispatch(&totals_, index);
+            }
+            running_ = NONE;
+
+            sched_time_t slice = jobs_[index].remaining;
+            if (Preemption::sliced && slice > slice_limit_) {
+                slice = slice_limit_;
+            }
+            sched_time_t next;
+            if (Preemption::on_arrival && next_event(&next)) {
+                // run until the next arrival or I/O completion could change the choice (at least one unit)
+                sched_time_t until = next > time_ ? next - time_ : 1;
+                if (until < slice) slice = until;
+            }
+            SCHED_STAT_CLOCK(slice);
+            cpu_before_ += run_length_;
+            run_start_ = time_;
+            run_length_ = slice;
+            time_ += slice;
+            jobs_[index].remaining -= slice;
+            if (Preemption::sliced) {
+                pass_ = chosen.key;
+                sweep_ = index + 1;
+            }
+            segment_ = index;
+        }
+
+        totals_finish(&totals_, time_, &result->schedule);
+        result->cpu_busy_time = cpu_before_ + run_length_;
+        result->io_busy_time = io_busy_;
+        result->io_overlap_time = io_overlap_;
+        result->device_wait_time = device_wait_;
+        result->cpu_utilization = time_ ? (double)result->cpu_busy_time / (double)time_ : 0.0;
+        result->io_overlap = io_busy_ ? (double)io_overlap_ / (double)io_busy_ : 0.0;
+        return true;
+    }
+
+private:
+    static const uint32_t NONE = UINT32_MAX;
+
+    const IoPhase_t &phase(uint32_t index) const
+    {
+        return phases_[processes_[index].first_phase + jobs_[index].phase];
+    }
+
+    Entry<sched_time_t> entry(uint32_t index, uint32_t rank, sched_time_t pass) const
+    {
+        const IoProcess_t &process = processes_[index];
+        const ProcessControlBlock_t pcb = {phase(index).cpu, process.priority, process.arrival, false};
+        return Policy::template entry<sched_time_t>(pcb, index, rank, jobs_[index].remaining, pass);
+    }
+
+    // Earliest arrival or I/O completion still to come, false if there is none
+    bool next_event(sched_time_t *next)
+    {
+        bool found = timing_wheel_next_expiry(wheel_, next);
+        if (arrived_ < n_ && (!found || by_arrival_[arrived_] >> 32 < *next)) {
+            *next = by_arrival_[arrived_] >> 32;
+            found = true;
+        }
+        return found;
+    }
+
+    // Handles every I/O completion and arrival up to time t, in time order
+    bool events(sched_time_t t)
+    {
+        for (;;) {
+            sched_time_t io_at = 0;
+            sched_time_t arrival_at = arrived_ < n_ ? by_arrival_[arrived_] >> 32 : 0;
+            bool io = timing_wheel_next_expiry(wheel_, &io_at) && io_at <= t;
+            bool arrival = arrived_ < n_ && arrival_at <= t;
+            if (io && (!arrival || io_at <= arrival_at)) {
+                // completions at the same time go by process index
+                size_t count = 0;
+                uint32_t index;
+                while (timing_wheel_expire(wheel_, io_at, &index, NULL)) {
+                    batch_[count++] = index;
+                }
+                std::sort(batch_, batch_ + count);
+                for (size_t i = 0; i < count; i++) {
+                    if (!io_done(batch_[i], io_at)) return false;
+                }
+            }
+            else if (arrival) {
+                if (!enter_phase((uint32_t)by_arrival_[arrived_++], arrival_at)) return false;
+            }
+            else {
+                return true;
+            }
+        }
+    }
+
+    // The CPU burst that ran up to time_ stops: finished, sliced, or waiting to see if it keeps the CPU
+    bool end_segment()
+    {
+        const uint32_t index = segment_;
+        segment_ = NONE;
+        if (jobs_[index].remaining) {
+            if (Preemption::sliced) {
+                ready_.push(entry(index, 0, pass_ + 1));
+            }
+            else {
+                running_ = index;
+            }
+            return true;
+        }
+        if (phase(index).io) return start_io(index, time_);
+        jobs_[index].phase++;
+        return enter_phase(index, time_);
+    }
+
+    // Moves a process into its current phase at time t: ready for the CPU, off to a device, or done
+    bool enter_phase(uint32_t index, sched_time_t t)
+    {
+        for (; jobs_[index].phase < processes_[index].phase_count; jobs_[index].phase++) {
+            const IoPhase_t &current = phase(index);
+            if (current.cpu) {
+                make_ready(index);
+                return true;
+            }
+            if (current.io) return start_io(index, t);
+        }
+        finish(index, t);
+        return true;
+    }
+
+    void make_ready(uint32_t index)
+    {
+        SCHED_STAT_ADD(pcbs_scanned, 1);
+        jobs_[index].remaining = phase(index).cpu;
+        // processes the sweep has already gone past wait for the next pass
+        sched_time_t entry_pass = Preemption::sliced && index < sweep_ ? pass_ + 1 : pass_;
+        ready_.push(entry(index, seq_++, entry_pass));
+    }
+
+    bool start_io(uint32_t index, sched_time_t t)
+    {
+        IoDevice &device = devices_[phase(index).device];
+        if (!device.busy) {
+            mark_io(t);
+            devices_busy_++;
+            device.busy = true;
+            device.job = index;
+            return timing_wheel_insert(wheel_, index, t + phase(index).io);
+        }
+        if (!device.queue && !(device.queue = dyn_deque_create(0, sizeof(uint32_t), NULL))) {
+            return false;
+        }
+        jobs_[index].queued_at = t;
+        return dyn_deque_push_back(device.queue, &index);
+    }
+
+    // The process's I/O burst ends at time t, the device moves on to whoever queued for it first
+    bool io_done(uint32_t index, sched_time_t t)
+    {
+        IoDevice &device = devices_[phase(index).device];
+        mark_io(t);
+        uint32_t next;
+        if (device.queue && dyn_deque_extract_front(device.queue, &next)) {
+            jobs_[next].device_wait += t - jobs_[next].queued_at;
+            device.job = next;
+            if (!timing_wheel_insert(wheel_, next, t + phase(next).io)) return false;
+        }
+        else {
+            device.busy = false;
+            devices_busy_--;
+        }
+        jobs_[index].phase++;
+        return enter_phase(index, t);
+    }
+
+    // Waiting time is whatever part of the turnaround the process spent ready
+    void finish(uint32_t index, sched_time_t t)
+    {
+        const IoProcess_t &process = processes_[index];
+        sched_time_t busy = jobs_[index].device_wait;
+        for (uint32_t k = 0; k < process.phase_count; k++) {
+            busy += (sched_time_t)phases_[process.first_phase + k].cpu + phases_[process.first_phase + k].io;
+        }
+        totals_record(&totals_, process.arrival, busy, t);
+        device_wait_ += jobs_[index].device_wait;
+        completed_++;
+    }
+
+    // CPU time spent running bursts by time t
+    sched_time_t cpu_by(sched_time_t t) const
+    {
+        return cpu_before_ + (t <= run_start_ ? 0 : std::min(t - run_start_, run_length_));
+    }
+
+    // Brings the device totals up to time t, called before the number of busy devices changes
+    void mark_io(sched_time_t t)
+    {
+        const sched_time_t cpu = cpu_by(t);
+        if (devices_busy_) {
+            io_busy_ += t - io_since_;
+            io_overlap_ += cpu - cpu_at_io_since_;
+        }
+        io_since_ = t;
+        cpu_at_io_since_ = cpu;
+    }
+
+    const IoProcess_t *processes_;
+    const IoPhase_t *phases_;
+    size_t n_;
+    size_t device_count_;
+    sched_time_t slice_limit_;
+    ReadyHeap<sched_time_t> ready_;
+    IoJob *jobs_;
+    uint64_t *by_arrival_;          // arrival << 32 | index, sorted
+    uint32_t *batch_;               // completions due at the same time
+    timing_wheel_t *wheel_;
+    IoDevice *devices_;
+
+    schedule_totals_t totals_;
+    sched_time_t time_ = 0;
+    size_t completed_ = 0;
+    size_t arrived_ = 0;            // everything before this in by_arrival_ has arrived
+    uint32_t seq_ = 0;              // rank of the next burst to become ready
+    sched_time_t pass_ = 0;         // round robin sweep in progress
+    size_t sweep_ = 0;              // indexes below this have had their turn in this pass
+    uint32_t running_ = NONE;       // on_arrival: process holding the CPU between segments
+    uint32_t segment_ = NONE;       // process whose segment ends at time_
+
+    sched_time_t cpu_before_ = 0;   // CPU time of the segments before the last one
+    sched_time_t run_start_ = 0;    // the last segment
+    sched_time_t run_length_ = 0;
+    size_t devices_busy_ = 0;
+    sched_time_t io_since_ = 0;     // device totals are up to date as of this time
+    sched_time_t cpu_at_io_since_ = 0;
+    sched_time_t io_busy_ = 0;
+    sched_time_t io_overlap_ = 0;
+    sched_time_t device_wait_ = 0;
+};
+
+template <typename Policy, typename Preemption>
+bool run_io(const IoTrace_t *trace, size_t quantum, IoScheduleResult_t *result, sched_workspace_t *ws)
+{
+    IoRun<Policy, Preemption> io(trace, quantum, ws);
+    return io.ok() && io.run(result);
+}
+
+} // namespace
+
+extern "C" bool sched_engine_run(pcb_view_t *view, sched_engine_policy_t policy, size_t quantum,
+                                 ScheduleResult_t *result, sched_workspace_t *ws)
+{
+    if (!view || !result || !ws || !pcb_view_size(view)) return false;
+    switch (policy) {
+    case SCHED_ENGINE_FCFS:
+        return QueueChoice<FirstCome, RunToCompletion>::run(view, quantum, result, ws, NULL);
+    case SCHED_ENGINE_SJF:
+        return QueueChoice<ShortestJob, RunToCompletion>::run(view, quantum, result, ws, NULL);
+    case SCHED_ENGINE_PRIORITY:
+        return QueueChoice<HighestPriority, RunToCompletion>::run(view, quantum, result, ws, NULL);
+    case SCHED_ENGINE_RR:
+        return quantum && QueueChoice<IndexSweep, TimeSlice>::run(view, quantum, result, ws, NULL);
+    case SCHED_ENGINE_SRT:
+        return QueueChoice<ShortestRemaining, PreemptOnArrival>::run(view, quantum, result, ws, NULL);
+    }
+    return false;
+}
+
+extern "C" bool sched_engine_run_checkpointed(pcb_view_t *view, sched_engine_policy_t policy, size_t quantum,
+                                              ScheduleResult_t *result, sched_workspace_t *ws,
+                                              sched_checkpoint_t *checkpoint)
+{
+    if (!view || !result || !ws || !checkpoint || !pcb_view_size(view)) return false;
+    switch (policy) {
+    case SCHED_ENGINE_RR:
+        return quantum && QueueChoice<IndexSweep, TimeSlice>::run(view, quantum, result, ws, checkpoint);
+    case SCHED_ENGINE_SRT:
+        return QueueChoice<ShortestRemaining, PreemptOnArrival>::run(view, quantum, result, ws, checkpoint);
+    default:
+        return false;   // the other policies aren't preemptive, see run()
+    }
+}
+
+extern "C" bool sched_engine_run_io(const IoTrace_t *trace, IO_POLICY policy, size_t quantum, IoScheduleResult_t *result,
+                                    sched_workspace_t *ws)
+{
+    if (!trace || !result || !ws) return false;
+    switch (policy) {
+    case IO_POLICY_FCFS:
+        return run_io<FirstCome, RunToCompletion>(trace, quantum, result, ws);
+    case IO_POLICY_SJF:
+        return run_io<ShortestJob, RunToCompletion>(trace, quantum, result, ws);
+    case IO_POLICY_PRIORITY:
+        return run_io<HighestPriority, RunToCompletion>(trace, quantum, result, ws);
+    case IO_POLICY_RR:
+        return quantum && run_io<IndexSweep, TimeSlice>(trace, quantum, result, ws);
+    case IO_POLICY_SRT:
+        return run_io<ShortestRemaining, PreemptOnArrival>(trace, quantum, result, ws);
+    }
+    return false;
+}
@@ -0,0 +1,440 @@
+#include <stdlib.h>
+
+#include "sched_whatif.h"
+#include "scheduling_internal.h"
+
+// Dispatches per leaf of the SJF/priority key tree: a query scans at most two blocks and walks the tree between them
+#ifndef WHATIF_BLOCK
+#define WHATIF_BLOCK 64
+#endif
+
+// A PCB's place in the policy's order: policy key << 64 | tie breakers (unique per PCB)
+__extension__ typedef unsigned __int128 whatif_key_t;
+#define WHATIF_KEY_MAX (~(whatif_key_t)0)
+
+typedef struct
+{
+    whatif_key_t key;
+    uint32_t index;
+} whatif_entry_t;
+
+struct sched_whatif
+{
+    const ProcessControlBlock_t *pcbs;
+    const uint32_t *by_arrival;
+    size_t n;
+    WHATIF_POLICY policy;
+    schedule_totals_t totals;       // the baseline's sums, and the overhead model it ran with
+    sched_time_t end_time;          // when the baseline's last PCB finished
+    uint32_t *order;                // PCB dispatched at each position
+    uint32_t *position;             // position each PCB was dispatched at
+    sched_time_t *completion;       // completion time of the dispatch at each position
+    whatif_key_t *tree;             // SJF/priority: max dispatch key per block, leaves at [leaves, 2 * leaves)
+    size_t leaves;
+    whatif_entry_t *heap;           // ready queue, room for every PCB
+    uint32_t *edit_slot;            // per PCB: 1 + its edit during an evaluation, 0 if it isn't edited
+    sched_whatif_edit_t *edits;     // the evaluation's edits, sorted by new arrival
+    size_t edit_capacity;
+};
+
+// Same order as the engine's: SJF ties go to the earliest arrival (then index), the others to the lowest index
+static whatif_key_t whatif_key(WHATIF_POLICY policy, const ProcessControlBlock_t *pcb, uint32_t index)
+{
+    switch(policy) {
+        case WHATIF_SJF:
+            return (whatif_key_t)pcb->remaining_burst_time << 64 | (whatif_key_t)pcb->arrival << 32 | index;
+        case WHATIF_PRIORITY:
+            return (whatif_key_t)pcb->priority << 64 | index;
+        default:
+            return (whatif_key_t)pcb->arrival << 32 | index;
+    }
+}
+
+// The PCB as the current evaluation sees it
+static const ProcessControlBlock_t *whatif_pcb(const sched_whatif_t *whatif, uint32_t index)
+{
+    uint32_t slot = whatif->edit_slot[index];
+    return slot ? &whatif->edits[slot - 1].pcb : &whatif->pcbs[index];
+}
+
+// Overhead of the dispatch at a position, every one but the first switches from another PCB
+static sched_time_t whatif_cost(const sched_whatif_t *whatif, size_t position)
+{
+    return (sched_time_t)whatif->totals.costs.dispatch_cost + (position ? whatif->totals.costs.context_switch_cost : 0);
+}
+
+// Takes a finished PCB back out of the totals (the reverse of totals_record)
+static void whatif_unrecord(schedule_totals_t *totals, sched_time_t arrival, sched_time_t burst, sched_time_t completion)
+{
+    sched_time_t turnaround = completion - arrival;
+    totals->turnaround -= turnaround;
+    totals->waiting -= turnaround - burst;
+    --totals->count;
+}
+
+// Takes the baseline's dispatch at a position back out of the totals
+static void whatif_unrecord_dispatch(const sched_whatif_t *whatif, schedule_totals_t *totals, size_t position)
+{
+    const ProcessControlBlock_t *pcb = &whatif->pcbs[whatif->order[position]];
+    whatif_unrecord(totals, pcb->arrival, pcb->remaining_burst_time, whatif->completion[position]);
+}
+
+static void whatif_heap_push(whatif_entry_t *heap, size_t *size, whatif_entry_t entry)
+{
+    size_t child = (*size)++;
+    while(child > 0) {
+        size_t parent = (child - 1) / 2;
+        SCHED_STAT_ADD(comparisons, 1);
+        if(heap[parent].key < entry.key) break;
+        heap[child] = heap[parent];
+        child = parent;
+    }
+    heap[child] = entry;
+}
+
+static whatif_entry_t whatif_heap_pop(whatif_entry_t *heap, size_t *size)
+{
+    whatif_entry_t top = heap[0];
+    whatif_entry_t last = heap[--*size];
+    size_t parent = 0;
+    for(;;) {
+        size_t child = 2 * parent + 1;
+        if(child >= *size) break;
+        SCHED_STAT_ADD(comparisons, child + 1 < *size ? 2 : 1);
+        if(child + 1 < *size && heap[child + 1].key < heap[child].key) {
+            child++;
+        }
+        if(last.key < heap[child].key) break;
+        heap[parent] = heap[child];
+        parent = child;
+    }
+    if(*size) {
+        heap[parent] = last;
+    }
+    return top;
+}
+
+static void whatif_admit(sched_whatif_t *whatif, size_t *size, uint32_t index)
+{
+    whatif_entry_t entry = { whatif_key(whatif->policy, whatif_pcb(whatif, index), index), index };
+    SCHED_STAT_ADD(pcbs_scanned, 1);
+    whatif_heap_push(whatif->heap, size, entry);
+}
+
+// Simulates the dispatches at positions from..n-1 starting at `time`, with the heap holding the `size` PCBs
+// ready by then and the arrival cursors (unedited PCBs in arrival order, edits) at the first ones still to come.
+// Adds every PCB it finishes to totals, and with record set keeps the dispatches (the baseline run).
+// Returns when the last PCB finished.
+static sched_time_t whatif_simulate(sched_whatif_t *whatif, size_t from, sched_time_t time, size_t size, size_t next,
+                                    size_t edit, size_t edit_count, schedule_totals_t *totals, bool record)
+{
+    const ProcessControlBlock_t *pcbs = whatif->pcbs;
+    const uint32_t *by_arrival = whatif->by_arrival;
+    size_t n = whatif->n;
+
+    for(size_t k = from; k < n; ) {
+        for(;;) {
+            while(next < n && whatif->edit_slot[by_arrival[next]]) next++;
+            if(next < n && pcbs[by_arrival[next]].arrival <= time) {
+                whatif_admit(whatif, &size, by_arrival[next++]);
+            }
+            else if(edit < edit_count && whatif->edits[edit].pcb.arrival <= time) {
+                whatif_admit(whatif, &size, whatif->edits[edit++].index);
+            }
+            else {
+                break;
+            }
+        }
+        if(!size) {
+            // idle until the next arrival
+            sched_time_t unedited = next < n ? pcbs[by_arrival[next]].arrival : UINT64_MAX;
+            sched_time_t edited = edit < edit_count ? whatif->edits[edit].pcb.arrival : UINT64_MAX;
+            SCHED_STAT_CLOCK((unedited < edited ? unedited : edited) - time);
+            time = unedited < edited ? unedited : edited;
+            continue;
+        }
+
+        uint32_t index = whatif_heap_pop(whatif->heap, &size).index;
+        const ProcessControlBlock_t *pcb = whatif_pcb(whatif, index);
+        // an edited schedule still has n dispatches and n - 1 switches, only the baseline counts them
+        SCHED_STAT_CLOCK(pcb->remaining_burst_time);
+        time += (record ? charge_dispatch(totals, index) : whatif_cost(whatif, k)) + pcb->remaining_burst_time;
+        totals_record(totals, pcb->arrival, pcb->remaining_burst_time, time);
+        if(record) {
+            whatif->order[k] = index;
+            whatif->position[index] = (uint32_t)k;
+            whatif->completion[k] = time;
+        }
+        k++;
+    }
+    return time;
+}
+
+// When the baseline picked the PCB at a position, and whether it had to idle to get there
+static sched_time_t whatif_decided(const sched_whatif_t *whatif, size_t position, bool *idle)
+{
+    sched_time_t free_at = position ? whatif->completion[position - 1] : 0;
+    sched_time_t arrival = whatif->pcbs[whatif->order[position]].arrival;
+    *idle = arrival > free_at;
+    return *idle ? arrival : free_at;
+}
+
+// Key the tree keeps for the dispatch at a position. Any PCB that was ready would have been picked
+// instead of idling, so idle dispatches count as beaten by everything.
+static whatif_key_t whatif_dispatch_key(const sched_whatif_t *whatif, size_t position)
+{
+    bool idle;
+    whatif_decided(whatif, position, &idle);
+    uint32_t index = whatif->order[position];
+    return idle ? WHATIF_KEY_MAX : whatif_key(whatif->policy, &whatif->pcbs[index], index);
+}
+
+// First leaf at or after `from` in node's subtree (leaves [low, high)) with a key above x, SIZE_MAX if none
+static size_t whatif_tree_first_above(const whatif_key_t *tree, size_t node, size_t low, size_t high, size_t from,
+                                      whatif_key_t x)
+{
+    if(high <= from || tree[node] <= x) return SIZE_MAX;
+    if(high - low == 1) return low;
+    size_t mid = low + (high - low) / 2;
+    size_t found = whatif_tree_first_above(tree, 2 * node, low, mid, from, x);
+    return found != SIZE_MAX ? found : whatif_tree_first_above(tree, 2 * node + 1, mid, high, from, x);
+}
+
+// First position in [from, limit) whose dispatch key is above x, limit if none
+static size_t whatif_first_above(const sched_whatif_t *whatif, size_t from, size_t limit, whatif_key_t x)
+{
+    size_t block_end = (from / WHATIF_BLOCK + 1) * WHATIF_BLOCK;
+    for(; from < limit && from < block_end; from++) {
+        if(whatif_dispatch_key(whatif, from) > x) return from;
+    }
+    if(from >= limit) return limit;
+    size_t block = whatif_tree_first_above(whatif->tree, 1, 0, whatif->leaves, from / WHATIF_BLOCK, x);
+    if(block == SIZE_MAX) return limit;
+    for(size_t k = block * WHATIF_BLOCK; k < limit && k < (block + 1) * WHATIF_BLOCK; k++) {
+        if(whatif_dispatch_key(whatif, k) > x) return k;
+    }
+    return limit;
+}
+
+// SJF/priority: first dispatch an edit can change. Its own, unless it has arrived by an earlier one
+// and beats the PCB picked there (or would have kept the CPU from idling).
+static size_t whatif_first_affected(const sched_whatif_t *whatif, const sched_whatif_edit_t *edit)
+{
+    size_t own = whatif->position[edit->index];
+    sched_time_t arrival = edit->pcb.arrival;
+    whatif_key_t key = whatif_key(whatif->policy, &edit->pcb, edit->index);
+
+    // decision times only grow, find the first one the edited PCB is there for
+    bool idle;
+    size_t low = 0, high = own;
+    while(low < high) {
+        size_t mid = low + (high - low) / 2;
+        if(whatif_decided(whatif, mid, &idle) < arrival) low = mid + 1;
+        else high = mid;
+    }
+    if(low == own) return own;
+    sched_time_t decided = whatif_decided(whatif, low, &idle);
+    if((idle && arrival < decided) || key < whatif_dispatch_key(whatif, low)) return low;
+    // from then on it waits in the ready queue, so any idle dispatch is one it would have taken
+    return whatif_first_above(whatif, low + 1, own, key);
+}
+
+// FCFS: completion times in arrival order from the first moved PCB until they're back to the baseline's
+static sched_time_t whatif_fcfs(sched_whatif_t *whatif, size_t count, schedule_totals_t *totals, size_t *recomputed)
+{
+    size_t n = whatif->n;
+    size_t start = n;
+    for(size_t e = 0; e < count; e++) {
+        const sched_whatif_edit_t *edit = &whatif->edits[e];
+        whatif_key_t key = whatif_key(WHATIF_FCFS, &edit->pcb, edit->index);
+        size_t low = 0, high = whatif->position[edit->index];   // its new place can't be after its old one's
+        while(low < high) {
+            size_t mid = low + (high - low) / 2;
+            uint32_t index = whatif->order[mid];
+            if(whatif_key(WHATIF_FCFS, &whatif->pcbs[index], index) < key) low = mid + 1;
+            else high = mid;
+        }
+        if(low < start) start = low;
+    }
+
+    // merge the unedited PCBs (still in baseline order) with the edits (sorted by new arrival)
+    sched_time_t time = start ? whatif->completion[start - 1] : 0;
+    size_t old = start, edit = 0, k = start;
+    for(; k < n; k++) {
+        while(old < n && whatif->edit_slot[whatif->order[old]]) {
+            whatif_unrecord_dispatch(whatif, totals, old++);
+        }
+        bool from_old = edit == count
+            || (old < n && whatif_key(WHATIF_FCFS, &whatif->pcbs[whatif->order[old]], whatif->order[old])
+                           < whatif_key(WHATIF_FCFS, &whatif->edits[edit].pcb, whatif->edits[edit].index));
+        const ProcessControlBlock_t *pcb;
+        if(from_old) {
+            pcb = &whatif->pcbs[whatif->order[old]];
+            whatif_unrecord_dispatch(whatif, totals, old++);
+        }
+        else {
+            pcb = &whatif->edits[edit++].pcb;
+        }
+        if(pcb->arrival > time) time = pcb->arrival;
+        time += whatif_cost(whatif, k) + pcb->remaining_burst_time;
+        totals_record(totals, pcb->arrival, pcb->remaining_burst_time, time);
+
+        // back in step with the baseline: same PCBs so far, same completion, so the rest is the same too
+        if(from_old && edit == count && old == k + 1 && time == whatif->completion[k]) {
+            *recomputed = k + 1 - start;
+            return whatif->end_time;
+        }
+    }
+    for(; old < n; old++) {
+        whatif_unrecord_dispatch(whatif, totals, old);     // edited PCBs that moved up
+    }
+    *recomputed = n - start;
+    return time;
+}
+
+// SJF/priority: everything from the first affected dispatch, from the baseline's state at that point
+static sched_time_t whatif_resimulate(sched_whatif_t *whatif, size_t count, schedule_totals_t *totals, size_t *recomputed)
+{
+    size_t n = whatif->n;
+    size_t start = n;
+    for(size_t e = 0; e < count; e++) {
+        size_t first = whatif_first_affected(whatif, &whatif->edits[e]);
+        if(first < start) start = first;
+    }
+
+    // the ready queue then: everything dispatched later that had arrived
+    sched_time_t time = start ? whatif->completion[start - 1] : 0;
+    size_t size = 0;
+    for(size_t k = start; k < n; k++) {
+        uint32_t index = whatif->order[k];
+        whatif_unrecord_dispatch(whatif, totals, k);
+        if(!whatif->edit_slot[index] && whatif->pcbs[index].arrival <= time) {
+            whatif_admit(whatif, &size, index);
+        }
+    }
+    size_t edit = 0;
+    for(; edit < count && whatif->edits[edit].pcb.arrival <= time; edit++) {
+        whatif_admit(whatif, &size, whatif->edits[edit].index);
+    }
+    // everything that arrived by then was dispatched earlier or is queued, so arrivals pick up after it
+    size_t low = 0, high = n;
+    while(low < high) {
+        size_t mid = low + (high - low) / 2;
+        if(whatif->pcbs[whatif->by_arrival[mid]].arrival <= time) low = mid + 1;
+        else high = mid;
+    }
+    *recomputed = n - start;
+    return whatif_simulate(whatif, start, time, size, low, edit, count, totals, false);
+}
+
+static int whatif_edit_cmp(const void *a, const void *b)
+{
+    const sched_whatif_edit_t *ea = (const sched_whatif_edit_t *)a;
+    const sched_whatif_edit_t *eb = (const sched_whatif_edit_t *)b;
+    if(ea->pcb.arrival != eb->pcb.arrival) return ea->pcb.arrival < eb->pcb.arrival ? -1 : 1;
+    return ea->index < eb->index ? -1 : ea->index > eb->index;
+}
+
+sched_whatif_t *sched_whatif_create(pcb_view_t *view, const WHATIF_POLICY policy)
+{
+    if(!view || (unsigned)policy > WHATIF_PRIORITY) return NULL;
+    size_t n = pcb_view_size(view);
+    const uint32_t *by_arrival = n ? pcb_view_order(view, PCB_ORDER_ARRIVAL) : NULL;
+    if(!by_arrival) return NULL;
+
+    sched_whatif_t *whatif = (sched_whatif_t *)SCHED_CALLOC(1, sizeof(sched_whatif_t));
+    if(!whatif) return NULL;
+    whatif->pcbs = pcb_view_pcbs(view);
+    whatif->by_arrival = by_arrival;
+    whatif->n = n;
+    whatif->policy = policy;
+    whatif->order = (uint32_t *)SCHED_MALLOC(n * sizeof(uint32_t));
+    whatif->position = (uint32_t *)SCHED_MALLOC(n * sizeof(uint32_t));
+    whatif->completion = (sched_time_t *)SCHED_MALLOC(n * sizeof(sched_time_t));
+    whatif->heap = (whatif_entry_t *)SCHED_MALLOC(n * sizeof(whatif_entry_t));
+    whatif->edit_slot = (uint32_t *)SCHED_CALLOC(n, sizeof(uint32_t));
+    if(policy != WHATIF_FCFS) {
+        size_t blocks = (n + WHATIF_BLOCK - 1) / WHATIF_BLOCK;
+        for(whatif->leaves = 1; whatif->leaves < blocks; whatif->leaves <<= 1) {}
+        whatif->tree = (whatif_key_t *)SCHED_CALLOC(2 * whatif->leaves, sizeof(whatif_key_t));
+    }
+    if(!whatif->order || !whatif->position || !whatif->completion || !whatif->heap || !whatif->edit_slot
+       || (policy != WHATIF_FCFS && !whatif->tree)) {
+        sched_whatif_destroy(whatif);
+        return NULL;
+    }
+
+    totals_init(&whatif->totals);
+    whatif->end_time = whatif_simulate(whatif, 0, 0, 0, 0, 0, 0, &whatif->totals, true);
+    if(whatif->tree) {
+        whatif_key_t *tree = whatif->tree;
+        for(size_t k = 0; k < n; k++) {
+            whatif_key_t key = whatif_dispatch_key(whatif, k);
+            size_t leaf = whatif->leaves + k / WHATIF_BLOCK;
+            if(key > tree[leaf]) tree[leaf] = key;
+        }
+        for(size_t node = whatif->leaves - 1; node > 0; node--) {
+            tree[node] = tree[2 * node] > tree[2 * node + 1] ? tree[2 * node] : tree[2 * node + 1];
+        }
+    }
+    return whatif;
+}
+
+void sched_whatif_destroy(sched_whatif_t *const whatif)
+{
+    if(whatif) {
+        free(whatif->order);
+        free(whatif->position);
+        free(whatif->completion);
+        free(whatif->tree);
+        free(whatif->heap);
+        free(whatif->edit_slot);
+        free(whatif->edits);
+        free(whatif);
+    }
+}
+
+bool sched_whatif_baseline(const sched_whatif_t *const whatif, ScheduleResult_t *result)
+{
+    if(!whatif || !result) return false;
+    totals_finish(&whatif->totals, whatif->end_time, result);
+    return true;
+}
+
+bool sched_whatif_evaluate(sched_whatif_t *const whatif, const sched_whatif_edit_t *const edits, const size_t count,
+                           ScheduleResult_t *result, size_t *recomputed)
+{
+    if(!whatif || !result || (count && !edits) || count > whatif->n) return false;
+    size_t ignored;
+    if(!recomputed) recomputed = &ignored;
+    *recomputed = 0;
+    if(!count) return sched_whatif_baseline(whatif, result);
+
+    if(count > whatif->edit_capacity) {
+        sched_whatif_edit_t *grown = (sched_whatif_edit_t *)SCHED_REALLOC(whatif->edits, count * sizeof(sched_whatif_edit_t));
+        if(!grown) return false;
+        whatif->edits = grown;
+        whatif->edit_capacity = count;
+    }
+    memcpy(whatif->edits, edits, count * sizeof(sched_whatif_edit_t));
+    qsort(whatif->edits, count, sizeof(sched_whatif_edit_t), whatif_edit_cmp);
+
+    // mark the edited PCBs, refusing unknown ones and PCBs edited twice
+    size_t marked = 0;
+    for(; marked < count; marked++) {
+        uint32_t index = whatif->edits[marked].index;
+        if(index >= whatif->n || whatif->edit_slot[index]) break;
+        whatif->edit_slot[index] = (uint32_t)marked + 1;
+    }
+    bool ok = marked == count;
+    if(ok) {
+        schedule_totals_t totals = whatif->totals;
+        sched_time_t end_time = whatif->policy == WHATIF_FCFS ? whatif_fcfs(whatif, count, &totals, recomputed)
+                                                              : whatif_resimulate(whatif, count, &totals, recomputed);
+        totals_finish(&totals, end_time, result);
+    }
+    for(size_t e = 0; e < marked; e++) {
+        whatif->edit_slot[whatif->edits[e].index] = 0;
+    }
+    return ok;
+}
@@ -0,0 +1,83 @@
+#include <stdlib.h>
+
+#include "scheduling_internal.h"
+
+void sched_ws_init(sched_workspace_t *ws)
+{
+    memset(ws, 0, sizeof(*ws));
+}
+
+void sched_ws_release(sched_workspace_t *ws)
+{
+    for(size_t slot = 0; slot < SCHED_WS_SLOT_COUNT; slot++) {
+        free(ws->buffers[slot]);
+    }
+    pcb_view_destroy(ws->view);
+    timing_wheel_destroy(ws->wheel);
+    sched_ws_init(ws);
+}
+
+void *sched_ws_buffer(sched_workspace_t *ws, sched_ws_slot_t slot, size_t bytes)
+{
+    if(ws->buffers[slot] && ws->capacity[slot] >= bytes) {
+        return ws->buffers[slot];
+    }
+    // nothing in a slot outlives a call, so grow without copying
+    free(ws->buffers[slot]);
+    ws->buffers[slot] = SCHED_MALLOC(bytes ? bytes : 1);
+    ws->capacity[slot] = ws->buffers[slot] ? bytes : 0;
+    return ws->buffers[slot];
+}
+
+pcb_view_t *sched_ws_view(sched_workspace_t *ws, const dyn_array_t *ready_queue)
+{
+    if(!ws->view) {
+        ws->view = pcb_view_create(ready_queue);
+    }
+    else if(!pcb_view_rebind(ws->view, ready_queue)) {
+        return NULL;
+    }
+    pcb_view_set_sort_threads(ws->view, get_schedule_threads());
+    return ws->view;
+}
+
+timing_wheel_t *sched_ws_wheel(sched_workspace_t *ws, size_t capacity, uint64_t now)
+{
+    if(!ws->wheel) {
+        ws->wheel = timing_wheel_create(capacity, now);
+        return ws->wheel;
+    }
+    return timing_wheel_reset(ws->wheel, capacity, now) ? ws->wheel : NULL;
+}
+
+sched_workspace_t *sched_workspace_create(void)
+{
+    sched_workspace_t *ws = (sched_workspace_t *)SCHED_MALLOC(sizeof(sched_workspace_t));
+    if(ws) {
+        sched_ws_init(ws);
+    }
+    return ws;
+}
+
+void sched_workspace_destroy(sched_workspace_t *const ws)
+{
+    if(ws) {
+        sched_ws_release(ws);
+        free(ws);
+    }
+}
+
+bool sched_workspace_reserve(sched_workspace_t *const ws, const size_t pcb_count)
+{
+    if(!ws) return false;
+    static const size_t slot_size[SCHED_WS_SLOT_COUNT] = {
+        sizeof(bool), sizeof(uint32_t), sizeof(uint32_t), sizeof(sched_time_t), sizeof(sched_time_t), sizeof(uint64_t),
+        2 * sizeof(uint64_t), sizeof(uint64_t) + 1, 2 * sizeof(uint64_t), 0   // PCB traces never use the I/O slot
+    };
+    for(size_t slot = 0; slot < SCHED_WS_SLOT_COUNT; slot++) {
+        if(!sched_ws_buffer(ws, (sched_ws_slot_t)slot, pcb_count * slot_size[slot])) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+// sysconf() for the online CPU count
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "scheduling_internal.h"
+
+typedef struct
+{
+    void (*task)(void *context, size_t worker);
+    void *context;
+    size_t worker;
+#ifdef SCHED_STATS
+    ScheduleStats_t stats;          // the thread's counters, handed back to the caller at join
+    dyn_array_stats_t array_stats;
+#endif
+} sched_worker_t;
+
+static void *sched_worker_main(void *arg)
+{
+    sched_worker_t *worker = (sched_worker_t *)arg;
+    worker->task(worker->context, worker->worker);
+#ifdef SCHED_STATS
+    worker->stats = sched_stats;
+    worker->array_stats = dyn_array_stats();
+#endif
+    return NULL;
+}
+
+size_t sched_resolve_threads(size_t nthreads)
+{
+    if(nthreads) {
+        return nthreads;
+    }
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? (size_t)online : 1;
+}
+
+void sched_run_workers(size_t workers, void (*task)(void *context, size_t worker), void *context)
+{
+    if(workers == 0) {
+        return;
+    }
+    pthread_t *threads = (pthread_t *)SCHED_MALLOC(workers * sizeof(pthread_t));
+    sched_worker_t *slots = (sched_worker_t *)SCHED_MALLOC(workers * sizeof(sched_worker_t));
+    size_t started = 1;
+    if(threads && slots) {
+        for(; started < workers; started++) {
+            slots[started] = (sched_worker_t){.task = task, .context = context, .worker = started};
+            if(pthread_create(&threads[started], NULL, sched_worker_main, &slots[started])) {
+                break;
+            }
+        }
+    }
+    else {
+        started = 1;
+    }
+
+    // the calling thread does worker 0 plus whatever couldn't get a thread
+    task(context, 0);
+    for(size_t worker = started; worker < workers; worker++) {
+        task(context, worker);
+    }
+    for(size_t worker = 1; worker < started; worker++) {
+        pthread_join(threads[worker], NULL);
+#ifdef SCHED_STATS
+        sched_stats_absorb(&slots[worker].stats, &slots[worker].array_stats);
+#endif
+    }
+    free(threads);
+    free(slots);
+}
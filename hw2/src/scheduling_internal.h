@@ -0,0 +1,247 @@
+#ifndef SCHEDULING_INTERNAL_H
+#define SCHEDULING_INTERNAL_H
+
+// Pieces shared by the scheduler implementations. Not part of the public headers.
+// Also included by the C++ engine (sched_engine.cpp), so everything here has to compile as both.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "io_scheduling.h"
+#include "processing_scheduling.h"
+#include "pcb_view.h"
+#include "sched_checkpoint.h"
+#include "sched_workers.h"
+#include "sched_workspace.h"
+#include "timing_wheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// All internal time is 64 bit, the 32 bit PCB fields widen into it.
+// Sums of waits/turnarounds over billions of PCBs can pass 64 bits, so they are kept in 128.
+typedef uint64_t sched_time_t;
+__extension__ typedef unsigned __int128 sched_sum_t;
+
+// Stats counters, compiled out unless SCHED_STATS is defined (see ScheduleStats_t)
+#ifdef SCHED_STATS
+// __thread on the C++ side: same TLS object, without thread_local's wrapper calls
+#ifdef __cplusplus
+extern __thread ScheduleStats_t sched_stats;
+#else
+extern _Thread_local ScheduleStats_t sched_stats;
+#endif
+#define SCHED_STAT_ADD(field, amount) (sched_stats.field += (amount))
+// One move of the simulated clock by `delta`
+#define SCHED_STAT_CLOCK(delta) ((void)((delta) == 1 ? ++sched_stats.unit_ticks : (delta) > 1 ? ++sched_stats.clock_jumps : 0))
+#else
+#define SCHED_STAT_ADD(field, amount) ((void)0)
+#define SCHED_STAT_CLOCK(delta) ((void)0)
+#endif
+
+// Allocations the stats count
+#define SCHED_MALLOC(size) (SCHED_STAT_ADD(mallocs, 1), malloc(size))
+#define SCHED_CALLOC(count, size) (SCHED_STAT_ADD(mallocs, 1), calloc(count, size))
+#define SCHED_REALLOC(pointer, size) (SCHED_STAT_ADD(mallocs, 1), realloc(pointer, size))
+
+// Adds counters gathered on another thread to the calling thread's (no-op without SCHED_STATS)
+void sched_stats_absorb(const ScheduleStats_t *stats, const dyn_array_stats_t *array_stats);
+
+// Running totals shared by every scheduler
+typedef struct
+{
+    sched_sum_t waiting;          // exact sum of waiting times
+    sched_sum_t turnaround;       // exact sum of turnaround times
+    uint64_t count;               // PCBs recorded so far
+    unsigned long switches;       // context switches charged so far
+    unsigned long overhead;       // overhead time charged so far
+    size_t last_ran;              // process that last held the CPU, SIZE_MAX before the first dispatch
+    ScheduleOverhead_t costs;     // overhead model in effect for this run
+} schedule_totals_t;
+
+// Scratch buffers a workspace keeps, one per kind of per-PCB array
+typedef enum
+{
+    SCHED_WS_FLAGS = 0,     // bool per PCB (done/completed)
+    SCHED_WS_INDEX,         // uint32_t per PCB (ranks, index lists)
+    SCHED_WS_TREE,          // uint32_t per PCB (Fenwick tree)
+    SCHED_WS_TIMES,         // sched_time_t per PCB (remaining bursts)
+    SCHED_WS_FINISH,        // sched_time_t per PCB (finish times)
+    SCHED_WS_KEYS,          // uint64_t per PCB (packed sort keys)
+    SCHED_WS_HEAP,          // engine ready heap, up to 16 bytes per PCB
+    SCHED_WS_BUCKETS,       // engine bucket queue, a bit per PCB per priority level (up to 64) plus summary words
+    SCHED_WS_RADIX,         // engine radix heap, about 12 bytes per PCB
+    SCHED_WS_JOBS,          // I/O event loop, 32 bytes of state per process
+    SCHED_WS_SLOT_COUNT
+} sched_ws_slot_t;
+
+struct sched_workspace
+{
+    void *buffers[SCHED_WS_SLOT_COUNT];
+    size_t capacity[SCHED_WS_SLOT_COUNT];   // bytes
+    pcb_view_t *view;                       // rebound to each dyn_array, NULL until the first one
+    timing_wheel_t *wheel;                  // I/O completions, NULL until the first I/O trace
+};
+
+// A workspace on the stack for one call: init, run, release
+void sched_ws_init(sched_workspace_t *ws);
+void sched_ws_release(sched_workspace_t *ws);
+
+// Returns the slot's buffer with room for at least `bytes`, growing it if needed (contents are not kept).
+// NULL on allocation failure.
+void *sched_ws_buffer(sched_workspace_t *ws, sched_ws_slot_t slot, size_t bytes);
+
+// Returns the workspace's view, rebound to ready_queue. NULL on error.
+pcb_view_t *sched_ws_view(sched_workspace_t *ws, const dyn_array_t *ready_queue);
+
+// Returns the workspace's timing wheel, reset to take ids below capacity with its clock at now. NULL on error.
+timing_wheel_t *sched_ws_wheel(sched_workspace_t *ws, size_t capacity, uint64_t now);
+
+// Orders PCBs by arrival only, the comparator load_process_control_blocks_sorted sorts with.
+// Views use it to ask the array whether it's already known to be in arrival order.
+int pcb_arrival_cmp(const void *a, const void *b);
+
+// Round robin for traces where every PCB arrives at the same time, computed in O(n log n)
+// without simulating slices. Same results as the round_robin_view simulation.
+bool round_robin_all_arrived(const ProcessControlBlock_t *pcbs, size_t n, sched_time_t quantum, ScheduleResult_t *result,
+                             sched_workspace_t *ws);
+
+// Policies the engine in sched_engine.cpp is instantiated for
+typedef enum
+{
+    SCHED_ENGINE_FCFS = 0,
+    SCHED_ENGINE_SJF,
+    SCHED_ENGINE_PRIORITY,
+    SCHED_ENGINE_RR,
+    SCHED_ENGINE_SRT
+} sched_engine_policy_t;
+
+// Runs the sequential simulation of a policy over the view (quantum only matters for RR).
+// This is what the _view_ws schedulers run once they've ruled out their special cases.
+bool sched_engine_run(pcb_view_t *view, sched_engine_policy_t policy, size_t quantum, ScheduleResult_t *result,
+                      sched_workspace_t *ws);
+
+// Same as sched_engine_run, saving and resuming through checkpoint (RR and SRT only)
+bool sched_engine_run_checkpointed(pcb_view_t *view, sched_engine_policy_t policy, size_t quantum, ScheduleResult_t *result,
+                                   sched_workspace_t *ws, sched_checkpoint_t *checkpoint);
+
+// Where a checkpointed engine run stands between two dispatches, besides its remaining bursts
+typedef struct
+{
+    sched_time_t time;
+    size_t completed;             // PCBs finished
+    size_t arrived;               // PCBs admitted from the arrival order (the cursor into the trace)
+    sched_time_t pass;            // round robin sweep in progress
+    size_t sweep;                 // indexes that have had their turn in it
+    size_t running;               // SRT: process holding the CPU, SIZE_MAX if none
+    schedule_totals_t totals;
+} sched_run_state_t;
+
+// A checkpointed run in progress (sched_checkpoint.c): open, restore, save every so often, close
+typedef struct
+{
+    sched_checkpoint_t *options;
+    uint64_t identity[5];         // policy, quantum, PCB count, overhead model, trace hash: what a checkpoint must match
+    size_t time_bytes;            // width of the engine's clock and of each remaining burst
+    char *temp_path;              // options->path with .tmp on the end
+    pid_t child;                  // process writing the last save, 0 if none
+} sched_checkpoint_run_t;
+
+// Starts a checkpointed run of policy over the PCBs. false on error.
+bool sched_checkpoint_open(sched_checkpoint_run_t *run, sched_checkpoint_t *options, sched_engine_policy_t policy,
+                           const ProcessControlBlock_t *pcbs, size_t n, size_t quantum, size_t time_bytes);
+
+// Loads the checkpoint at the options' path into state and remaining (n entries of time_bytes) when asked to
+// resume and there is one, setting options->resumed. false if the file is unreadable, damaged or from another run.
+bool sched_checkpoint_restore(sched_checkpoint_run_t *run, sched_run_state_t *state, void *remaining);
+
+// Saves state and remaining from a forked child without waiting for it (skipped while the last save is still going)
+void sched_checkpoint_save(sched_checkpoint_run_t *run, const sched_run_state_t *state, const void *remaining);
+
+// Waits for the last save and frees the run
+void sched_checkpoint_close(sched_checkpoint_run_t *run);
+
+// Runs the I/O event loop of a policy over a trace schedule_io has checked (quantum only matters for RR)
+bool sched_engine_run_io(const IoTrace_t *trace, IO_POLICY policy, size_t quantum, IoScheduleResult_t *result,
+                         sched_workspace_t *ws);
+
+static inline void totals_init(schedule_totals_t *totals)
+{
+    memset(totals, 0, sizeof(*totals));
+    totals->last_ran = SIZE_MAX;
+    totals->costs = get_schedule_overhead();
+}
+
+// Returns the overhead for handing the CPU to process `next`.
+// A context switch is counted when the CPU last ran a different process.
+static inline sched_time_t charge_dispatch(schedule_totals_t *totals, size_t next)
+{
+    sched_time_t cost = totals->costs.dispatch_cost;
+    SCHED_STAT_ADD(dispatches, 1);
+    if(totals->last_ran != SIZE_MAX && totals->last_ran != next) {
+        cost += totals->costs.context_switch_cost;
+        ++totals->switches;
+        SCHED_STAT_ADD(context_switches, 1);
+    }
+    totals->last_ran = next;
+    totals->overhead += cost;
+    return cost;
+}
+
+// Records a finished PCB. Waiting time is whatever part of the turnaround was not spent running.
+static inline void totals_record(schedule_totals_t *totals, sched_time_t arrival, sched_time_t burst, sched_time_t completion)
+{
+    sched_time_t turnaround = completion - arrival;
+    totals->turnaround += turnaround;
+    totals->waiting += turnaround - burst;
+    ++totals->count;
+}
+
+// Folds totals gathered separately (e.g. by another thread) into `into`
+static inline void totals_merge(schedule_totals_t *into, const schedule_totals_t *from)
+{
+    into->waiting += from->waiting;
+    into->turnaround += from->turnaround;
+    into->count += from->count;
+    into->switches += from->switches;
+    into->overhead += from->overhead;
+}
+
+// Divides an exact sum without going through a lossy conversion of the whole sum first
+static inline double exact_mean(sched_sum_t sum, uint64_t count)
+{
+    sched_sum_t quotient = sum / count;
+    sched_sum_t remainder = sum % count;
+    return (double)quotient + (double)(uint64_t)remainder / (double)count;
+}
+
+static inline uint64_t saturate_sum(sched_sum_t sum)
+{
+    return sum > UINT64_MAX ? UINT64_MAX : (uint64_t)sum;
+}
+
+// Fills out the result from the totals, end_time is when the last PCB finished
+static inline void totals_finish(const schedule_totals_t *totals, sched_time_t end_time, ScheduleResult_t *result)
+{
+    result->mean_waiting_time = exact_mean(totals->waiting, totals->count);
+    result->mean_turnaround_time = exact_mean(totals->turnaround, totals->count);
+    result->average_waiting_time = (float)result->mean_waiting_time;
+    result->average_turnaround_time = (float)result->mean_turnaround_time;
+    result->total_waiting_time = saturate_sum(totals->waiting);
+    result->total_turnaround_time = saturate_sum(totals->turnaround);
+    result->process_count = totals->count;
+    result->total_run_time = end_time;
+    result->context_switches = totals->switches;
+    result->overhead_time = totals->overhead;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
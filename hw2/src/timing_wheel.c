@@ -0,0 +1,281 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "timing_wheel.h"
+
+// 64 slots per level, one 6 bit digit of the time per level, enough levels for all 64 bits
+#define TW_BITS 6
+#define TW_SLOTS (1u << TW_BITS)
+#define TW_LEVELS ((64 + TW_BITS - 1) / TW_BITS)
+#define TW_DUE (TW_LEVELS * TW_SLOTS)	// the list after the slots: events at or before the clock
+#define TW_LISTS (TW_DUE + 1)
+
+#define TW_NIL UINT32_MAX				// end of a list
+#define TW_IDLE (UINT32_MAX - 1)		// prev of an id that isn't pending
+
+typedef struct
+{
+	uint64_t expiry;
+	uint32_t prev;
+	uint32_t next;
+} tw_node_t;
+
+struct timing_wheel
+{
+	uint64_t now;
+	uint64_t earliest;					// earliest pending expiry, when earliest_known
+	bool earliest_known;
+	size_t size;						// pending events
+	size_t capacity;					// ids below this can be inserted
+	size_t allocated;					// nodes allocated
+	tw_node_t *nodes;					// one per id, linked into the list it's pending on
+	uint64_t occupied[TW_LEVELS];		// a bit per non-empty slot
+	uint32_t head[TW_LISTS];
+	uint32_t tail[TW_LISTS];
+};
+
+// The list an event belongs on: the slot of the highest digit where it differs from the clock.
+// Every slot at a level holds times that agree with the clock above that digit, so the slots of
+// the lowest non-empty level are in time order.
+static size_t tw_list_of(const timing_wheel_t *const wheel, const uint64_t expiry)
+{
+	if (expiry <= wheel->now)
+	{
+		return TW_DUE;
+	}
+	const size_t level = (size_t) (63 - __builtin_clzll(expiry ^ wheel->now)) / TW_BITS;
+	return level * TW_SLOTS + ((expiry >> (level * TW_BITS)) & (TW_SLOTS - 1));
+}
+
+static void tw_link(timing_wheel_t *const wheel, const uint32_t id)
+{
+	tw_node_t *const node = &wheel->nodes[id];
+	const size_t list = tw_list_of(wheel, node->expiry);
+	node->next = TW_NIL;
+	node->prev = wheel->tail[list];
+	if (node->prev == TW_NIL)
+	{
+		wheel->head[list] = id;
+	}
+	else
+	{
+		wheel->nodes[node->prev].next = id;
+	}
+	wheel->tail[list] = id;
+	if (list != TW_DUE)
+	{
+		wheel->occupied[list / TW_SLOTS] |= (uint64_t) 1 << (list % TW_SLOTS);
+	}
+}
+
+static void tw_unlink(timing_wheel_t *const wheel, const uint32_t id, const size_t list)
+{
+	tw_node_t *const node = &wheel->nodes[id];
+	if (node->prev == TW_NIL)
+	{
+		wheel->head[list] = node->next;
+	}
+	else
+	{
+		wheel->nodes[node->prev].next = node->next;
+	}
+	if (node->next == TW_NIL)
+	{
+		wheel->tail[list] = node->prev;
+	}
+	else
+	{
+		wheel->nodes[node->next].prev = node->prev;
+	}
+	node->prev = TW_IDLE;
+	if (list != TW_DUE && wheel->head[list] == TW_NIL)
+	{
+		wheel->occupied[list / TW_SLOTS] &= ~((uint64_t) 1 << (list % TW_SLOTS));
+	}
+	if (wheel->earliest_known && node->expiry == wheel->earliest)
+	{
+		wheel->earliest_known = false;
+	}
+	wheel->size--;
+}
+
+// Moves the clock forward to `to`, which must not pass any pending event.
+// Those all agree with `to` above the level they sit at, so the only events whose list changes
+// are the ones in the slot `to` itself reaches at each level: they cascade down a level or more
+// (top down, so an event can fall through several), and the ones due exactly at `to` end up due.
+static void tw_move_to(timing_wheel_t *const wheel, const uint64_t to)
+{
+	if (to <= wheel->now)
+	{
+		return;
+	}
+	wheel->now = to;
+	for (size_t level = TW_LEVELS; level-- > 0;)
+	{
+		const size_t slot = (to >> (level * TW_BITS)) & (TW_SLOTS - 1);
+		if (!(wheel->occupied[level] & ((uint64_t) 1 << slot)))
+		{
+			continue;
+		}
+		const size_t list = level * TW_SLOTS + slot;
+		uint32_t id = wheel->head[list];
+		wheel->head[list] = wheel->tail[list] = TW_NIL;
+		wheel->occupied[level] &= ~((uint64_t) 1 << slot);
+		while (id != TW_NIL)
+		{
+			const uint32_t next = wheel->nodes[id].next;
+			tw_link(wheel, id);
+			id = next;
+		}
+	}
+}
+
+timing_wheel_t *timing_wheel_create(const size_t capacity, const uint64_t now)
+{
+	timing_wheel_t *wheel = (timing_wheel_t *) calloc(1, sizeof(timing_wheel_t));
+	if (wheel && !timing_wheel_reset(wheel, capacity, now))
+	{
+		free(wheel);
+		wheel = NULL;
+	}
+	return wheel;
+}
+
+void timing_wheel_destroy(timing_wheel_t *const wheel)
+{
+	if (wheel)
+	{
+		free(wheel->nodes);
+		free(wheel);
+	}
+}
+
+bool timing_wheel_reset(timing_wheel_t *const wheel, const size_t capacity, const uint64_t now)
+{
+	if (!wheel)
+	{
+		return false;
+	}
+	bool success = capacity < TW_IDLE;
+	if (success && capacity > wheel->allocated)
+	{
+		// nothing survives a reset, so grow without copying
+		free(wheel->nodes);
+		wheel->nodes = (tw_node_t *) malloc(capacity * sizeof(tw_node_t));
+		wheel->allocated = wheel->nodes ? capacity : 0;
+		wheel->capacity = 0;
+		success = wheel->nodes != NULL;
+	}
+	if (success)
+	{
+		wheel->capacity = capacity;
+	}
+	for (size_t id = 0; id < wheel->capacity; ++id)
+	{
+		wheel->nodes[id].prev = TW_IDLE;
+	}
+	memset(wheel->occupied, 0, sizeof(wheel->occupied));
+	memset(wheel->head, 0xFF, sizeof(wheel->head));
+	memset(wheel->tail, 0xFF, sizeof(wheel->tail));
+	wheel->now = now;
+	wheel->size = 0;
+	wheel->earliest_known = false;
+	return success;
+}
+
+bool timing_wheel_insert(timing_wheel_t *const wheel, const uint32_t id, const uint64_t expiry)
+{
+	if (!wheel || id >= wheel->capacity || wheel->nodes[id].prev != TW_IDLE)
+	{
+		return false;
+	}
+	wheel->nodes[id].expiry = expiry;
+	tw_link(wheel, id);
+	if (!wheel->size || (wheel->earliest_known && expiry < wheel->earliest))
+	{
+		wheel->earliest = expiry;
+		wheel->earliest_known = true;
+	}
+	wheel->size++;
+	return true;
+}
+
+bool timing_wheel_cancel(timing_wheel_t *const wheel, const uint32_t id)
+{
+	if (!wheel || id >= wheel->capacity || wheel->nodes[id].prev == TW_IDLE)
+	{
+		return false;
+	}
+	tw_unlink(wheel, id, tw_list_of(wheel, wheel->nodes[id].expiry));
+	return true;
+}
+
+bool timing_wheel_expire(timing_wheel_t *const wheel, const uint64_t now, uint32_t *const id, uint64_t *const expiry)
+{
+	if (!wheel || !id)
+	{
+		return false;
+	}
+	if (wheel->head[TW_DUE] == TW_NIL)
+	{
+		uint64_t earliest;
+		if (!timing_wheel_next_expiry(wheel, &earliest) || earliest > now)
+		{
+			tw_move_to(wheel, now);
+			return false;
+		}
+		// everything due at that time cascades into the due list
+		tw_move_to(wheel, earliest);
+	}
+	*id = wheel->head[TW_DUE];
+	if (expiry)
+	{
+		*expiry = wheel->nodes[*id].expiry;
+	}
+	tw_unlink(wheel, *id, TW_DUE);
+	return true;
+}
+
+bool timing_wheel_next_expiry(timing_wheel_t *const wheel, uint64_t *const expiry)
+{
+	if (!wheel || !expiry || !wheel->size)
+	{
+		return false;
+	}
+	if (!wheel->earliest_known)
+	{
+		// the lowest occupied slot of the lowest occupied level holds the earliest event,
+		// but only slots of level 0 hold a single time, so look through it
+		size_t list = TW_DUE;
+		if (wheel->head[TW_DUE] == TW_NIL)
+		{
+			size_t level = 0;
+			while (!wheel->occupied[level])
+			{
+				++level;
+			}
+			list = level * TW_SLOTS + (size_t) __builtin_ctzll(wheel->occupied[level]);
+		}
+		wheel->earliest = UINT64_MAX;
+		for (uint32_t id = wheel->head[list]; id != TW_NIL; id = wheel->nodes[id].next)
+		{
+			if (wheel->nodes[id].expiry < wheel->earliest)
+			{
+				wheel->earliest = wheel->nodes[id].expiry;
+			}
+		}
+		wheel->earliest_known = true;
+	}
+	*expiry = wheel->earliest;
+	return true;
+}
+
+size_t timing_wheel_size(const timing_wheel_t *const wheel)
+{
+	return wheel ? wheel->size : 0;
+}
+
+uint64_t timing_wheel_now(const timing_wheel_t *const wheel)
+{
+	return wheel ? wheel->now : 0;
+}
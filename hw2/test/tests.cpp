@@ -1,9 +1,24 @@
 #include <fcntl.h>
+#include <unistd.h>
 #include <stdio.h>
 #include <pthread.h>
 #include "gtest/gtest.h"
 #include "../include/processing_scheduling.h"
 #include "../include/dyn_array.h"
+#include "../include/pcb_view.h"
+#include "../include/sched_workspace.h"
+#include "../include/dyn_deque.h"
+#include "../include/dyn_array.hpp"
+#include "../include/timing_wheel.h"
+#include "../include/io_scheduling.h"
+#include "../include/pcb_queue.h"
+#include "../include/pcb_prefetch.h"
+#include "../include/sched_checkpoint.h"
+#include "../include/sched_whatif.h"
+#include "../include/sched_batch.h"
+#include <deque>
+#include <map>
+#include <vector>
 
 // Using a C library requires extern "C" to prevent function mangling
 extern "C"
@@ -440,6 +455,1297 @@ TEST(SRTFTest, CQueue) {
     dyn_array_destroy(queue);
 }
 
+// FCFS charging both dispatch and context switch overhead
+TEST(OverheadTest, FCFSQueue) {
+    dyn_array_t *queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 10, .priority = 1,	.arrival = 0, .started = 0};
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 2, .priority = 1,	.arrival = 2, .started = 0};
+    ProcessControlBlock_t pcb3 = { .remaining_burst_time = 1, .priority = 1,	.arrival = 3, .started = 0};
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    dyn_array_push_back(queue, &pcb3);
+    ScheduleOverhead_t overhead = { .context_switch_cost = 2, .dispatch_cost = 1 };
+    set_schedule_overhead(&overhead);
+    ScheduleResult_t result;
+    bool success = first_come_first_serve(queue, &result);
+    set_schedule_overhead(NULL);
+    EXPECT_TRUE(success);
+    EXPECT_NEAR(result.average_waiting_time, 9.67, 0.01); // (1 + 12 + 16) / 3
+    EXPECT_NEAR(result.average_turnaround_time, 14.0, 0.01); // (11 + 14 + 17) / 3
+    EXPECT_EQ(20ul, result.total_run_time);
+    EXPECT_EQ(2ul, result.context_switches);
+    EXPECT_EQ(7ul, result.overhead_time);
+    dyn_array_destroy(queue);
+}
+
+// Round Robin pays a context switch on every preemption
+TEST(OverheadTest, RRTwoProcesses) {
+    dyn_array_t *queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 5, .priority = 1, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 3, .priority = 1, .arrival = 0, .started = false };
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    ScheduleOverhead_t overhead = { .context_switch_cost = 1, .dispatch_cost = 0 };
+    set_schedule_overhead(&overhead);
+    ScheduleResult_t result;
+    bool success = round_robin(queue, &result, 2);
+    set_schedule_overhead(NULL);
+    EXPECT_TRUE(success);
+    EXPECT_EQ(12ul, result.total_run_time); // 8 of work + 4 switches
+    EXPECT_NEAR(result.average_waiting_time, 7.0f, 0.01f); // (7 + 7) / 2
+    EXPECT_NEAR(result.average_turnaround_time, 11.0f, 0.01f); // (12 + 10) / 2
+    EXPECT_EQ(4ul, result.context_switches);
+    EXPECT_EQ(4ul, result.overhead_time);
+    dyn_array_destroy(queue);
+}
+
+// SRTF only pays when the running process changes
+TEST(OverheadTest, SRTFValidQueue) {
+    dyn_array_t *queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 6, .priority = 1, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 4, .priority = 1, .arrival = 2, .started = false };
+    ProcessControlBlock_t pcb3 = { .remaining_burst_time = 2, .priority = 1, .arrival = 4, .started = false };
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    dyn_array_push_back(queue, &pcb3);
+    ScheduleOverhead_t overhead = { .context_switch_cost = 1, .dispatch_cost = 0 };
+    set_schedule_overhead(&overhead);
+    ScheduleResult_t result;
+    bool success = shortest_remaining_time_first(queue, &result);
+    set_schedule_overhead(NULL);
+    EXPECT_TRUE(success);
+    EXPECT_NEAR(result.average_waiting_time, 3.67, 0.01); // (0 + 8 + 3) / 3
+    EXPECT_NEAR(result.average_turnaround_time, 7.67, 0.01); // (6 + 12 + 5) / 3
+    EXPECT_EQ(14ul, result.total_run_time);
+    EXPECT_EQ(2ul, result.context_switches);
+    dyn_array_destroy(queue);
+}
+
+// Two maximum bursts overflow a 32 bit clock, the results must stay exact
+TEST(WideTimeTest, PriorityMaxBursts) {
+    dyn_array_t *queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = UINT32_MAX, .priority = 1, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = UINT32_MAX, .priority = 2, .arrival = 0, .started = false };
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    ScheduleResult_t result;
+    bool success = priority(queue, &result);
+    EXPECT_TRUE(success);
+    EXPECT_EQ(2ul * UINT32_MAX, result.total_run_time);
+    EXPECT_EQ((uint64_t)UINT32_MAX, result.total_waiting_time);
+    EXPECT_EQ(3ull * UINT32_MAX, result.total_turnaround_time);
+    EXPECT_EQ(2u, result.process_count);
+    EXPECT_DOUBLE_EQ(2147483647.5, result.mean_waiting_time);
+    EXPECT_DOUBLE_EQ(6442450942.5, result.mean_turnaround_time);
+    dyn_array_destroy(queue);
+}
+
+// Same overflow through round robin, with an idle gap before the second arrival
+TEST(WideTimeTest, RRMaxBursts) {
+    dyn_array_t *queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = UINT32_MAX, .priority = 1, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = UINT32_MAX, .priority = 1, .arrival = UINT32_MAX, .started = false };
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    ScheduleResult_t result;
+    bool success = round_robin(queue, &result, 1ul << 31);
+    EXPECT_TRUE(success);
+    EXPECT_EQ(2ul * UINT32_MAX, result.total_run_time);
+    EXPECT_EQ(0u, result.total_waiting_time);
+    EXPECT_DOUBLE_EQ((double)UINT32_MAX, result.mean_turnaround_time);
+    dyn_array_destroy(queue);
+}
+
+// Simultaneous arrivals take the closed form, billions of one-unit slices would never finish simulating
+TEST(WideTimeTest, RRSimultaneousQuantumOne) {
+    dyn_array_t *queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = UINT32_MAX, .priority = 1, .arrival = 3, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 0, .priority = 1, .arrival = 3, .started = false };
+    ProcessControlBlock_t pcb3 = { .remaining_burst_time = UINT32_MAX, .priority = 1, .arrival = 3, .started = false };
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    dyn_array_push_back(queue, &pcb3);
+    ScheduleResult_t result;
+    bool success = round_robin(queue, &result, 1);
+    EXPECT_TRUE(success);
+    EXPECT_EQ(3ul + 2ul * UINT32_MAX, result.total_run_time);
+    EXPECT_EQ(2ull * UINT32_MAX - 1, result.total_waiting_time);        // (MAX - 1) + 0 + MAX
+    EXPECT_EQ(2ul * UINT32_MAX - 1, result.context_switches);           // the two alternate every slice
+    EXPECT_EQ(3u, result.process_count);
+    dyn_array_destroy(queue);
+}
+
+// SRT only stops at arrivals, so bursts too long to step through one unit at a time still finish
+TEST(WideTimeTest, SRTMaxBursts) {
+    dyn_array_t *queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = UINT32_MAX, .priority = 1, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = UINT32_MAX, .priority = 1, .arrival = 1, .started = false };
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    ScheduleResult_t result;
+    bool success = shortest_remaining_time_first(queue, &result);
+    EXPECT_TRUE(success);
+    EXPECT_EQ(2ul * UINT32_MAX, result.total_run_time);
+    EXPECT_EQ((unsigned long long)UINT32_MAX - 1, result.total_waiting_time);   // 0 + (MAX - 1)
+    EXPECT_EQ(1ul, result.context_switches);
+    EXPECT_EQ(2u, result.process_count);
+    dyn_array_destroy(queue);
+}
+
+// Priority must idle until the first arrival instead of running a process early
+TEST(PriorityTest, IdleStart) {
+    dyn_array_t *queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 4, .priority = 1, .arrival = 10, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 2, .priority = 2, .arrival = 5, .started = false };
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    ScheduleResult_t result;
+    bool success = priority(queue, &result);
+    EXPECT_TRUE(success);
+    EXPECT_EQ(14ul, result.total_run_time);
+    EXPECT_NEAR(result.average_waiting_time, 0.0f, 0.01f);
+    EXPECT_NEAR(result.average_turnaround_time, 3.0f, 0.01f);
+    dyn_array_destroy(queue);
+}
+
+// The ready queue depends on the keys (buckets for a few priority levels, a radix heap while
+// SJF/SRT keys come out in order, a heap otherwise) but never changes the schedule
+TEST(PriorityTest, QueueChoicesAgree) {
+    const size_t n = 3000;
+    dyn_array_t *few_levels = dyn_array_create(n, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_t *many_levels = dyn_array_create(n, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_t *batch = dyn_array_create(n, sizeof(ProcessControlBlock_t), NULL);
+    srand(43);
+    for (size_t i = 0; i < n; i++) {
+        ProcessControlBlock_t pcb = { .remaining_burst_time = 1 + (uint32_t)(rand() % 50), .priority = (uint32_t)(rand() % 8),
+                                      .arrival = (uint32_t)(rand() % 40000), .started = false };
+        dyn_array_push_back(few_levels, &pcb);
+        pcb.priority *= 1000;
+        dyn_array_push_back(many_levels, &pcb);
+        pcb.arrival = 0;
+        pcb.priority = pcb.remaining_burst_time * 100;
+        dyn_array_push_back(batch, &pcb);
+    }
+    auto expect_same = [](const ScheduleResult_t &a, const ScheduleResult_t &b) {
+        EXPECT_EQ(a.total_run_time, b.total_run_time);
+        EXPECT_EQ(a.total_waiting_time, b.total_waiting_time);
+        EXPECT_EQ(a.total_turnaround_time, b.total_turnaround_time);
+        EXPECT_EQ(a.context_switches, b.context_switches);
+    };
+    ScheduleResult_t buckets, heap, sjf, srt;
+    ASSERT_TRUE(priority(few_levels, &buckets));
+    ASSERT_TRUE(priority(many_levels, &heap));
+    expect_same(buckets, heap);
+    // everything arrives at once, so SJF, SRT and priority by burst all run shortest first (ties by index)
+    ASSERT_TRUE(shortest_job_first(batch, &sjf));
+    ASSERT_TRUE(shortest_remaining_time_first(batch, &srt));
+    ASSERT_TRUE(priority(batch, &heap));
+    expect_same(sjf, srt);
+    expect_same(sjf, heap);
+    dyn_array_destroy(few_levels);
+    dyn_array_destroy(many_levels);
+    dyn_array_destroy(batch);
+}
+
+// A view hands out stable, cached orders and never reorders the PCBs
+TEST(PCBViewTest, CachedOrders) {
+    dyn_array_t *queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 4, .priority = 2, .arrival = 7, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 9, .priority = 1, .arrival = 3, .started = false };
+    ProcessControlBlock_t pcb3 = { .remaining_burst_time = 4, .priority = 2, .arrival = 3, .started = false };
+    dyn_array_push_back(queue, &pcb1);
+    dyn_array_push_back(queue, &pcb2);
+    dyn_array_push_back(queue, &pcb3);
+    pcb_view_t *view = pcb_view_create(queue);
+    ASSERT_NE(nullptr, view);
+    EXPECT_EQ(3u, pcb_view_size(view));
+
+    const uint32_t *by_arrival = pcb_view_order(view, PCB_ORDER_ARRIVAL);
+    const uint32_t *by_burst = pcb_view_order(view, PCB_ORDER_BURST);
+    const uint32_t *by_priority = pcb_view_order(view, PCB_ORDER_PRIORITY);
+    ASSERT_NE(nullptr, by_arrival);
+    EXPECT_EQ(1u, by_arrival[0]);
+    EXPECT_EQ(2u, by_arrival[1]);
+    EXPECT_EQ(0u, by_arrival[2]);
+    EXPECT_EQ(0u, by_burst[0]);
+    EXPECT_EQ(2u, by_burst[1]);
+    EXPECT_EQ(1u, by_priority[0]);
+    EXPECT_EQ(by_arrival, pcb_view_order(view, PCB_ORDER_ARRIVAL));
+
+    // every scheduler can run over the same view without disturbing the PCBs
+    ScheduleResult_t fcfs, sjf;
+    EXPECT_TRUE(first_come_first_serve_view(view, &fcfs));
+    EXPECT_TRUE(shortest_job_first_view(view, &sjf));
+    EXPECT_EQ(20ul, fcfs.total_run_time);
+    EXPECT_EQ(20ul, sjf.total_run_time);
+    EXPECT_EQ(7u, ((ProcessControlBlock_t *)dyn_array_at(queue, 0))->arrival);
+    EXPECT_EQ(3u, ((ProcessControlBlock_t *)dyn_array_at(queue, 1))->arrival);
+
+    pcb_view_destroy(view);
+    dyn_array_destroy(queue);
+}
+
+struct KeyedEntry {
+    uint32_t key;
+    uint32_t seq;
+};
+
+static int keyed_entry_cmp(const void *a, const void *b) {
+    const KeyedEntry *ea = (const KeyedEntry *)a;
+    const KeyedEntry *eb = (const KeyedEntry *)b;
+    return (ea->key > eb->key) - (ea->key < eb->key);
+}
+
+// Checks that the array is sorted by key and that equal keys kept their insertion order
+static void expect_stable_sorted(dyn_array_t *array) {
+    for (size_t i = 1; i < dyn_array_size(array); i++) {
+        KeyedEntry *prev = (KeyedEntry *)dyn_array_at(array, i - 1);
+        KeyedEntry *cur = (KeyedEntry *)dyn_array_at(array, i);
+        ASSERT_LE(prev->key, cur->key);
+        if (prev->key == cur->key) {
+            ASSERT_LT(prev->seq, cur->seq);
+        }
+    }
+}
+
+// Parallel sort across several threads must be stable
+TEST(DynArraySortTest, ParallelStable) {
+    const size_t count = 300000;
+    dyn_array_t *array = dyn_array_create(count, sizeof(KeyedEntry), NULL);
+    srand(7);
+    for (uint32_t i = 0; i < count; i++) {
+        KeyedEntry entry = { (uint32_t)(rand() % 1000), i };
+        dyn_array_push_back(array, &entry);
+    }
+    EXPECT_TRUE(dyn_array_sort_parallel(array, keyed_entry_cmp, 4));
+    EXPECT_EQ(count, dyn_array_size(array));
+    expect_stable_sorted(array);
+    dyn_array_destroy(array);
+}
+
+// Small arrays stay on the calling thread but are still stable
+TEST(DynArraySortTest, SmallArrayStable) {
+    dyn_array_t *array = dyn_array_create(0, sizeof(KeyedEntry), NULL);
+    srand(11);
+    for (uint32_t i = 0; i < 1000; i++) {
+        KeyedEntry entry = { (uint32_t)(rand() % 10), i };
+        dyn_array_push_back(array, &entry);
+    }
+    EXPECT_TRUE(dyn_array_sort_parallel(array, keyed_entry_cmp, 8));
+    expect_stable_sorted(array);
+    EXPECT_FALSE(dyn_array_sort_parallel(NULL, keyed_entry_cmp, 8));
+    dyn_array_destroy(array);
+}
+
+// Arrays from an arena grow in place and all go away with one reset
+TEST(DynArrayAllocTest, ArenaBacked) {
+    dyn_arena_t *arena = dyn_arena_create(1 << 20, DYN_ALLOC_ALIGNED);
+    ASSERT_NE(nullptr, arena);
+    const dyn_allocator_t allocator = dyn_arena_allocator(arena);
+    for (int round = 0; round < 3; round++) {
+        dyn_array_t *array = dyn_array_create_with(0, sizeof(uint32_t), NULL, &allocator);
+        ASSERT_NE(nullptr, array);
+        EXPECT_EQ(0u, (uintptr_t)dyn_array_export(array) % 64);
+        for (uint32_t i = 0; i < 10000; i++) {
+            ASSERT_TRUE(dyn_array_push_back(array, &i));
+        }
+        for (uint32_t i = 0; i < 10000; i++) {
+            ASSERT_EQ(i, *(uint32_t *)dyn_array_at(array, i));
+        }
+        // a second array stops the first growing in place, it has to move
+        dyn_array_t *other = dyn_array_create_with(0, sizeof(uint32_t), NULL, &allocator);
+        ASSERT_NE(nullptr, other);
+        for (uint32_t i = 0; i < 100; i++) {
+            ASSERT_TRUE(dyn_array_push_back(array, &i));
+        }
+        EXPECT_EQ(99u, *(uint32_t *)dyn_array_back(array));
+        EXPECT_EQ(0u, *(uint32_t *)dyn_array_front(array));
+        EXPECT_GT(dyn_arena_used(arena), 0u);
+        dyn_arena_reset(arena);
+        EXPECT_EQ(0u, dyn_arena_used(arena));
+    }
+    // running out of arena is an ordinary failure
+    dyn_array_t *array = dyn_array_create_with(0, 4096, NULL, &allocator);
+    ASSERT_NE(nullptr, array);
+    char page[4096] = {0};
+    bool pushed = true;
+    for (int i = 0; i < 1024 && pushed; i++) {
+        pushed = dyn_array_push_back(array, page);
+    }
+    EXPECT_FALSE(pushed);
+    dyn_array_destroy(array);
+    dyn_arena_destroy(arena);
+    EXPECT_EQ(nullptr, dyn_arena_create(0, DYN_ALLOC_DEFAULT));
+}
+
+// The system allocator options keep contents through growth, across the huge page threshold too
+TEST(DynArrayAllocTest, AlignedAndHuge) {
+    const dyn_allocator_t allocator = dyn_allocator_system(DYN_ALLOC_ALIGNED | DYN_ALLOC_HUGE);
+    dyn_array_t *array = dyn_array_create_with(0, sizeof(uint64_t), NULL, &allocator);
+    ASSERT_NE(nullptr, array);
+    for (uint64_t i = 0; i < 1000000; i++) {
+        ASSERT_TRUE(dyn_array_push_back(array, &i));
+        ASSERT_EQ(0u, (uintptr_t)dyn_array_export(array) % 64);
+    }
+    for (uint64_t i = 0; i < 1000000; i += 997) {
+        ASSERT_EQ(i, *(uint64_t *)dyn_array_at(array, i));
+    }
+    dyn_array_destroy(array);
+    const dyn_allocator_t broken = { NULL, NULL, NULL, NULL };
+    EXPECT_EQ(nullptr, dyn_array_create_with(0, sizeof(uint64_t), NULL, &broken));
+}
+
+// Random pushes and pops at both ends, checked against std::deque through several growths
+TEST(DynDequeTest, MatchesStdDeque) {
+    dyn_deque_t *deque = dyn_deque_create(0, sizeof(uint32_t), NULL);
+    ASSERT_NE(nullptr, deque);
+    std::deque<uint32_t> expected;
+    srand(37);
+    for (uint32_t step = 0; step < 20000; step++) {
+        uint32_t value = step;
+        int op = rand() % 5;
+        if (op == 0) {
+            ASSERT_TRUE(dyn_deque_push_front(deque, &value));
+            expected.push_front(value);
+        } else if (op == 1) {
+            ASSERT_TRUE(dyn_deque_push_back(deque, &value));
+            expected.push_back(value);
+        } else if (op == 2) {
+            ASSERT_EQ(!expected.empty(), dyn_deque_extract_front(deque, &value));
+            if (!expected.empty()) {
+                ASSERT_EQ(expected.front(), value);
+                expected.pop_front();
+            }
+        } else if (op == 3) {
+            ASSERT_EQ(!expected.empty(), dyn_deque_pop_back(deque));
+            if (!expected.empty()) expected.pop_back();
+        } else {
+            ASSERT_TRUE(dyn_deque_push_back(deque, &value));
+            expected.push_back(value);
+        }
+        ASSERT_EQ(expected.size(), dyn_deque_size(deque));
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i], *(uint32_t *)dyn_deque_at(deque, i));
+    }
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ(expected.front(), *(uint32_t *)dyn_deque_front(deque));
+    EXPECT_EQ(expected.back(), *(uint32_t *)dyn_deque_back(deque));
+    EXPECT_EQ(nullptr, dyn_deque_at(deque, expected.size()));
+    dyn_deque_destroy(deque);
+}
+
+static size_t deque_destructed;
+static void count_destruct(void *) { deque_destructed++; }
+
+// Destructor runs on pop/clear/destroy but not on extract, NULLs fail
+TEST(DynDequeTest, DestructorAndNulls) {
+    deque_destructed = 0;
+    dyn_deque_t *deque = dyn_deque_create(4, sizeof(uint64_t), count_destruct);
+    ASSERT_NE(nullptr, deque);
+    for (uint64_t i = 0; i < 40; i++) {
+        ASSERT_TRUE(dyn_deque_push_front(deque, &i));
+    }
+    uint64_t value = 0;
+    EXPECT_TRUE(dyn_deque_extract_back(deque, &value));
+    EXPECT_EQ(0u, value);
+    EXPECT_TRUE(dyn_deque_pop_front(deque));
+    EXPECT_EQ(1u, deque_destructed);
+    dyn_deque_clear(deque);
+    EXPECT_EQ(39u, deque_destructed);
+    EXPECT_TRUE(dyn_deque_empty(deque));
+    EXPECT_FALSE(dyn_deque_pop_back(deque));
+    EXPECT_EQ(nullptr, dyn_deque_front(deque));
+    EXPECT_EQ(nullptr, dyn_deque_back(deque));
+    EXPECT_TRUE(dyn_deque_push_back(deque, &value));
+    dyn_deque_destroy(deque);
+    EXPECT_EQ(40u, deque_destructed);
+    EXPECT_FALSE(dyn_deque_push_back(NULL, &value));
+    EXPECT_EQ(nullptr, dyn_deque_create(0, 0, NULL));
+    EXPECT_TRUE(dyn_deque_empty(NULL));
+}
+
+// Random inserts, cancels and advances over the whole 64 bit range, checked against an ordered map
+TEST(TimingWheelTest, MatchesOrderedMap) {
+    const uint32_t ids = 512;
+    timing_wheel_t *wheel = timing_wheel_create(ids, 5);
+    ASSERT_NE(nullptr, wheel);
+    std::map<uint32_t, uint64_t> pending;
+    uint64_t now = 5;
+    srand(41);
+    auto random_time = [&]() -> uint64_t {
+        uint64_t span = 1ull << (rand() % 64);
+        uint64_t offset = (((uint64_t)rand() << 32) ^ (uint64_t)rand()) % span;
+        return rand() % 8 ? (UINT64_MAX - now > offset ? now + offset : UINT64_MAX) : offset;  // some already due
+    };
+    for (int step = 0; step < 20000; step++) {
+        uint32_t id = rand() % ids;
+        int op = rand() % 4;
+        if (op < 2) {
+            uint64_t expiry = random_time();
+            ASSERT_EQ(!pending.count(id), timing_wheel_insert(wheel, id, expiry));
+            pending.insert(std::make_pair(id, expiry));
+        } else if (op == 2) {
+            ASSERT_EQ(pending.erase(id) == 1, timing_wheel_cancel(wheel, id));
+        } else {
+            uint64_t target = random_time();
+            uint32_t expired;
+            uint64_t at;
+            while (timing_wheel_expire(wheel, target, &expired, &at)) {
+                ASSERT_EQ(1u, pending.count(expired));
+                ASSERT_EQ(pending[expired], at);
+                for (const auto &event : pending) {
+                    if (at > now) {
+                        ASSERT_GE(event.second, at);    // what was due came first, then time order
+                    }
+                }
+                ASSERT_LE(at, std::max(target, now));
+                pending.erase(expired);
+            }
+            now = std::max(now, target);
+            EXPECT_EQ(now, timing_wheel_now(wheel));
+            for (const auto &event : pending) {
+                ASSERT_GT(event.second, now);
+            }
+        }
+        ASSERT_EQ(pending.size(), timing_wheel_size(wheel));
+        uint64_t next = 0;
+        ASSERT_EQ(!pending.empty(), timing_wheel_next_expiry(wheel, &next));
+        for (const auto &event : pending) {
+            ASSERT_LE(next, event.second);
+        }
+    }
+    EXPECT_FALSE(timing_wheel_insert(wheel, ids, 0));
+    ASSERT_TRUE(timing_wheel_reset(wheel, 4, 0));
+    EXPECT_EQ(0u, timing_wheel_size(wheel));
+    EXPECT_FALSE(timing_wheel_insert(wheel, 4, 0));
+    EXPECT_TRUE(timing_wheel_insert(wheel, 3, 0));
+    timing_wheel_destroy(wheel);
+    EXPECT_EQ(nullptr, timing_wheel_create((size_t)UINT32_MAX, 0));
+}
+
+static int uint32_cmp(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int uint32_desc_cmp(const void *a, const void *b) { return uint32_cmp(b, a); }
+
+static void add_one(void *const object, void *) { (*(uint32_t *)object)++; }
+
+// The array remembers its order until something can break it, and sorting a sorted array is free
+TEST(DynArraySortedTest, TracksSortedness) {
+    dyn_array_t *array = dyn_array_create(0, sizeof(uint32_t), NULL);
+    for (uint32_t i = 0; i < 1000; i++) {
+        uint32_t value = (i * 7919) % 1000;
+        dyn_array_push_back(array, &value);
+    }
+    EXPECT_FALSE(dyn_array_is_sorted(array, uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort(array, uint32_cmp));
+    EXPECT_TRUE(dyn_array_is_sorted(array, uint32_cmp));
+    EXPECT_FALSE(dyn_array_is_sorted(array, uint32_desc_cmp));
+
+    dyn_array_stats_reset();
+    ASSERT_TRUE(dyn_array_sort(array, uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort_parallel(array, uint32_cmp, 4));
+    EXPECT_EQ(0u, dyn_array_stats().comparisons);
+
+    // in order additions and any removal keep it, the rest forget it
+    uint32_t big = 5000, small = 0;
+    ASSERT_TRUE(dyn_array_push_back(array, &big));
+    ASSERT_TRUE(dyn_array_insert(array, 0, &small));
+    ASSERT_TRUE(dyn_array_erase(array, 500));
+    ASSERT_TRUE(dyn_array_insert_sorted(array, &big, uint32_cmp));
+    EXPECT_TRUE(dyn_array_is_sorted(array, uint32_cmp));
+    ASSERT_TRUE(dyn_array_push_front(array, &big));
+    EXPECT_FALSE(dyn_array_is_sorted(array, uint32_cmp));
+
+    // sorting data that happens to be in order finds out in one pass
+    ASSERT_TRUE(dyn_array_pop_front(array));
+    ASSERT_TRUE(dyn_array_sort(array, uint32_cmp));
+    EXPECT_TRUE(dyn_array_for_each(array, add_one, NULL));
+    EXPECT_FALSE(dyn_array_is_sorted(array, uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort(array, uint32_desc_cmp));
+    EXPECT_TRUE(dyn_array_is_sorted(array, uint32_desc_cmp));
+    for (size_t i = 1; i < dyn_array_size(array); i++) {
+        ASSERT_GE(*(uint32_t *)dyn_array_at(array, i - 1), *(uint32_t *)dyn_array_at(array, i));
+    }
+    EXPECT_FALSE(dyn_array_is_sorted(NULL, uint32_cmp));
+    dyn_array_destroy(array);
+}
+
+// writable pointers forget the order (a write through one could break it), read only ones keep it
+TEST(DynArraySortedTest, WritableAccessForgets) {
+    dyn_array_t *array = dyn_array_create(0, sizeof(uint32_t), NULL);
+    const uint32_t values[] = {3, 1, 2};
+    ASSERT_TRUE(dyn_array_push_back_n(array, values, 3));
+    ASSERT_TRUE(dyn_array_sort(array, uint32_cmp));
+    EXPECT_EQ(1u, *(const uint32_t *)dyn_array_peek(array, 0));
+    EXPECT_EQ(3u, ((const uint32_t *)dyn_array_contents(array))[2]);
+    EXPECT_EQ(nullptr, dyn_array_peek(array, 3));
+    EXPECT_TRUE(dyn_array_is_sorted(array, uint32_cmp));
+
+    *(uint32_t *)dyn_array_at(array, 0) = 99;
+    EXPECT_FALSE(dyn_array_is_sorted(array, uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort(array, uint32_cmp));
+    uint32_t zero = 0;
+    ASSERT_TRUE(dyn_array_insert_sorted(array, &zero, uint32_cmp));
+    const uint32_t expected[] = {0, 2, 3, 99};
+    ASSERT_EQ(4u, dyn_array_size(array));
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_EQ(expected[i], *(const uint32_t *)dyn_array_peek(array, i));
+    }
+
+    ASSERT_NE(nullptr, dyn_array_front(array));
+    EXPECT_FALSE(dyn_array_is_sorted(array, uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort(array, uint32_cmp));
+    ASSERT_NE(nullptr, dyn_array_back(array));
+    EXPECT_FALSE(dyn_array_is_sorted(array, uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort(array, uint32_cmp));
+    ASSERT_NE(nullptr, dyn_array_export(array));
+    EXPECT_FALSE(dyn_array_is_sorted(array, uint32_cmp));
+    dyn_array_destroy(array);
+}
+
+// reserve grows once up front, shrink_to_fit trims and growth goes back to powers of two afterwards
+TEST(DynArraySortedTest, ReserveAndShrink) {
+    dyn_array_t *array = dyn_array_create(0, sizeof(uint32_t), NULL);
+    ASSERT_TRUE(dyn_array_reserve(array, 1000));
+    EXPECT_EQ(1024u, dyn_array_capacity(array));
+    EXPECT_TRUE(dyn_array_reserve(array, 10));
+    EXPECT_EQ(1024u, dyn_array_capacity(array));
+    for (uint32_t i = 0; i < 100; i++) {
+        dyn_array_push_back(array, &i);
+    }
+    dyn_array_shrink_to_fit(array);
+    EXPECT_EQ(100u, dyn_array_capacity(array));
+    uint32_t value = 100;
+    ASSERT_TRUE(dyn_array_push_back(array, &value));
+    EXPECT_EQ(128u, dyn_array_capacity(array));
+    for (uint32_t i = 0; i <= 100; i++) {
+        ASSERT_EQ(i, *(uint32_t *)dyn_array_at(array, i));
+    }
+
+    // an empty array keeps room for one and still grows
+    dyn_array_clear(array);
+    dyn_array_shrink_to_fit(array);
+    EXPECT_EQ(1u, dyn_array_capacity(array));
+    for (uint32_t i = 0; i < 40; i++) {
+        ASSERT_TRUE(dyn_array_push_back(array, &i));
+    }
+    EXPECT_EQ(64u, dyn_array_capacity(array));
+    EXPECT_FALSE(dyn_array_reserve(NULL, 10));
+    dyn_array_shrink_to_fit(NULL);
+    dyn_array_destroy(array);
+}
+
+static bool is_odd(const void *const object, void *) { return *(const uint32_t *)object & 1; }
+
+// Bulk append, batch merge and one pass erase agree with doing it an object at a time
+TEST(DynArrayBulkTest, PushMergeEraseIf) {
+    dyn_array_t *bulk = dyn_array_create(0, sizeof(uint32_t), NULL);
+    dyn_array_t *single = dyn_array_create(0, sizeof(uint32_t), NULL);
+    srand(23);
+    uint32_t values[500];
+    for (size_t i = 0; i < 500; i++) {
+        values[i] = (uint32_t)(rand() % 300);
+    }
+    ASSERT_TRUE(dyn_array_push_back_n(bulk, values, 200));
+    for (size_t i = 0; i < 200; i++) {
+        ASSERT_TRUE(dyn_array_insert_sorted(single, &values[i], uint32_cmp));
+    }
+    ASSERT_TRUE(dyn_array_sort(bulk, uint32_cmp));
+    qsort(values + 200, 300, sizeof(uint32_t), uint32_cmp);
+    ASSERT_TRUE(dyn_array_merge_sorted(bulk, values + 200, 300, uint32_cmp));
+    for (size_t i = 200; i < 500; i++) {
+        ASSERT_TRUE(dyn_array_insert_sorted(single, &values[i], uint32_cmp));
+    }
+    ASSERT_EQ(500u, dyn_array_size(bulk));
+    ASSERT_EQ(500u, dyn_array_size(single));
+    EXPECT_TRUE(dyn_array_is_sorted(bulk, uint32_cmp));
+    for (size_t i = 0; i < 500; i++) {
+        ASSERT_EQ(*(const uint32_t *)dyn_array_peek(single, i), *(const uint32_t *)dyn_array_peek(bulk, i));
+    }
+
+    size_t odd = 0;
+    for (size_t i = 0; i < 500; i++) {
+        odd += *(const uint32_t *)dyn_array_peek(bulk, i) & 1;
+    }
+    EXPECT_EQ(odd, dyn_array_erase_if(bulk, is_odd, NULL));
+    EXPECT_EQ(500u - odd, dyn_array_size(bulk));
+    EXPECT_TRUE(dyn_array_is_sorted(bulk, uint32_cmp));
+    for (size_t i = 0; i < dyn_array_size(bulk); i++) {
+        ASSERT_EQ(0u, *(const uint32_t *)dyn_array_peek(bulk, i) & 1);
+    }
+    EXPECT_EQ(0u, dyn_array_erase_if(bulk, is_odd, NULL));
+    EXPECT_EQ(0u, dyn_array_erase_if(NULL, is_odd, NULL));
+    EXPECT_FALSE(dyn_array_push_back_n(bulk, NULL, 3));
+    EXPECT_FALSE(dyn_array_merge_sorted(bulk, values, 0, uint32_cmp));
+    dyn_array_destroy(bulk);
+    dyn_array_destroy(single);
+}
+
+// Files bigger than a read chunk load completely, short files fail
+TEST(LoadPCB, ChunkedFile) {
+    const char *path = "chunked_pcb.bin";
+    const uint32_t count = 2500;
+    FILE *fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    fwrite(&count, sizeof(count), 1, fp);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t record[3] = { i % 17 + 1, i % 5, i };
+        fwrite(record, sizeof(record), 1, fp);
+    }
+    fclose(fp);
+    dyn_array_t *pcbs = load_process_control_blocks(path);
+    ASSERT_NE(nullptr, pcbs);
+    ASSERT_EQ(count, dyn_array_size(pcbs));
+    for (uint32_t i = 0; i < count; i += 7) {
+        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(pcbs, i);
+        EXPECT_EQ(i % 17 + 1, pcb->remaining_burst_time);
+        EXPECT_EQ(i % 5, pcb->priority);
+        EXPECT_EQ(i, pcb->arrival);
+        EXPECT_FALSE(pcb->started);
+    }
+    dyn_array_destroy(pcbs);
+    ASSERT_EQ(0, truncate(path, 4 + 12 * 2000));
+    EXPECT_EQ(nullptr, load_process_control_blocks(path));
+    remove(path);
+}
+
+// DynArray owns, moves and lends its dyn_array without copying, and sorts with inlined comparators
+TEST(DynArrayHppTest, MoveAndInterop) {
+    static_assert(!std::is_copy_constructible<DynArray<uint32_t> >::value, "DynArray is move only");
+    DynArray<ProcessControlBlock_t> pcbs = DynArray<ProcessControlBlock_t>::adopt(load_process_control_blocks("pcb.bin"));
+    ASSERT_EQ(4u, pcbs.size());
+    const ProcessControlBlock_t *storage = pcbs.data();
+    DynArray<ProcessControlBlock_t> moved(std::move(pcbs));
+    EXPECT_EQ(storage, moved.data());
+    EXPECT_EQ(nullptr, pcbs.get());
+    EXPECT_TRUE(pcbs.empty());
+    DynArray<ProcessControlBlock_t> assigned = DynArray<ProcessControlBlock_t>::adopt(load_process_control_blocks("pcb.bin"));
+    assigned = std::move(moved);
+    EXPECT_EQ(storage, assigned.data());
+    EXPECT_EQ(nullptr, moved.get());
+    moved = std::move(assigned);
+    EXPECT_EQ(nullptr, assigned.get());
+
+    ScheduleResult_t from_wrapper, from_c;
+    ASSERT_TRUE(first_come_first_serve(moved.get(), &from_wrapper));
+    dyn_array_t *raw = load_process_control_blocks("pcb.bin");
+    ASSERT_TRUE(first_come_first_serve(raw, &from_c));
+    dyn_array_destroy(raw);
+    EXPECT_EQ(from_c.total_run_time, from_wrapper.total_run_time);
+
+    moved.sort([](const ProcessControlBlock_t &a, const ProcessControlBlock_t &b) {
+        return a.remaining_burst_time < b.remaining_burst_time;
+    });
+    EXPECT_TRUE(std::is_sorted(moved.begin(), moved.end(), [](const ProcessControlBlock_t &a, const ProcessControlBlock_t &b) {
+        return a.remaining_burst_time < b.remaining_burst_time;
+    }));
+    uint64_t bursts = 0;
+    std::for_each(moved.begin(), moved.end(), [&bursts](const ProcessControlBlock_t &pcb) { bursts += pcb.remaining_burst_time; });
+    EXPECT_EQ(from_c.total_run_time, bursts);
+
+    dyn_array_t *released = moved.release();
+    EXPECT_EQ(storage, dyn_array_export(released));
+    dyn_array_destroy(released);
+
+    DynArray<uint32_t> numbers;
+    for (uint32_t i = 0; i < 100; i++) {
+        numbers.insert_sorted((i * 37) % 100, std::less<uint32_t>());
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        ASSERT_EQ(i, numbers[i]);
+    }
+    EXPECT_EQ(50u, numbers.erase_if([](uint32_t value) { return value % 2 == 1; }));
+    EXPECT_EQ(98u, numbers.back());
+    EXPECT_THROW(numbers.at(50), std::out_of_range);
+    dyn_array_t *wrong_size = load_process_control_blocks("pcb.bin");
+    EXPECT_THROW(DynArray<uint64_t>::adopt(wrong_size), std::invalid_argument);
+    dyn_array_destroy(wrong_size);
+    EXPECT_THROW(DynArray<uint32_t>::adopt(NULL), std::invalid_argument);
+
+    // a sort in C++ drops the order the C side remembered
+    DynArray<uint32_t> c_sorted;
+    for (uint32_t i = 0; i < 10; i++) c_sorted.push_back(i);
+    ASSERT_TRUE(dyn_array_sort(c_sorted.get(), uint32_cmp));
+    c_sorted.sort(std::greater<uint32_t>());
+    EXPECT_FALSE(dyn_array_is_sorted(c_sorted.get(), uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort(c_sorted.get(), uint32_cmp));
+    EXPECT_EQ(0u, c_sorted.front());
+
+    // writes through the non-const accessors drop it too, reads through a const one keep it
+    EXPECT_FALSE(dyn_array_is_sorted(c_sorted.get(), uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort(c_sorted.get(), uint32_cmp));
+    const DynArray<uint32_t> &readonly = c_sorted;
+    EXPECT_EQ(9u, readonly[9]);
+    EXPECT_TRUE(std::binary_search(readonly.begin(), readonly.end(), 5u));
+    c_sorted.insert_sorted(5u, std::less<uint32_t>());
+    EXPECT_TRUE(dyn_array_is_sorted(c_sorted.get(), uint32_cmp));
+    EXPECT_EQ(6u, c_sorted.erase_if([](uint32_t value) { return value % 2 == 1; }));
+    EXPECT_TRUE(dyn_array_is_sorted(c_sorted.get(), uint32_cmp));
+    c_sorted[0] = 100;
+    EXPECT_FALSE(dyn_array_is_sorted(c_sorted.get(), uint32_cmp));
+    ASSERT_TRUE(dyn_array_sort(c_sorted.get(), uint32_cmp));
+    *c_sorted.begin() = 100;
+    EXPECT_FALSE(dyn_array_is_sorted(c_sorted.get(), uint32_cmp));
+}
+
+// The sorted loader hands back the PCBs in arrival order
+TEST(LoadPCB, SortedFile) {
+    dyn_array_t *pcb_array = load_process_control_blocks_sorted("pcb.bin", 2);
+    ASSERT_NE(nullptr, pcb_array);
+    for (size_t i = 1; i < dyn_array_size(pcb_array); i++) {
+        EXPECT_LE(((ProcessControlBlock_t *)dyn_array_at(pcb_array, i - 1))->arrival,
+                  ((ProcessControlBlock_t *)dyn_array_at(pcb_array, i))->arrival);
+    }
+    dyn_array_destroy(pcb_array);
+}
+
+// Editing a PCB in place after a sorted load drops the sorted flag, so the schedule sees the new order
+TEST(LoadPCB, EditAfterSortedLoad) {
+    dyn_array_t *sorted = load_process_control_blocks_sorted("pcb.bin", 1);
+    ASSERT_NE(nullptr, sorted);
+    ((ProcessControlBlock_t *)dyn_array_at(sorted, 0))->arrival = 1000;
+    dyn_array_t *copy = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    for (size_t i = 0; i < dyn_array_size(sorted); i++) {
+        dyn_array_push_back(copy, dyn_array_at(sorted, i));
+    }
+    ScheduleResult_t edited = {}, fresh = {};
+    ASSERT_TRUE(first_come_first_serve(sorted, &edited));
+    ASSERT_TRUE(first_come_first_serve(copy, &fresh));
+    EXPECT_EQ(fresh.total_run_time, edited.total_run_time);
+    EXPECT_EQ(fresh.total_waiting_time, edited.total_waiting_time);
+    EXPECT_EQ(fresh.total_turnaround_time, edited.total_turnaround_time);
+    dyn_array_destroy(copy);
+    dyn_array_destroy(sorted);
+}
+
+// Builds a random trace with idle gaps and ties on arrival
+static dyn_array_t *random_trace(size_t count, unsigned seed, uint32_t arrival_range, uint32_t burst_range) {
+    dyn_array_t *queue = dyn_array_create(count, sizeof(ProcessControlBlock_t), NULL);
+    srand(seed);
+    for (size_t i = 0; i < count; i++) {
+        ProcessControlBlock_t pcb = { .remaining_burst_time = (uint32_t)(rand() % burst_range),
+                                      .priority = (uint32_t)(rand() % 8),
+                                      .arrival = (uint32_t)(rand() % arrival_range), .started = false };
+        dyn_array_push_back(queue, &pcb);
+    }
+    return queue;
+}
+
+static void expect_same_result(const ScheduleResult_t &a, const ScheduleResult_t &b) {
+    EXPECT_EQ(a.total_run_time, b.total_run_time);
+    EXPECT_EQ(a.total_waiting_time, b.total_waiting_time);
+    EXPECT_EQ(a.total_turnaround_time, b.total_turnaround_time);
+    EXPECT_EQ(a.process_count, b.process_count);
+    EXPECT_EQ(a.context_switches, b.context_switches);
+    EXPECT_EQ(a.overhead_time, b.overhead_time);
+    EXPECT_DOUBLE_EQ(a.mean_waiting_time, b.mean_waiting_time);
+}
+
+// The parallel prefix scan matches the sequential FCFS exactly, overhead included
+TEST(FCFSTest, ParallelMatchesSequential) {
+    dyn_array_t *queue = random_trace(50000, 3, 2000000, 100);
+    pcb_view_t *view = pcb_view_create(queue);
+    ScheduleOverhead_t overhead = { .context_switch_cost = 3, .dispatch_cost = 1 };
+    set_schedule_overhead(&overhead);
+    ScheduleResult_t sequential;
+    set_schedule_threads(1);
+    ASSERT_TRUE(first_come_first_serve_view(view, &sequential));
+    set_schedule_threads(0);
+    for (size_t threads = 1; threads <= 7; threads += 3) {
+        ScheduleResult_t parallel;
+        ASSERT_TRUE(first_come_first_serve_parallel_view(view, &parallel, threads));
+        expect_same_result(sequential, parallel);
+    }
+    set_schedule_overhead(NULL);
+    pcb_view_destroy(view);
+    dyn_array_destroy(queue);
+}
+
+// Scheduling busy periods concurrently matches every non-preemptive scheduler exactly
+TEST(BusyPeriodTest, MatchesSequential) {
+    dyn_array_t *queue = random_trace(20000, 4, 1000000, 100);
+    pcb_view_t *view = pcb_view_create(queue);
+    ScheduleOverhead_t overhead = { .context_switch_cost = 2, .dispatch_cost = 1 };
+    set_schedule_overhead(&overhead);
+    set_schedule_threads(1);
+    ScheduleResult_t fcfs, sjf, prio;
+    ASSERT_TRUE(first_come_first_serve_view(view, &fcfs));
+    ASSERT_TRUE(shortest_job_first_view(view, &sjf));
+    ASSERT_TRUE(priority_view(view, &prio));
+    set_schedule_threads(0);
+    for (size_t threads = 1; threads <= 4; threads += 3) {
+        ScheduleResult_t parallel;
+        ASSERT_TRUE(busy_period_view(view, BUSY_PERIOD_FCFS, &parallel, threads));
+        expect_same_result(fcfs, parallel);
+        ASSERT_TRUE(busy_period_view(view, BUSY_PERIOD_SJF, &parallel, threads));
+        expect_same_result(sjf, parallel);
+        ASSERT_TRUE(busy_period_view(view, BUSY_PERIOD_PRIORITY, &parallel, threads));
+        expect_same_result(prio, parallel);
+    }
+    set_schedule_overhead(NULL);
+    pcb_view_destroy(view);
+    dyn_array_destroy(queue);
+}
+
+// Stats count the run when compiled in, and stay at zero when compiled out
+TEST(StatsTest, CountsOrZero) {
+    dyn_array_t *queue = random_trace(100, 5, 1000, 20);
+    reset_schedule_stats();
+    ScheduleResult_t result;
+    ASSERT_TRUE(shortest_remaining_time_first(queue, &result));
+    ProcessControlBlock_t pcb = { .remaining_burst_time = 1, .priority = 1, .arrival = 0, .started = false };
+    ASSERT_TRUE(dyn_array_push_front(queue, &pcb));
+    ScheduleStats_t stats = get_schedule_stats();
+    if (schedule_stats_enabled()) {
+        EXPECT_EQ(result.context_switches, stats.context_switches);
+        EXPECT_GT(stats.dispatches, stats.context_switches);
+        EXPECT_GE(stats.pcbs_scanned, stats.dispatches);
+        EXPECT_GT(stats.unit_ticks, 0u);
+        EXPECT_GT(stats.mallocs, 0u);
+        EXPECT_EQ(100 * sizeof(ProcessControlBlock_t), stats.bytes_moved);
+    }
+    else {
+        EXPECT_EQ(0u, stats.dispatches);
+        EXPECT_EQ(0u, stats.pcbs_scanned);
+        EXPECT_EQ(0u, stats.bytes_moved);
+        EXPECT_EQ(0u, stats.mallocs);
+    }
+    dyn_array_destroy(queue);
+}
+
+// A reused workspace gives the same answers and, once grown, stops allocating
+TEST(WorkspaceTest, ReuseMatchesAndStopsAllocating) {
+    dyn_array_t *big = random_trace(2000, 6, 5000, 40);
+    dyn_array_t *small = random_trace(1500, 7, 5000, 40);
+    sched_workspace_t *ws = sched_workspace_create();
+    ASSERT_NE(nullptr, ws);
+    set_schedule_threads(1);
+    for (int pass = 0; pass < 3; pass++) {
+        dyn_array_t *queue = pass == 2 ? small : big;
+        ScheduleResult_t plain[5], reused[5];
+        ASSERT_TRUE(first_come_first_serve(queue, &plain[0]));
+        ASSERT_TRUE(shortest_job_first(queue, &plain[1]));
+        ASSERT_TRUE(priority(queue, &plain[2]));
+        ASSERT_TRUE(round_robin(queue, &plain[3], 3));
+        ASSERT_TRUE(shortest_remaining_time_first(queue, &plain[4]));
+
+        reset_schedule_stats();
+        ASSERT_TRUE(first_come_first_serve_ws(queue, &reused[0], ws));
+        ASSERT_TRUE(shortest_job_first_ws(queue, &reused[1], ws));
+        ASSERT_TRUE(priority_ws(queue, &reused[2], ws));
+        ASSERT_TRUE(round_robin_ws(queue, &reused[3], 3, ws));
+        ASSERT_TRUE(shortest_remaining_time_first_ws(queue, &reused[4], ws));
+        if (pass > 0) {
+            EXPECT_EQ(0u, get_schedule_stats().mallocs);  // always 0 when stats are compiled out
+        }
+        for (int i = 0; i < 5; i++) {
+            expect_same_result(plain[i], reused[i]);
+        }
+    }
+    ScheduleResult_t unused;
+    EXPECT_FALSE(priority_ws(NULL, &unused, ws));
+    EXPECT_FALSE(priority_ws(big, &unused, NULL));
+    set_schedule_threads(0);
+    sched_workspace_destroy(ws);
+    dyn_array_destroy(big);
+    dyn_array_destroy(small);
+}
+
+// With one phase per process and no I/O, every policy matches its single burst scheduler
+TEST(IoScheduleTest, SinglePhaseMatchesSchedulers) {
+    dyn_array_t *queue = random_trace(3000, 8, 20000, 40);
+    for (size_t i = 0; i < dyn_array_size(queue); i++) {
+        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(queue, i);
+        pcb->remaining_burst_time += pcb->remaining_burst_time == 0;    // empty bursts are dispatched there, skipped here
+    }
+    IoTrace_t *trace = io_trace_from_pcbs(queue);
+    ASSERT_NE(nullptr, trace);
+    ScheduleOverhead_t overhead = { .context_switch_cost = 2, .dispatch_cost = 1 };
+    set_schedule_overhead(&overhead);
+    ScheduleResult_t plain[5];
+    ASSERT_TRUE(first_come_first_serve(queue, &plain[0]));
+    ASSERT_TRUE(shortest_job_first(queue, &plain[1]));
+    ASSERT_TRUE(priority(queue, &plain[2]));
+    ASSERT_TRUE(round_robin(queue, &plain[3], 4));
+    ASSERT_TRUE(shortest_remaining_time_first(queue, &plain[4]));
+    for (int policy = IO_POLICY_FCFS; policy <= IO_POLICY_SRT; policy++) {
+        IoScheduleResult_t io;
+        ASSERT_TRUE(schedule_io(trace, (IO_POLICY)policy, 4, &io));
+        expect_same_result(plain[policy], io.schedule);
+        EXPECT_EQ(0u, io.io_busy_time);
+        EXPECT_EQ(0.0, io.io_overlap);
+    }
+    IoScheduleResult_t unused;
+    EXPECT_FALSE(schedule_io(trace, IO_POLICY_RR, 0, &unused));
+    EXPECT_FALSE(schedule_io(NULL, IO_POLICY_FCFS, 0, &unused));
+    set_schedule_overhead(NULL);
+    io_trace_destroy(trace);
+    dyn_array_destroy(queue);
+}
+
+// Two processes sharing a device, worked out by hand, then the same trace through a file
+TEST(IoScheduleTest, DevicesAndPreemption) {
+    IoTrace_t *trace = io_trace_create(1);
+    ASSERT_NE(nullptr, trace);
+    const IoPhase_t first[] = { {3, 4, 0}, {2, 0, 0} };
+    const IoPhase_t second[] = { {2, 3, 0}, {1, 0, 0} };
+    const IoPhase_t bad[] = { {1, 1, 1} };
+    ASSERT_TRUE(io_trace_add(trace, 0, 0, first, 2));
+    ASSERT_TRUE(io_trace_add(trace, 0, 0, second, 2));
+    EXPECT_FALSE(io_trace_add(trace, 0, 0, bad, 1));    // no device 1
+    EXPECT_FALSE(io_trace_add(trace, 0, 0, first, 0));
+
+    // FCFS: CPU 0-3 P0, 3-5 P1, idle, 7-9 P0, idle, 10-11 P1. The device: 3-7 P0, 7-10 P1 (queued since 5)
+    IoScheduleResult_t io;
+    ASSERT_TRUE(schedule_io(trace, IO_POLICY_FCFS, 0, &io));
+    EXPECT_EQ(11u, io.schedule.total_run_time);
+    EXPECT_EQ(20u, io.schedule.total_turnaround_time);
+    EXPECT_EQ(3u, io.schedule.total_waiting_time);
+    EXPECT_EQ(3u, io.schedule.context_switches);
+    EXPECT_EQ(8u, io.cpu_busy_time);
+    EXPECT_EQ(7u, io.io_busy_time);
+    EXPECT_EQ(4u, io.io_overlap_time);
+    EXPECT_EQ(2u, io.device_wait_time);
+    EXPECT_DOUBLE_EQ(8.0 / 11.0, io.cpu_utilization);
+    EXPECT_DOUBLE_EQ(4.0 / 7.0, io.io_overlap);
+
+    // Written out and loaded back, it schedules the same
+    const char *path = "io_trace.bin";
+    FILE *fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    const uint32_t file[] = { 1, 2, 0, 0, 2, 3, 4, 0, 2, 0, 0, 0, 0, 2, 2, 3, 0, 1, 0, 0 };
+    ASSERT_EQ(20u, fwrite(file, sizeof(uint32_t), 20, fp));
+    fclose(fp);
+    IoTrace_t *loaded = load_io_trace(path);
+    remove(path);
+    ASSERT_NE(nullptr, loaded);
+    IoScheduleResult_t again;
+    ASSERT_TRUE(schedule_io(loaded, IO_POLICY_FCFS, 0, &again));
+    expect_same_result(io.schedule, again.schedule);
+    EXPECT_EQ(io.io_overlap_time, again.io_overlap_time);
+    io_trace_destroy(loaded);
+    io_trace_destroy(trace);
+
+    // SRT: P0 runs 0-1 and goes to the device while P1 computes, then takes the CPU back at 3
+    trace = io_trace_create(1);
+    ASSERT_NE(nullptr, trace);
+    const IoPhase_t quick[] = { {1, 2, 0}, {1, 0, 0} };
+    const IoPhase_t long_burst[] = { {10, 0, 0} };
+    ASSERT_TRUE(io_trace_add(trace, 0, 0, quick, 2));
+    ASSERT_TRUE(io_trace_add(trace, 0, 0, long_burst, 1));
+    ASSERT_TRUE(schedule_io(trace, IO_POLICY_SRT, 0, &io));
+    EXPECT_EQ(12u, io.schedule.total_run_time);
+    EXPECT_EQ(16u, io.schedule.total_turnaround_time);
+    EXPECT_EQ(2u, io.schedule.total_waiting_time);
+    EXPECT_EQ(3u, io.schedule.context_switches);
+    EXPECT_DOUBLE_EQ(1.0, io.cpu_utilization);
+    EXPECT_DOUBLE_EQ(1.0, io.io_overlap);
+    io_trace_destroy(trace);
+}
+
+struct QueueProducer {
+    pcb_queue_t *queue;
+    uint32_t id;
+    uint32_t count;
+};
+
+// Pushes count PCBs tagged (id, sequence number), in batches of up to 7, retrying while the queue is full
+static void *produce_pcbs(void *arg) {
+    QueueProducer *producer = (QueueProducer *)arg;
+    ProcessControlBlock_t batch[7];
+    for (uint32_t sent = 0; sent < producer->count; ) {
+        uint32_t size = std::min<uint32_t>(1 + sent % 7, producer->count - sent);
+        for (uint32_t i = 0; i < size; i++) {
+            batch[i] = ProcessControlBlock_t{ .remaining_burst_time = 1, .priority = producer->id,
+                                              .arrival = sent + i, .started = false };
+        }
+        size_t pushed = pcb_queue_push_n(producer->queue, batch, size);
+        sent += (uint32_t)pushed;
+        if (!pushed) sched_yield();
+    }
+    return NULL;
+}
+
+// Producers racing through a small queue: everything comes out once, each producer's PCBs in order
+TEST(PCBQueueTest, ProducersDrainInOrder) {
+    pcb_queue_t *queue = pcb_queue_create(100);
+    ASSERT_NE(nullptr, queue);
+    EXPECT_EQ(128u, pcb_queue_capacity(queue));
+    const uint32_t producers = 4, each = 50000;
+    pthread_t threads[producers];
+    QueueProducer work[producers];
+    for (uint32_t p = 0; p < producers; p++) {
+        work[p] = QueueProducer{ queue, p, each };
+        ASSERT_EQ(0, pthread_create(&threads[p], NULL, produce_pcbs, &work[p]));
+    }
+    dyn_array_t *drained = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    while (dyn_array_size(drained) < producers * each) {
+        if (!pcb_queue_drain(queue, drained, 1000)) sched_yield();
+    }
+    for (uint32_t p = 0; p < producers; p++) {
+        pthread_join(threads[p], NULL);
+    }
+    EXPECT_EQ(0u, pcb_queue_drain(queue, drained, SIZE_MAX));
+    uint32_t next[producers] = {0};
+    for (size_t i = 0; i < dyn_array_size(drained); i++) {
+        const ProcessControlBlock_t *pcb = (const ProcessControlBlock_t *)dyn_array_at(drained, i);
+        ASSERT_LT(pcb->priority, producers);
+        ASSERT_EQ(next[pcb->priority]++, pcb->arrival);
+    }
+
+    // a full queue takes what fits of a batch, then nothing
+    ProcessControlBlock_t batch[100] = {};
+    EXPECT_EQ(100u, pcb_queue_push_n(queue, batch, 100));
+    EXPECT_EQ(28u, pcb_queue_push_n(queue, batch, 100));
+    EXPECT_FALSE(pcb_queue_push(queue, batch));
+    dyn_array_clear(drained);
+    EXPECT_EQ(28u, pcb_queue_drain(queue, drained, 28));
+    EXPECT_TRUE(pcb_queue_push(queue, batch));
+    EXPECT_EQ(101u, pcb_queue_drain(queue, drained, SIZE_MAX));
+    EXPECT_EQ(129u, dyn_array_size(drained));
+    dyn_array_destroy(drained);
+    pcb_queue_destroy(queue);
+}
+
+struct PrefetchList {
+    const char **paths;
+    size_t count, next;
+};
+
+static const char *prefetch_next_path(void *context) {
+    PrefetchList *list = (PrefetchList *)context;
+    return list->next < list->count ? list->paths[list->next++] : NULL;
+}
+
+// Prefetched files (several read chunks, missing, short, repeated) match load_process_control_blocks
+TEST(PCBPrefetchTest, MatchesLoader) {
+    const char *big = "prefetch_pcb.bin", *short_file = "prefetch_short.bin";
+    const uint32_t count = 150000;
+    FILE *fp = fopen(big, "wb");
+    ASSERT_NE(nullptr, fp);
+    fwrite(&count, sizeof(count), 1, fp);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t record[3] = { i % 29 + 1, i % 7, i / 3 };
+        fwrite(record, sizeof(record), 1, fp);
+    }
+    fclose(fp);
+    fp = fopen(short_file, "wb");
+    ASSERT_NE(nullptr, fp);
+    fwrite(&count, sizeof(count), 1, fp);
+    fclose(fp);
+
+    const char *paths[] = { "pcb.bin", big, "no_such_pcb.bin", short_file, big, "pcb.bin" };
+    const size_t files = sizeof(paths) / sizeof(paths[0]);
+    PrefetchList list = { paths, files, 0 };
+    pcb_prefetch_t *prefetch = pcb_prefetch_start(prefetch_next_path, &list, 1);
+    ASSERT_NE(nullptr, prefetch);
+    const char *path;
+    double seconds = -1;
+    for (size_t file = 0; file < files; file++) {
+        dyn_array_t *pcbs = pcb_prefetch_next(prefetch, &path, &seconds);
+        ASSERT_EQ(paths[file], path);
+        EXPECT_LE(0, seconds);
+        dyn_array_t *expected = load_process_control_blocks(paths[file]);
+        if (!expected) {
+            EXPECT_EQ(nullptr, pcbs);
+            continue;
+        }
+        ASSERT_NE(nullptr, pcbs);
+        ASSERT_EQ(dyn_array_size(expected), dyn_array_size(pcbs));
+        for (size_t i = 0; i < dyn_array_size(pcbs); i++) {
+            const ProcessControlBlock_t *want = (const ProcessControlBlock_t *)dyn_array_at(expected, i);
+            const ProcessControlBlock_t *got = (const ProcessControlBlock_t *)dyn_array_at(pcbs, i);
+            ASSERT_EQ(want->remaining_burst_time, got->remaining_burst_time);
+            ASSERT_EQ(want->priority, got->priority);
+            ASSERT_EQ(want->arrival, got->arrival);
+            ASSERT_EQ(want->started, got->started);
+        }
+        dyn_array_destroy(expected);
+        pcb_prefetch_recycle(prefetch, pcbs);
+    }
+    EXPECT_EQ(nullptr, pcb_prefetch_next(prefetch, &path, NULL));
+    EXPECT_EQ(nullptr, path);
+    pcb_prefetch_destroy(prefetch);
+
+    // stopping early drops the files loaded ahead
+    list.next = 0;
+    prefetch = pcb_prefetch_start(prefetch_next_path, &list, 2);
+    ASSERT_NE(nullptr, prefetch);
+    pcb_prefetch_recycle(prefetch, pcb_prefetch_next(prefetch, &path, NULL));
+    pcb_prefetch_destroy(prefetch);
+    remove(big);
+    remove(short_file);
+}
+
+// Runs RR (quantum > 0) or SRT (quantum 0) through a checkpoint
+static bool run_checkpointed(dyn_array_t *pcbs, size_t quantum, ScheduleResult_t *result, sched_checkpoint_t *checkpoint) {
+    return quantum ? round_robin_checkpointed(pcbs, result, quantum, checkpoint)
+                   : shortest_remaining_time_first_checkpointed(pcbs, result, checkpoint);
+}
+
+// A run resumed from its last checkpoint ends exactly where the uninterrupted run does
+TEST(CheckpointTest, ResumeMatchesUninterrupted) {
+    const char *path = "checkpoint_test.ckpt";
+    dyn_array_t *pcbs = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    ASSERT_NE(nullptr, pcbs);
+    for (uint32_t i = 0; i < 3000; i++) {
+        ProcessControlBlock_t pcb = { i % 5 ? (i * 37) % 23 + 1 : 0, i % 4, (i * 7919) % 9000, false };
+        dyn_array_push_back(pcbs, &pcb);
+    }
+    ScheduleOverhead_t overhead = { 2, 1 };
+    set_schedule_overhead(&overhead);
+    const size_t quanta[] = { 0, 4 };
+    for (size_t quantum : quanta) {
+        ScheduleResult_t expected = {}, saved = {}, resumed = {};
+        ASSERT_TRUE(quantum ? round_robin(pcbs, &expected, quantum) : shortest_remaining_time_first(pcbs, &expected));
+        remove(path);
+
+        sched_checkpoint_t checkpoint = { path, 997, true, false, 0 };
+        ASSERT_TRUE(run_checkpointed(pcbs, quantum, &saved, &checkpoint));
+        EXPECT_FALSE(checkpoint.resumed);  // nothing to resume from yet
+        EXPECT_LT(0u, checkpoint.written);
+        checkpoint.every = 0;
+        ASSERT_TRUE(run_checkpointed(pcbs, quantum, &resumed, &checkpoint));
+        EXPECT_TRUE(checkpoint.resumed);
+        EXPECT_EQ(0u, checkpoint.written);
+        for (const ScheduleResult_t *result : { &saved, &resumed }) {
+            EXPECT_EQ(expected.total_run_time, result->total_run_time);
+            EXPECT_EQ(expected.context_switches, result->context_switches);
+            EXPECT_EQ(expected.overhead_time, result->overhead_time);
+            EXPECT_EQ(expected.total_waiting_time, result->total_waiting_time);
+            EXPECT_EQ(expected.total_turnaround_time, result->total_turnaround_time);
+            EXPECT_EQ(expected.process_count, result->process_count);
+        }
+    }
+
+    // the file now holds RR's checkpoint, which SRT and another overhead model refuse
+    sched_checkpoint_t checkpoint = { path, 0, true, false, 0 };
+    ScheduleResult_t result = {};
+    EXPECT_FALSE(shortest_remaining_time_first_checkpointed(pcbs, &result, &checkpoint));
+    set_schedule_overhead(NULL);
+    EXPECT_FALSE(round_robin_checkpointed(pcbs, &result, 4, &checkpoint));
+    remove(path);
+    dyn_array_destroy(pcbs);
+}
+
+TEST(WhatIfTest, MatchesFullRerun) {
+    dyn_array_t *pcbs = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    ASSERT_NE(nullptr, pcbs);
+    for (uint32_t i = 0; i < 2000; i++) {
+        ProcessControlBlock_t pcb = { (i * 37) % 23 + 1, i % 7, i * 9 + (i * 7919) % 40, false };
+        dyn_array_push_back(pcbs, &pcb);
+    }
+    pcb_view_t *view = pcb_view_create(pcbs);
+    ASSERT_NE(nullptr, view);
+    ScheduleOverhead_t overhead = { 2, 1 };
+    set_schedule_overhead(&overhead);
+    bool (*const schedulers[])(dyn_array_t *, ScheduleResult_t *) = { first_come_first_serve, shortest_job_first, priority };
+    for (int policy = WHATIF_FCFS; policy <= WHATIF_PRIORITY; policy++) {
+        sched_whatif_t *whatif = sched_whatif_create(view, (WHATIF_POLICY)policy);
+        ASSERT_NE(nullptr, whatif);
+        // a longer burst late in the trace, a PCB moved to the front, another priority
+        sched_whatif_edit_t edits[3] = { { 1900, *(ProcessControlBlock_t *)dyn_array_at(pcbs, 1900) },
+                                         { 1200, *(ProcessControlBlock_t *)dyn_array_at(pcbs, 1200) },
+                                         { 40, *(ProcessControlBlock_t *)dyn_array_at(pcbs, 40) } };
+        edits[0].pcb.remaining_burst_time += 30;
+        edits[1].pcb.arrival = 3;
+        edits[2].pcb.priority = 0;
+        for (size_t count = 1; count <= 3; count++) {
+            dyn_array_t *edited = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+            for (size_t i = 0; i < dyn_array_size(pcbs); i++) {
+                dyn_array_push_back(edited, dyn_array_at(pcbs, i));
+            }
+            for (size_t e = 0; e < count; e++) {
+                *(ProcessControlBlock_t *)dyn_array_at(edited, edits[e].index) = edits[e].pcb;
+            }
+            ScheduleResult_t expected = {}, result = {};
+            size_t recomputed = 0;
+            ASSERT_TRUE(schedulers[policy](edited, &expected));
+            ASSERT_TRUE(sched_whatif_evaluate(whatif, edits, count, &result, &recomputed));
+            EXPECT_EQ(expected.total_run_time, result.total_run_time);
+            EXPECT_EQ(expected.context_switches, result.context_switches);
+            EXPECT_EQ(expected.overhead_time, result.overhead_time);
+            EXPECT_EQ(expected.total_waiting_time, result.total_waiting_time);
+            EXPECT_EQ(expected.total_turnaround_time, result.total_turnaround_time);
+            EXPECT_EQ(expected.process_count, result.process_count);
+            if (count == 1) {
+                // the late edit leaves the start alone, FCFS catches up with the baseline soon after it
+                EXPECT_LT(recomputed, policy == WHATIF_FCFS ? 200u : 1000u);
+            }
+            dyn_array_destroy(edited);
+        }
+
+        // the baseline is untouched, and a PCB can only be edited once
+        ScheduleResult_t expected = {}, result = {};
+        ASSERT_TRUE(schedulers[policy](pcbs, &expected));
+        ASSERT_TRUE(sched_whatif_baseline(whatif, &result));
+        EXPECT_EQ(expected.total_waiting_time, result.total_waiting_time);
+        EXPECT_EQ(expected.total_run_time, result.total_run_time);
+        sched_whatif_edit_t twice[2] = { edits[0], edits[0] };
+        EXPECT_FALSE(sched_whatif_evaluate(whatif, twice, 2, &result, NULL));
+        sched_whatif_destroy(whatif);
+    }
+    set_schedule_overhead(NULL);
+    pcb_view_destroy(view);
+    dyn_array_destroy(pcbs);
+}
+
+TEST(BatchTest, MatchesSchedulers) {
+    // workloads of 1 to 70 PCBs (the ones past SCHED_BATCH_MAX_PCBS take the regular path), a few empty bursts,
+    // and every 25th with bursts long enough to send RR to round_robin too
+    std::vector<uint32_t> packed;
+    const size_t workloads = 200;
+    for (uint32_t w = 0; w < workloads; w++) {
+        uint32_t n = w % 70 + 1;
+        packed.push_back(n);
+        for (uint32_t i = 0; i < n; i++) {
+            packed.push_back(i % 9 == 4 ? 0 : (w * 31 + i * 17) % (w % 25 ? 20 : 5000) + 1);
+            packed.push_back((w + i) % 5);
+            packed.push_back((w * 13 + i * (w % 7 + 1) * 3) % (n * 8 + 1));
+        }
+    }
+    ASSERT_EQ(workloads, schedule_batch_count(packed.data(), packed.size()));
+    EXPECT_EQ(0u, schedule_batch_count(packed.data(), packed.size() - 1));
+
+    ScheduleOverhead_t overhead = { 2, 1 };
+    set_schedule_overhead(&overhead);
+    const size_t quantum = 3;
+    for (int policy = BATCH_POLICY_FCFS; policy <= BATCH_POLICY_RR; policy++) {
+        std::vector<ScheduleResult_t> results(workloads);
+        ASSERT_TRUE(schedule_batch(packed.data(), packed.size(), (BATCH_POLICY)policy, quantum, results.data(), workloads));
+        size_t at = 0;
+        for (size_t w = 0; w < workloads; w++) {
+            uint32_t n = packed[at];
+            dyn_array_t *pcbs = dyn_array_create(n, sizeof(ProcessControlBlock_t), NULL);
+            for (uint32_t i = 0; i < n; i++) {
+                ProcessControlBlock_t pcb = { packed[at + 1 + 3 * i], packed[at + 2 + 3 * i], packed[at + 3 + 3 * i], false };
+                dyn_array_push_back(pcbs, &pcb);
+            }
+            at += 1 + 3 * n;
+            ScheduleResult_t expected = {};
+            ASSERT_TRUE(policy == BATCH_POLICY_FCFS ? first_come_first_serve(pcbs, &expected)
+                        : policy == BATCH_POLICY_SJF ? shortest_job_first(pcbs, &expected)
+                        : round_robin(pcbs, &expected, quantum));
+            EXPECT_EQ(expected.total_run_time, results[w].total_run_time);
+            EXPECT_EQ(expected.context_switches, results[w].context_switches);
+            EXPECT_EQ(expected.overhead_time, results[w].overhead_time);
+            EXPECT_EQ(expected.total_waiting_time, results[w].total_waiting_time);
+            EXPECT_EQ(expected.total_turnaround_time, results[w].total_turnaround_time);
+            EXPECT_EQ(expected.process_count, results[w].process_count);
+            dyn_array_destroy(pcbs);
+        }
+    }
+    set_schedule_overhead(NULL);
+
+    ScheduleResult_t result;
+    EXPECT_FALSE(schedule_batch(packed.data(), packed.size(), BATCH_POLICY_RR, 0, &result, workloads));
+    EXPECT_FALSE(schedule_batch(packed.data(), packed.size(), BATCH_POLICY_FCFS, 0, &result, 1));
+}
+
 // main: runs all the tests
 int main(int argc, char **argv)
 {